@@ -55,7 +55,7 @@
 * If no Container has been given,
 * defines the default Container as the Layout's root
 *******************************************************/
-CloneContent::CloneContent(BGL_Vertex v, GraphLayout * l, ContainerContent * c) : Content(l, c), vertex(v), rotated(false), inverted(false)
+CloneContent::CloneContent(BGL_Vertex v, GraphLayout * l, ContainerContent * c) : Content(l, c), rotated(false), inverted(false), vertex(v), _x(0), _y(0), sizeFlag(true)
 {
 	this->label =  this->layout->getGraphModel()->getProperties(this->vertex)->getLabel();
 	if (this->label.size() > 100)
@@ -115,13 +115,18 @@ BGL_Vertex CloneContent::getVertex()
 * setPosition *
 ***************
 * updates x and y with new values
-*********************************/
+* and tells the layout when they change
+* (the reactions around may need a new orientation)
+****************************************************/
 void CloneContent::setPosition(int x, int y)
 {
 	Content::setPosition(x, y);
 
+	if ((x == this->_x) && (y == this->_y)) return;
+
 	this->_x = x;
 	this->_y = y;
+	this->layout->cloneMoved(this);
 }
 
 int CloneContent::x() { return this->x(neutral); }
@@ -244,40 +249,84 @@ int CloneContent::bottom(bool withMargin) { return this->y() + this->height(with
 *********************************************************/
 int CloneContent::width(bool withMargin)
 {
-	VertexProperty * vp = this->layout->getGraphModel()->getProperties(this->vertex);
-	CloneProperty cp;
-
-	// Only concerns species
-	if (this->getNeighbours().size() > 0) cp = isClone;
-	else if (this->getContainer()->getTypeLabel() == "CloneContainer") cp = isMidget;
-	else cp = notClone;
-	// Only concerns reactions, but dangerous overload of the parameter :/ [!]
-	if (this->rotated) cp = isRotated;
-
-	VertexStyle * vs = this->layout->getStyleSheet()->getVertexStyle(vp, cp);
-
-	if (withMargin) return vs->getFullWidth(this->label); // [!] what if the displayed label is not the property's label? Clones should store labels of their own, to be displayed by the VertexGraphics...
-	else return vs->getBoundingWidth(this->label);;
+	this->updateSize();
+	return withMargin? this->fullWidth: this->boundingWidth;
 }
 /*********************************************************
 * height [!] default values, would need style sheet info *
 **********************************************************/
 int CloneContent::height(bool withMargin)
 {
+	this->updateSize();
+	return withMargin? this->fullHeight: this->boundingHeight;
+}
+
+/*************
+* updateSize *
+**************
+* If it is obsolete, looks up the style of the clone again
+* and caches its dimensions, with and without margin
+**********************************************************/
+void CloneContent::updateSize()
+{
+	if (!this->sizeFlag) return;
+
 	VertexProperty * vp = this->layout->getGraphModel()->getProperties(this->vertex);
 	CloneProperty cp;
 
 	// Only concerns species
 	if (this->getNeighbours().size() > 0) cp = isClone;
-	else if (this->getContainer()->getTypeLabel() == "CloneContainer") cp = isMidget;
+	else if (this->getContainer()->getType() == cloneContainer) cp = isMidget;
 	else cp = notClone;
 	// Only concerns reactions, but dangerous overload of the parameter :/ [!]
 	if (this->rotated) cp = isRotated;
 
 	VertexStyle * vs = this->layout->getStyleSheet()->getVertexStyle(vp, cp);
-	
-	if (withMargin) return vs->getFullHeight(this->label); // [!] what if the displayed label is not the property's label? Clones should store labels of their own, to be displayed by the VertexGraphics...
-	else return vs->getBoundingHeight(this->label);
+
+	// [!] what if the displayed label is not the property's label? Clones should store labels of their own, to be displayed by the VertexGraphics...
+	this->fullWidth = vs->getFullWidth(this->label);
+	this->boundingWidth = vs->getBoundingWidth(this->label);
+	this->fullHeight = vs->getFullHeight(this->label);
+	this->boundingHeight = vs->getBoundingHeight(this->label);
+
+	this->sizeFlag = false;
+}
+
+/**************
+* setSizeFlag *
+***************
+* The style of the clone changed (neighbours, container, orientation):
+* its dimensions are obsolete, and so is the bounding box of its ancestors
+**************************************************************************/
+void CloneContent::setSizeFlag()
+{
+	this->sizeFlag = true;
+	if (this->container) this->container->setUpdateFlag();
+}
+
+/*****************
+* setOrientation *
+******************
+* Rotated reactions get the width and height of their style swapped
+*******************************************************************/
+void CloneContent::setOrientation(bool r, bool i)
+{
+	bool resized = (this->rotated != r);
+	this->rotated = r;
+	this->inverted = i;
+	if (resized) this->setSizeFlag();
+}
+
+/***************
+* setContainer *
+****************
+* Clones in a clone container look smaller
+******************************************/
+void CloneContent::setContainer(ContainerContent * c)
+{
+	Content::setContainer(c);
+	this->sizeFlag = true; // the new container is flagged already, as it got a new child
+	this->layout->cloneRestyled(this);
 }
 
 bool CloneContent::hasConnector(BGL_Edge edge)
@@ -310,6 +359,7 @@ void CloneContent::addNeighbour(BGL_Vertex v, BGL_Edge e)
 {
 	this->neighbours.push_back(v);
 	this->neighbouredges.push_back(e);
+	this->setSizeFlag();
 }
 
 /******************
@@ -321,6 +371,7 @@ void CloneContent::removeNeighbour(BGL_Vertex v, BGL_Edge e)
 {
 	this->neighbours.remove(v);
 	this->neighbouredges.remove(e);
+	this->setSizeFlag();
 }
 
 /***********************************************************************
@@ -347,6 +398,10 @@ std::list<Connector*> CloneContent::getOutterConnectors()
 void CloneContent::addConnector(Connector *c)
 {
 	this->cList.push_back(c);
+	this->connectorEnds[c]++;
+	this->propagateEnds(c, 1); // the containers above index their connectors
+	this->layout->indexConnector(c); // once both ends are known
+	if (this->container) this->container->setLayoutFlag(); // new inner connector somewhere up there
 }
 
 /******************
@@ -359,6 +414,15 @@ void CloneContent::addConnector(Connector *c)
 void CloneContent::removeConnector(Connector *c)
 {
 	this->cList.remove(c);
+	std::map<Connector*, int>::iterator it = this->connectorEnds.find(c);
+	if (it != this->connectorEnds.end())
+	{
+		int n = it->second;
+		this->connectorEnds.erase(it);
+		this->propagateEnds(c, -n);
+	}
+	this->layout->unindexConnector(c); // the connector still points at its old ends
+	if (this->container) this->container->setLayoutFlag();
 }
 
 // returns the clones that are actually connected to the current clone by a connector
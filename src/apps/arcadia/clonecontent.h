@@ -59,6 +59,7 @@ typedef enum ConnectionType { in, out, side1, side2, neutral };
 * 
 * Some 2D dimensions taken into account by layout managers
 * (depends on the style => depends on the Vertex type, cf. properties)
+* They are cached until the style of the clone changes (cf. setSizeFlag)
 * [!] at the moment, no use of the style, default values instead
 *
 * A bounding rectangle defined by both the position and dimensions
@@ -103,6 +104,9 @@ public:
 	int bottom(bool withMargin);
 	int width(bool withMargin);
 	int height(bool withMargin);		
+	void setSizeFlag();
+
+	void setContainer(ContainerContent * c);
 	
 	std::string getLabel() { return this->label; }
 	
@@ -110,6 +114,7 @@ public:
 	
 	bool rotated;
 	bool inverted;
+	void setOrientation(bool r, bool i);
 	
 	std::list<BGL_Edge> getNeighbourEdges() { return this->neighbouredges; }
 	
@@ -122,6 +127,14 @@ private:
 	int _x;
 	int _y;
 	std::string label;
+
+	// cached dimensions, from the style
+	bool sizeFlag;
+	int fullWidth;
+	int boundingWidth;
+	int fullHeight;
+	int boundingHeight;
+	void updateSize();
 };
 
 #endif
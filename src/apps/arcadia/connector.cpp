@@ -36,6 +36,7 @@
 
 #include "clonecontent.h"
 #include "containercontent.h"
+#include "graphlayout.h"
 
 // [!] useless? (cf quickUpdate)
 void Connector::quickTranslate()
@@ -72,8 +73,17 @@ Connector::Connector(CloneContent *s, CloneContent *t, BGL_Edge e) : edge(e), so
 	controlPoints.push_back(this->getPoint(true));
 	controlPoints.push_back(this->getPoint(false));
 	this->setPoints(controlPoints);	
+
+	this->source->getLayout()->connectorAdded(this);
 }
 
+/***************************************************************
+* operator new, operator delete: memory from the layout's pool *
+***************************************************************/
+void * Connector::operator new(std::size_t size, GraphLayout * l) { return l->getPool().allocate(size); }
+void Connector::operator delete(void * p, GraphLayout *) { LayoutPool::release(p); }
+void Connector::operator delete(void * p) { LayoutPool::release(p); }
+
 CloneContent * Connector::getNeighbour(CloneContent * c)
 {
 	CloneContent * n = NULL;
@@ -90,6 +100,8 @@ CloneContent * Connector::getNeighbour(CloneContent * c)
 ***************************************/
 Connector::~Connector()
 {
+	this->source->getLayout()->connectorRemoved(this);
+
 	this->setSource(NULL);
 	this->setTarget(NULL);
 }
@@ -113,6 +125,7 @@ CloneContent* Connector::getTarget() { return this->target; }
 void Connector::setSource(CloneContent* c)
 {
 	if (this->getSource() == c) return;
+	if (this->getSource() && c) c->getLayout()->connectorChanged(this); // moved to another clone
 	if (this->getSource()) this->getSource()->removeConnector(this);
 	this->source = c;
 	if (this->getSource()) this->getSource()->addConnector(this);
@@ -128,11 +141,24 @@ void Connector::setSource(CloneContent* c)
 void Connector::setTarget(CloneContent* c)
 {
 	if (this->getTarget() == c) return;
+	if (this->getTarget() && c) c->getLayout()->connectorChanged(this); // moved to another clone
 	if (this->getTarget()) this->getTarget()->removeConnector(this);	
 	this->target = c;
 	if (this->getTarget()) this->getTarget()->addConnector(this);
 }
 
+/************
+* setPoints *
+*************
+* The layout only hears of the points that actually changed
+***********************************************************/
+void Connector::setPoints(std::list< std::pair <int, int> > p)
+{
+	if (p == this->points) return;
+	this->points = p;
+	this->source->getLayout()->connectorChanged(this);
+}
+
 /*******************
 * getSourceContent *
 ********************
@@ -34,6 +34,7 @@
 #define CONNECTOR_H
 
 // STL for std::pair
+#include <cstddef>
 #include <utility>
 #include <list>
 #include <iostream>
@@ -42,6 +43,7 @@
 #include "clonecontent.h"
 class Content;
 class ContainerContent;
+class GraphLayout;
 
 /************
 * Connector *
@@ -58,6 +60,11 @@ class ContainerContent;
 * are accessed through getSourceContent and getTargetContent
 *
 * The position of the source or target are obtained with getPoint
+*
+* The layout of the clones gets told when the Connector is created, changed or destroyed
+* (cf. GraphLayout::takeChanges)
+*
+* Like Contents, Connectors are allocated from the pool of their layout (new (layout) Connector(...))
 *****************************************************************************/
 class Connector
 {
@@ -65,6 +72,11 @@ public:
 	Connector(CloneContent * s, CloneContent * t, BGL_Edge e);
 	~Connector();
 
+	// memory from the pool of the layout (cf. LayoutPool)
+	static void * operator new(std::size_t size, GraphLayout * l);
+	static void operator delete(void * p, GraphLayout * l);
+	static void operator delete(void * p);
+
 	CloneContent * getNeighbour(CloneContent * c);
 	
 	CloneContent * getSource();
@@ -78,7 +90,7 @@ public:
 	void setSource(CloneContent * c);
 	void setTarget(CloneContent * c);
 
-	void setPoints(std::list< std::pair <int, int> > p) { this->points = p; }
+	void setPoints(std::list< std::pair <int, int> > p);
 	std::list< std::pair <int, int> > getPoints() { return this->points; }
 
 	void quickTranslate();
@@ -36,360 +36,677 @@
 #include <utility>
 
 #include <QProgressDialog>
-#include <QApplication>
+#include <QRunnable>
 
-#include <ctime>
+#include <set>
 
 #include "clonecontent.h"
 #include "connector.h"
+#include "containercontent.h"
 #include "graphlayout.h"
 
-ConnectorLayoutManager::ConnectorLayoutManager(GraphLayout * gl) : graphLayout(gl), router(NULL)
+// Number of connectors routed (in parallel) before their routes get sent to the GUI thread
+static const unsigned int ConnectorsPerBatch = 200;
+
+/***************
+* PathSearcher *
+****************
+* One of the threads of the search pool: takes the next connector that needs
+* a path, until there is none left or the job gets superseded
+* The connectors it searched for get flagged, to be committed later
+******************************************************************************/
+class PathSearcher : public QRunnable
 {
-	if (this->graphLayout->isAvoiding()) this->init();
-	this->totalCleanUpSteps = 0;
+public:
+	PathSearcher(std::vector<Avoid::ConnRef *> & p, std::vector<char> & s, QAtomicInt & n,
+		Avoid::PathSearch & ps, QAtomicInt & g, int jg) :
+		pending(p), searched(s), next(n), search(ps), generation(g), jobGeneration(jg) {}
+
+	void run()
+	{
+		for (int i = this->next.fetchAndAddOrdered(1); i < (int) this->pending.size(); i = this->next.fetchAndAddOrdered(1))
+		{
+			if (this->jobGeneration != (int) this->generation) break;
+			this->searched[i] = this->pending[i]->searchPath(this->search);
+		}
+	}
+
+private:
+	std::vector<Avoid::ConnRef *> & pending;
+	std::vector<char> & searched;
+	QAtomicInt & next;
+	Avoid::PathSearch & search;
+	QAtomicInt & generation;
+	int jobGeneration;
+};
+
+/*********************
+* OrthogonalSearcher *
+**********************
+* Same as PathSearcher, in orthogonal mode: takes the next connector
+* to route over the orthogonal visibility graph, until there is none left
+* (a connector it could not route just keeps its straight line)
+**************************************************************************/
+class OrthogonalSearcher : public QRunnable
+{
+public:
+	OrthogonalSearcher(Avoid::OrthogonalRouter & r, QAtomicInt & n, Avoid::OrthogonalSearch & os, QAtomicInt & g, int jg) :
+		router(r), next(n), search(os), generation(g), jobGeneration(jg) {}
+
+	void run()
+	{
+		for (int i = this->next.fetchAndAddOrdered(1); i < (int) this->router.connectorCount(); i = this->next.fetchAndAddOrdered(1))
+		{
+			if (this->jobGeneration != (int) this->generation) break;
+			this->router.searchRoute(i, this->search);
+		}
+	}
+
+private:
+	Avoid::OrthogonalRouter & router;
+	QAtomicInt & next;
+	Avoid::OrthogonalSearch & search;
+	QAtomicInt & generation;
+	int jobGeneration;
+};
+
+/*************************************************************************************
+* Shape helpers: the rectangle libavoid uses for a given CloneContent snapshot, and   *
+* comparison with the polygon already known by the Router (to detect moved clones)    *
+*************************************************************************************/
+static Avoid::Polygn ShapePoly(double left, double top, double right, double bottom)
+{
+	Avoid::Polygn shapePoly = Avoid::newPoly(4);
+	shapePoly.ps[0]= Avoid::Point(left, top);
+	shapePoly.ps[1]= Avoid::Point(right, top);
+	shapePoly.ps[2]= Avoid::Point(right, bottom);
+	shapePoly.ps[3]= Avoid::Point(left, bottom);
+	return shapePoly;
+}
+
+static bool SamePoly(Avoid::Polygn p1, Avoid::Polygn p2)
+{
+	if (p1.pn != p2.pn) return false;
+	for (int i = 0; i < p1.pn; ++i) if (p1.ps[i] != p2.ps[i]) return false;
+	return true;
+}
+
+ConnectorLayoutManager::ConnectorLayoutManager(GraphLayout * gl) : graphLayout(gl),
+	pendingJob(NULL), stopping(false), generation(0), routedGeneration(-1), nRouted(0), pd(NULL)
+{
+	// The routing sessions get created lazily, level by level (cf. synchronize)
+	this->searches.resize(this->searchPool.maxThreadCount());
+	this->orthogonalSearches.resize(this->searchPool.maxThreadCount());
+
+	// Emitted from the background thread, so the routes end up being published in the GUI thread
+	QObject::connect(this, SIGNAL(batchRouted()), this, SLOT(publish()), Qt::QueuedConnection);
 }
 
 ConnectorLayoutManager::~ConnectorLayoutManager()
 {
-	if (!this->isRunning()) return; // to avoid displaying the progress bar needlessly
+	// The job in progress is dropped, and the background thread tears the routing session down
+	this->mutex.lock();
+	this->stopping = true;
+	delete this->pendingJob;
+	this->pendingJob = NULL;
+	this->jobPending.wakeOne();
+	this->mutex.unlock();
+	this->generation.ref();
+
+	if (this->pd) { delete this->pd; this->pd = NULL; }
+
+	this->wait();
+}
+
+// Ends the routing session: new levels will be started from scratch by the next job
+void ConnectorLayoutManager::clear()
+{
+	for (std::map< ContainerContent *, RoutingLevel >::iterator it = this->levels.begin(); it != this->levels.end(); ++it)
+	{
+		this->clearLevel(it->second);
+	}
+	this->levels.clear();
+}
 
- 	pd = new QProgressDialog("Cleaning up edge routing memory (can't be interrupted)", QString(), 0, this->totalCleanUpSteps);
-	pd->setWindowModality(Qt::ApplicationModal);
-    pd->show();
+// The Router deletes the shapes and connectors it still knows along with itself,
+// and releases its whole visibility graph at once (no need to delShape one by one)
+void ConnectorLayoutManager::clearLevel(RoutingLevel & level)
+{
+	level.myShapeList.clear();
+	level.myConnList.clear();
 
-	while (this->isRunning())
+	if (level.router) { delete level.router; level.router = NULL; }
+	level.objectCount = 0;
+}
+
+/**************
+* routeLevels *
+***************
+* Routes every level of the job, one after the other, and sends every connector its route
+* A level whose snapshot is the very one it was last routed for just sends its routes again
+* (moved to where its container now is) without touching its session
+* Sessions of containers that are not part of the job anymore are torn down
+* Stops when superseded: an interrupted level will be looked at again by the next job
+*********************************************************************************************/
+void ConnectorLayoutManager::routeLevels(RoutingJob * job)
+{
+	std::set<ContainerContent*> current;
+	for (std::vector<LevelSnapshot>::iterator it = job->levels.begin(); it != job->levels.end(); ++it) current.insert(it->container);
+
+	for (std::map< ContainerContent *, RoutingLevel >::iterator it = this->levels.begin(); it != this->levels.end(); )
 	{
-		pd->setValue(this->currentCleanUpSteps);
-		pd->show();
+		std::map< ContainerContent *, RoutingLevel >::iterator doomed = it++;
+		if (current.find(doomed->first) != current.end()) continue;
+
+		this->clearLevel(doomed->second);
+		this->levels.erase(doomed);
+	}
+
+	std::list<Route> batch;
+	for (std::vector<LevelSnapshot>::iterator it = job->levels.begin(); it != job->levels.end(); ++it)
+	{
+		if (this->isSuperseded(job)) break;
+
+		RoutingLevel & level = this->levels[it->container];
+		if (level.routed && (level.orthogonal == job->orthogonal) && (level.shapes == it->shapes) && (level.connectors == it->connectors))
+		{
+			for (std::vector<ConnectorSnapshot>::iterator ct = it->connectors.begin(); ct != it->connectors.end(); ++ct)
+			{
+				std::map< Connector *, std::list< std::pair <int, int> > >::iterator known = level.routes.find(ct->connector);
+				if (known != level.routes.end()) this->post(job, *it, ct->connector, known->second, batch);
+			}
+			continue;
+		}
+
+		level.routed = false;
+		level.routes.clear();
+		if (job->orthogonal)
+		{
+			// orthogonal routing doesn't need the session
+			this->clearLevel(level);
+			this->routeOrthogonally(job, *it, level, batch);
+		}
+		else
+		{
+			this->synchronize(job, *it, level);
+			if (!this->isSuperseded(job)) this->process(job, *it, level, batch);
+		}
+		if (this->isSuperseded(job)) break;
+
+		level.routed = true;
+		level.orthogonal = job->orthogonal;
+		level.shapes = it->shapes;
+		level.connectors = it->connectors;
 	}
 
-	pd->setValue(this->totalCleanUpSteps);
-	pd->show();
-	delete pd;
+	this->send(job, batch, !this->isSuperseded(job));
 }
 
-// This can be time consuming, but should not be interrupted (in order to preserve memory integrity)
-// So it is run in a background thread...
-void ConnectorLayoutManager::clear()
+/**************
+* synchronize *
+***************
+* Brings the routing session of a level up to date with its snapshot:
+* starts a new Router if there is none,
+* then forwards the differences with the snapshot children and connectors
+* Stops as soon as the job gets superseded: the Router stays consistent with
+* the shape and connector maps at every step, so the next job just carries on
+******************************************************************************/
+void ConnectorLayoutManager::synchronize(RoutingJob * job, LevelSnapshot & ls, RoutingLevel & level)
 {
-/*
-	time_t start = time(NULL);
-*/
-	// Time required to clean up connectors is negligeable
-	this->totalCleanUpSteps = this->myShapeList.size(); // + this->myConnList.size();
-	this->currentCleanUpSteps = 0;
-
-	// Because the router doesn't do it upon its own destruction!
-	if (!this->myShapeList.empty())
+	if (!level.router) level.router = new Avoid::Router();
+
+	this->synchronizeShapes(job, ls, level);
+	if (!this->isSuperseded(job)) this->synchronizeConnectors(job, ls, level);
+}
+
+// Each child of the container is a rectangular shape at a certain position
+void ConnectorLayoutManager::synchronizeShapes(RoutingJob * job, LevelSnapshot & ls, RoutingLevel & level)
+{
+	Avoid::Router * router = level.router;
+
+	// Shapes of children that do not exist anymore are removed from the session
+	std::set<Content*> current;
+	for (std::vector<ShapeSnapshot>::iterator it = ls.shapes.begin(); it != ls.shapes.end(); ++it) current.insert(it->child);
+
+	for (std::map< Content *, Avoid::ShapeRef * >::iterator it = level.myShapeList.begin(); it != level.myShapeList.end(); )
+	{
+		std::map< Content *, Avoid::ShapeRef * >::iterator doomed = it++;
+		if (current.find(doomed->first) != current.end()) continue;
+
+		if (this->isSuperseded(job)) return;
+
+		router->delShape(doomed->second);
+		level.myShapeList.erase(doomed);
+	}
+
+	// New children get a new shape, moved or resized children get their shape moved
+	bool moves = false;
+	for (std::vector<ShapeSnapshot>::iterator it = ls.shapes.begin(); it != ls.shapes.end(); ++it)
 	{
-		for (std::map< CloneContent *, Avoid::ShapeRef * >::iterator it = this->myShapeList.begin(); it != this->myShapeList.end(); ++it)
+		if (this->isSuperseded(job)) break;
+
+		Avoid::Polygn shapePoly = ShapePoly(it->left, it->top, it->right, it->bottom);
+
+		std::map< Content *, Avoid::ShapeRef * >::iterator known = level.myShapeList.find(it->child);
+		if (known == level.myShapeList.end())
 		{
-			router->delShape(it->second); // This is particularly time consuming
-			// Unfortunately, simply deleting the shape object would result in memory unstability
-			this->currentCleanUpSteps++;
+			Avoid::ShapeRef * shapeRef = new Avoid::ShapeRef(router, ++level.objectCount, shapePoly);
+			router->addShape(shapeRef);
+			level.myShapeList[it->child] = shapeRef;
 		}
-		this->myShapeList.clear();
+		else if (!SamePoly(known->second->poly(), shapePoly))
+		{
+			router->moveShape(known->second, &shapePoly);
+			moves = true;
+		}
+		Avoid::freePoly(shapePoly);
 	}
 
-	if (!this->myConnList.empty())
+	// All the moves are processed at once (even after a cancel, to leave no pending move behind)
+	if (moves) router->processMoves();
+}
+
+// Each inner connector of the container is a connector from one point to another
+void ConnectorLayoutManager::synchronizeConnectors(RoutingJob * job, LevelSnapshot & ls, RoutingLevel & level)
+{
+	Avoid::Router * router = level.router;
+
+	// Connectors that do not exist anymore are removed from the session
+	std::set<Connector*> current;
+	for (std::vector<ConnectorSnapshot>::iterator it = ls.connectors.begin(); it != ls.connectors.end(); ++it) current.insert(it->connector);
+
+	for (std::map< Connector *, Avoid::ConnRef * >::iterator it = level.myConnList.begin(); it != level.myConnList.end(); )
 	{
-		for (std::map< Connector *, Avoid::ConnRef * >::iterator it = this->myConnList.begin(); it != this->myConnList.end(); ++it)
+		std::map< Connector *, Avoid::ConnRef * >::iterator doomed = it++;
+		if (current.find(doomed->first) != current.end()) continue;
+
+		// the visibility edges of its end points must go first, libavoid doesn't remove them itself
+		doomed->second->removeFromGraph();
+		delete doomed->second;
+		level.myConnList.erase(doomed);
+	}
+
+	// New connectors are added, and the end points of the others follow their clones
+	for (std::vector<ConnectorSnapshot>::iterator it = ls.connectors.begin(); it != ls.connectors.end(); ++it)
+	{
+		if (this->isSuperseded(job)) break;
+
+		std::map< Connector *, Avoid::ConnRef * >::iterator known = level.myConnList.find(it->connector);
+		if (known == level.myConnList.end())
 		{
-			delete it->second;
-			// Time required to clean up connectors is negligeable
-//			this->currentCleanUpSteps++;
+			Avoid::ConnRef * connRef = new Avoid::ConnRef(router, ++level.objectCount, it->src, it->tar);
+			connRef->updateEndPoint(Avoid::VertID::src, it->src);
+			connRef->updateEndPoint(Avoid::VertID::tar, it->tar);	
+			level.myConnList[it->connector] = connRef;
+		}
+		else
+		{
+			// moving an end point invalidates the current route of the connector (cf. needsReroute)
+			Avoid::ConnRef * connRef = known->second;
+			if (connRef->src()->point != it->src) connRef->updateEndPoint(Avoid::VertID::src, it->src);
+			if (connRef->dst()->point != it->tar) connRef->updateEndPoint(Avoid::VertID::tar, it->tar);
 		}
-		this->myConnList.clear();
 	}
+}
+
+/**********
+* process *
+***********
+* Reroutes the connectors of a level flagged by libavoid, then sends every connector its route
+* (the ones left untouched keep the route computed during a previous job)
+* Connectors are dealt with one batch at a time, their paths searched in parallel
+* Assumes a synchronization has already been performed. Stops when superseded
+************************************************************************************************/
+void ConnectorLayoutManager::process(RoutingJob * job, LevelSnapshot & ls, RoutingLevel & level, std::list<Route> & batch)
+{
+	std::vector<ConnectorSnapshot>::iterator it = ls.connectors.begin();
+	while ((it != ls.connectors.end()) && !this->isSuperseded(job))
+	{
+		std::vector< std::pair<Connector *, Avoid::ConnRef *> > chunk;
+		std::vector<Avoid::ConnRef *> pending;
+		for (; (it != ls.connectors.end()) && (chunk.size() < ConnectorsPerBatch); ++it)
+		{
+			std::map< Connector *, Avoid::ConnRef * >::iterator known = level.myConnList.find(it->connector);
+			if (known == level.myConnList.end()) continue; // synchronization was interrupted before that one
+			chunk.push_back(*known);
+			if (known->second->needsReroute()) pending.push_back(known->second);
+		}
+
+		this->searchPaths(job, level, pending);
+
+		for (unsigned int i = 0; i < chunk.size(); ++i)
+		{
+			Avoid::ConnRef * connRef = chunk[i].second;
+
+			// a connector that still needs rerouting (interrupted) keeps its straight line
+			if (connRef->needsReroute()) continue;
 
-	if (this->router) { delete this->router; this->router = NULL; }
+			Avoid::Polygn route = connRef->route();
+			if (!route.pn) continue;
 
-/*	
-	time_t end = time(NULL);
-	double t = difftime(end, start);
-	if (t) std::cout << "Cleaning " << t << std::endl;	
-*/
+			std::list< std::pair <int, int> > & points = level.routes[chunk[i].first];
+			for (int j=0; j<route.pn; ++j) points.push_back(std::pair<int,int>(route.ps[j].x, route.ps[j].y));
+			this->post(job, ls, chunk[i].first, points, batch);
+		}
+	}
 }
 
-// Assumes a clear operation has already be performed if need be
-void ConnectorLayoutManager::init()
+/**************
+* searchPaths *
+***************
+* Searches the paths of the given connectors with every thread of the pool,
+* then commits them one by one, in order, once all the searches are over
+* (libavoid only reads the visibility graph during the search, cf. ConnRef::searchPath)
+* A connector left out because the job got superseded keeps needing a reroute
+***************************************************************************************/
+void ConnectorLayoutManager::searchPaths(RoutingJob * job, RoutingLevel & level, std::vector<Avoid::ConnRef *> & pending)
 {
-/*
-	time_t start = time(NULL);
-*/
-	this->connectors = this->graphLayout->getConnectors();
-	this->cloneDescriptors = this->graphLayout->getCloneContents();
-
-	// Initialize libavoid objects
-	this->router = new Avoid::Router();	
-	int objectCount = 0;
-
-	pd->setLabelText("Edge routing in progress... Initializing shapes");
-	pd->show();
-
-/*	
-	int current = 0;
-	int total = cloneDescriptors.size();
-*/
-	// Each clone in the layout becomes a rectangular shape at a certain position
-	for (std::list<CloneContent*>::iterator it = cloneDescriptors.begin(); it != cloneDescriptors.end(); ++it)
+	if (pending.empty()) return;
+
+	std::vector<char> searched(pending.size(), 0);
+	QAtomicInt next(0);
+
+	// Without IncludeEndpoints the searches do update the graph: a single thread it is, then
+	int nThreads = level.router->IncludeEndpoints? this->searches.size(): 1;
+	if (nThreads > (int) pending.size()) nThreads = pending.size();
+
+	for (int t = 0; t < nThreads; ++t)
 	{
-		QApplication::processEvents();
-		if (pd->wasCanceled()) break;
-
-		CloneContent * v = *it;
-		
-		Avoid::Polygn shapePoly = Avoid::newPoly(4);
-		shapePoly.ps[0]= Avoid::Point(v->left(true), v->top(true));
-		shapePoly.ps[1]= Avoid::Point(v->right(true), v->top(true));
-		shapePoly.ps[2]= Avoid::Point(v->right(true), v->bottom(true));
-		shapePoly.ps[3]= Avoid::Point(v->left(true), v->bottom(true));
-
-		Avoid::ShapeRef * shapeRef = new Avoid::ShapeRef(router, ++objectCount, shapePoly);
-		Avoid::freePoly(shapePoly);		
-		router->addShape(shapeRef);
-			
-		myShapeList[v] = shapeRef;
-
-		pd->setValue( pd->value() + 1 );
-		pd->show();
-	
-/*
-		current++;
-		float progress = (100.0 * current) / progress;
-		pd->setLabelText("Edge routing in progress... Initializing shapes: " + progress + "%");
-*/
+		this->searchPool.start(new PathSearcher(pending, searched, next, this->searches[t], this->generation, job->generation));
+	}
+	this->searchPool.waitForDone();
+
+	for (unsigned int i = 0; i < pending.size(); ++i)
+	{
+		if (searched[i]) pending[i]->commitPath();
 	}
+}
 
-	pd->setLabelText("Edge routing in progress... Initializing connectors");
-	pd->show();
+/********************
+* routeOrthogonally *
+*********************
+* Routes every connector of a level with horizontal and vertical segments only:
+* builds the orthogonal visibility graph of the snapshot children, searches the routes
+* in parallel with every thread of the pool, nudges apart the segments that overlap
+* then sends the routes
+* Nudging needs all the routes, so nothing gets sent before the searches are over
+* A connector's end points are inside its source and target children,
+* which only its own route may cross
+*************************************************************************************/
+void ConnectorLayoutManager::routeOrthogonally(RoutingJob * job, LevelSnapshot & ls, RoutingLevel & level, std::list<Route> & batch)
+{
+	Avoid::OrthogonalRouter orthoRouter;
 
-/*
-	current = 0;
-	total = connectors.size();
-*/
-	// Each connector in the layout becames a connector from one point to another
-	for (std::list<Connector*>::iterator it = connectors.begin(); it != connectors.end(); ++it)
+	std::map< Content *, int > shapeIndex;
+	for (std::vector<ShapeSnapshot>::iterator it = ls.shapes.begin(); it != ls.shapes.end(); ++it)
 	{
-		QApplication::processEvents();
-		if (pd->wasCanceled()) break;	
+		Avoid::BBox box;
+		box.a = Avoid::Point(it->left, it->top);
+		box.b = Avoid::Point(it->right, it->bottom);
+		shapeIndex[it->child] = orthoRouter.addShape(box);
+	}
 
-		Connector * e = *it;
+	for (std::vector<ConnectorSnapshot>::iterator it = ls.connectors.begin(); it != ls.connectors.end(); ++it)
+	{
+		std::map< Content *, int >::iterator src = shapeIndex.find(it->source);
+		std::map< Content *, int >::iterator tar = shapeIndex.find(it->target);
+		orthoRouter.addConnector(it->src, it->tar,
+			(src != shapeIndex.end())? src->second: Avoid::OrthogonalRouter::NoShape,
+			(tar != shapeIndex.end())? tar->second: Avoid::OrthogonalRouter::NoShape);
+	}
 
-		Avoid::Point srcPoint = Avoid::Point(e->getPoint(true).first, e->getPoint(true).second);
-		Avoid::Point tarPoint = Avoid::Point(e->getPoint(false).first, e->getPoint(false).second);
+	orthoRouter.buildGraph();
+	if (this->isSuperseded(job)) return;
 
-		Avoid::ConnRef * connRef = new Avoid::ConnRef(router, ++objectCount, srcPoint, tarPoint);
-		connRef->updateEndPoint(Avoid::VertID::src, srcPoint);
-		connRef->updateEndPoint(Avoid::VertID::tar, tarPoint);	
+	QAtomicInt next(0);
+	int nThreads = this->orthogonalSearches.size();
+	if (nThreads > (int) ls.connectors.size()) nThreads = ls.connectors.size();
+	for (int t = 0; t < nThreads; ++t)
+	{
+		this->searchPool.start(new OrthogonalSearcher(orthoRouter, next, this->orthogonalSearches[t], this->generation, job->generation));
+	}
+	this->searchPool.waitForDone();
+	if (this->isSuperseded(job)) return;
 
-		myConnList[e] = connRef;
+	orthoRouter.nudge();
 
-		pd->setValue( pd->value() + 1 );
-		pd->show();
+	for (unsigned int i = 0; i < ls.connectors.size(); ++i)
+	{
+		const std::vector<Avoid::Point> & route = orthoRouter.route(i);
 
-/*
-		current++;
-		float progress = (100.0 * current) / progress;
-		pd->setLabelText("Edge routing in progress... Initializing connectors: " + progress + "%");
-*/
+		std::list< std::pair <int, int> > & points = level.routes[ls.connectors[i].connector];
+		for (unsigned int j = 0; j < route.size(); ++j) points.push_back(std::pair<int,int>(route[j].x, route[j].y));
+		this->post(job, ls, ls.connectors[i].connector, points, batch);
 	}
-	
-/*
-	time_t end = time(NULL);
-	double t = difftime(end, start);
-	if (t) std::cout << "Init " << t << std::endl;	
-*/
 }
 
-// Assumes an initialization has already been performed. Can be interrupted
-void ConnectorLayoutManager::process()
+// Adds the route a level found for a connector to the batch, back in layout coordinates
+// and hands the batch over to the GUI thread once it's big enough
+void ConnectorLayoutManager::post(RoutingJob * job, LevelSnapshot & ls, Connector * connector, std::list< std::pair <int, int> > & points, std::list<Route> & batch)
 {
-/*
-	time_t start = time(NULL);
-*/	
+	Route r;
+	r.generation = job->generation;
+	r.connector = connector;
+	for (std::list< std::pair <int, int> >::iterator it = points.begin(); it != points.end(); ++it)
+	{
+		r.points.push_back(std::pair<int,int>(it->first + ls.originX, it->second + ls.originY));
+	}
+	batch.push_back(r);
 
-	pd->setLabelText("Edge routing in progress... Processing connectors");
-	pd->show();
+	if (batch.size() >= ConnectorsPerBatch) this->send(job, batch, false);
+}
 
-/*
-	int current = 0;
-	int total = connectors.size();
-*/
-	for (std::list<Connector*>::iterator it = this->connectors.begin(); it != this->connectors.end(); ++it)
+// Hands a batch of routes over to the GUI thread (cf. publish)
+void ConnectorLayoutManager::send(RoutingJob * job, std::list<Route> & batch, bool last)
+{
+	this->mutex.lock();
+	this->routedBatch.splice(this->routedBatch.end(), batch);
+	if (last) this->routedGeneration = job->generation;
+	this->mutex.unlock();
+
+	emit batchRouted();
+}
+
+/**********
+* publish *
+***********
+* GUI thread: copies the routes received so far into their Connectors,
+* unless they come from a superseded job (the Connector may not even exist anymore)
+* then lets the views know which Connectors got a new route
+************************************************************************************/
+void ConnectorLayoutManager::publish()
+{
+	std::list<Route> batch;
+	this->mutex.lock();
+	batch.swap(this->routedBatch);
+	bool done = (this->routedGeneration == (int) this->generation);
+	this->mutex.unlock();
+
+	this->routedConnectors.clear();
+	for (std::list<Route>::iterator it = batch.begin(); it != batch.end(); ++it)
+	{
+		if (it->generation != (int) this->generation) continue;
+		it->connector->setPoints(it->points);
+		this->routedConnectors.push_back(it->connector);
+	}
+
+	if (!this->routedConnectors.empty())
 	{
-		QApplication::processEvents();
-		if (pd->wasCanceled()) break;
+		this->nRouted += this->routedConnectors.size();
+		if (this->pd) this->pd->setValue(this->nRouted);
+		emit connectorsRouted();
+	}
 
-		Connector * e = *it;
-		Avoid::ConnRef * connRef = this->myConnList[e];
+	if (done && this->pd) this->pd->reset();
+}
 
-		connRef->generatePath();
-		std::list< std::pair <int, int> > controlPoints;
-		Avoid::Polygn route = connRef->route();
-		for (int i=0; i<route.pn; ++i) controlPoints.push_back(std::pair<int,int>(route.ps[i].x, route.ps[i].y));
-		e->setPoints(controlPoints);			
+/***********
+* snapshot *
+************
+* GUI thread: adds the level of the given container to the job
+* (the rectangles of its children and its inner connectors, relative to its top left corner)
+* then does the same for every child that is a container too
+* A container without inner connectors has nothing to route
+*********************************************************************************************/
+void ConnectorLayoutManager::snapshot(ContainerContent * container, RoutingJob * job)
+{
+	ContentRange children = container->getChildRange();
+	ConnectorSetRange connectors = container->getInnerConnectorRange();
 
-		pd->setValue( pd->value() + 1 );
-		pd->show();
+	if (!connectors.empty())
+	{
+		job->levels.push_back(LevelSnapshot());
+		LevelSnapshot & ls = job->levels.back();
+		ls.container = container;
+		ls.originX = container->left(true);
+		ls.originY = container->top(true);
+
+		ls.shapes.reserve(children.size());
+		for (ContentRange::iterator it = children.begin(); it != children.end(); ++it)
+		{
+			Content * c = *it;
+			ShapeSnapshot ss;
+			ss.child = c;
+			ss.left = c->left(true) - ls.originX;
+			ss.top = c->top(true) - ls.originY;
+			ss.right = c->right(true) - ls.originX;
+			ss.bottom = c->bottom(true) - ls.originY;
+			ls.shapes.push_back(ss);
+		}
 
-/*
-		current++;
-		float progress = (100.0 * current) / progress;
-		pd->setLabelText("Edge routing in progress... Processing connectors: " + progress + "%");
-*/
+		ls.connectors.reserve(connectors.size());
+		for (ConnectorSetRange::iterator it = connectors.begin(); it != connectors.end(); ++it)
+		{
+			Connector * edge = *it;
+			ConnectorSnapshot cs;
+			cs.connector = edge;
+			cs.source = edge->getSourceContent(container);
+			cs.target = edge->getTargetContent(container);
+			cs.src = Avoid::Point(edge->getPoint(true).first - ls.originX, edge->getPoint(true).second - ls.originY);
+			cs.tar = Avoid::Point(edge->getPoint(false).first - ls.originX, edge->getPoint(false).second - ls.originY);
+			ls.connectors.push_back(cs);
+		}
+		job->connectorCount += connectors.size();
+	}
+
+	// [!] containers are detected through the id, cf. LayoutGraphView::displayContainerTree
+	for (ContentRange::iterator it = children.begin(); it != children.end(); ++it)
+	{
+		Content * c = *it;
+		if (c->getId() != "") this->snapshot((ContainerContent*)c, job);
 	}
-/*	
-	time_t end = time(NULL);
-	double t = difftime(end, start);
-	if (t) std::cout << "Process " << t << std::endl;	
-*/
 }
 
+/*********
+* layout *
+**********
+* GUI thread: gives every connector a straight line, then (if avoiding)
+* hands a snapshot of the layout over to the background thread,
+* superseding the job it may still be working on
+* The straight lines get replaced as routes come back (cf. publish)
+* When avoiding, a connector whose ends did not move keeps its route meanwhile
+* (only the connectors that actually change get redrawn)
+*********************************************************************************/
 void ConnectorLayoutManager::layout()
 {
+	this->generation.ref();
+
+	RoutingJob * job = new RoutingJob();
+	job->generation = this->generation;
+	job->avoiding = this->graphLayout->isAvoiding();
+	job->orthogonal = this->graphLayout->isOrthogonal();
+	job->connectorCount = 0;
+
 	// we change the begin and end point of the edge (default connector layout)
-	this->connectors = this->graphLayout->getConnectors();
-	for (std::list<Connector*>::iterator it = this->connectors.begin(); it != this->connectors.end(); ++it)
+	ConnectorRange connectors = this->graphLayout->getConnectorRange();
+	for (ConnectorRange::iterator it = connectors.begin(); it != connectors.end(); ++it)
 	{
 		Connector *edge = *it;
+		std::pair<int, int> s = edge->getPoint(true);
+		std::pair<int, int> t = edge->getPoint(false);
+
+		if (job->avoiding)
+		{
+			std::list< std::pair <int, int> > points = edge->getPoints();
+			if (!points.empty() && (points.front() == s) && (points.back() == t)) continue;
+		}
+
 		std::list< std::pair <int, int> > controlPoints;
-		controlPoints.push_back(edge->getPoint(true));
-		controlPoints.push_back(edge->getPoint(false));			
+		controlPoints.push_back(s);
+		controlPoints.push_back(t);
 		edge->setPoints(controlPoints);
 	}	
-	
-	// If avoiding is on, we perform a process that can be more time consuming, and can be interrupted
-	if (this->graphLayout->isAvoiding())
+
+	if (job->avoiding)
 	{
-		// Estimates the number of steps required:
-		// number of nodes (init) + number of edges * 2 (init & process) + clean up steps (cf clear thread)
-		int nConnectors = this->connectors.size();
-		int nClones = this->graphLayout->getCloneContents().size();
-		int nSteps = 2 * nConnectors + nClones + this->totalCleanUpSteps;
-
-		// This modal dialog box indicates the progress of possibly costly operations being
-		// performed in the main thread. The dialog box remains active, displays updates on progress
-		// and can interrupt the main thread's tasks.
-		// However, it is impossible to access other GUI elements while this dialog is active
-	 	pd = new QProgressDialog("Edge routing in progress...", "Cancel", 0, nSteps);
-		pd->setWindowModality(Qt::ApplicationModal);
-	    pd->show();
-
-		pd->setLabelText("Edge routing in progress... Cleaning up memory");
-		pd->show();
-
-		// We first need to wait for the previous clean up to be done with
-		while (this->isRunning())
-		{
-			QApplication::processEvents();
-			if (pd->wasCanceled()) break;
+		this->snapshot(this->graphLayout->getRoot(), job);
 
-			pd->setValue(this->currentCleanUpSteps);
-			pd->show();
-/*
-			float progress = (100.0*this->currentCleanUpSteps)/this->totalCleanUpSteps;
-			pd->setLabelText("Edge routing in progress... Cleaning up memory: " + progress + "%"  );
-*/
-		}
-		pd->setValue(this->totalCleanUpSteps);
-		pd->show();
-
-		// Pressing cancel won't cancel the clean up itself (running a background thread), just the
-		// waiting for it to be finished. This means:
-		// 1) init and process should be ignored (as cleaning is not finished yet and the user doesn't want to wait)
-		// 2) a new cleaning process should NOT be started till that one is finished
-		// 3) nevertheless, we still need to get rid of the dialog box
-
-		pd->setLabelText("Edge routing in progress... Initializing");
-		pd->show();
-
-		// Init runs in the main thread, but can be interrupted by the dialog box
-		if (!pd->wasCanceled()) this->init();
-		// Running this in the main thread makes sense, as we don't want the users to change the
-		// layout when we are busy initializing the libavoid router based on current layout data
-
-		pd->setLabelText("Edge routing in progress... Processing");
-		pd->show();
-
-		// Process runs in the main thread, but can be interrupted by the dialog box
-		if (!pd->wasCanceled()) this->process();
-		// Running this in the main thread ensures that modifications performed on the connectors
-		// at the end of the process are automatically taken into account by the app's display
-		// The previous remark also applies: modification to the layout would render the current
-		// computations meaningless... And synchronizing the GUI with libavoid is not 100% trivial
-		// (ideally we may send more atomic updates instead of reinitializing all the libavoid data
-		// every time we want to route edges... But I don't have the time to do that now) [!]
-		// cf. commented out update method draft below (not interruptable or thread enabled!)
-	
-		// At that stage, we give back control to the main application and get rid of the dialog box
-		pd->setValue(nSteps);
-		pd->show();
-		delete pd;
-		// If we arrived there, it either means all the processing was completed, or we canceled it
-
-		// In any case we need to run a clean up process in the background (only one at a time)
-		if (!this->isRunning())
+		// This dialog box doesn't block the application: it only shows up if routing takes a while
+		if (!this->pd)
 		{
-			this->start();
+			this->pd = new QProgressDialog("Edge routing in progress...", "Cancel", 0, 0);
+			this->pd->setWindowModality(Qt::NonModal);
+			QObject::connect(this->pd, SIGNAL(canceled()), this, SLOT(cancel()));
 		}
-		// This clean up process can take time, but should NOT be interrupted - this would result
-		// in very bad memory management. A full clean up is mandatory before we can start
-		// to initialize and process another batch of data.
+		this->nRouted = 0;
+		this->pd->setRange(0, job->connectorCount);
+		this->pd->setValue(0);
 	}
-}
+	else
+	{
+		if (this->pd) this->pd->reset();
 
-// Runs in the background when the thread gets started
-void ConnectorLayoutManager::run() { this->clear(); }
+		// If avoiding has been switched off, the routing session is not needed anymore
+		if (!this->isRunning()) { delete job; return; }
+	}
 
-// Not currently used
-// Instead of full reset then process then clear everytime...
-// The approach below looks more optimal but is currently a bit broken? [!]
-//	if (this->needsResetting) this->reset();
-//	else this->update();
+	this->mutex.lock();
+	delete this->pendingJob;
+	this->pendingJob = job;
+	this->jobPending.wakeOne();
+	this->mutex.unlock();
 
-/*
-void ConnectorLayoutManager::update()
+	if (!this->isRunning()) this->start();
+}
+
+/*********
+* cancel *
+**********
+* Supersedes the job in progress (if any): its routes won't be published
+* and the connectors not routed yet keep their straight line
+* The routing session itself is kept, the next job will carry on from there
+***************************************************************************/
+void ConnectorLayoutManager::cancel()
 {
-	time_t start = time(NULL);	
+	this->generation.ref();
+	if (this->pd) this->pd->reset();
+}
 
-	for (std::list<CloneContent*>::iterator it = this->cloneDescriptors.begin(); it != this->cloneDescriptors.end(); ++it)
+/******
+* run *
+*******
+* Background thread: waits for jobs, routes them, or tears the routing
+* session down when avoiding is switched off (a new one starts with the next job)
+* Only the latest job is kept waiting, older ones are just dropped
+* The session ends with the thread, when the manager gets destroyed
+*********************************************************************************/
+void ConnectorLayoutManager::run()
+{
+	for (;;)
 	{
-		CloneContent * v = *it;
-		Avoid::ShapeRef * shapeRef = this->myShapeList[v];
-
-	    Avoid::Polygn newPoly = Avoid::newPoly(4);
-		newPoly.ps[0]= Avoid::Point(v->left(true), v->top(true));
-		newPoly.ps[1]= Avoid::Point(v->right(true), v->top(true));
-		newPoly.ps[2]= Avoid::Point(v->right(true), v->bottom(true));
-		newPoly.ps[3]= Avoid::Point(v->left(true), v->bottom(true));
-
-	    router->moveShape(shapeRef, &newPoly);
-	    Avoid::freePoly(newPoly);	    
+		this->mutex.lock();
+		while (!this->pendingJob && !this->stopping) this->jobPending.wait(&this->mutex);
+		RoutingJob * job = this->pendingJob;
+		this->pendingJob = NULL;
+		bool stop = this->stopping;
+		this->mutex.unlock();
+
+		if (stop) { delete job; break; }
+
+		if (!job->avoiding) this->clear();
+		else if (!this->isSuperseded(job)) this->routeLevels(job);
+		delete job;
 	}
-    router->processMoves();
-	
-	for (std::list<Connector*>::iterator it = this->connectors.begin(); it != this->connectors.end(); ++it)
-	{
-		Connector * e = *it;			
-		Avoid::ConnRef * connRef = this->myConnList[e];
-
-		// If the node at either end just moved, we need to update that connector
-		Avoid::Point srcPoint = Avoid::Point(e->getPoint(true).first, e->getPoint(true).second);
-		Avoid::Point tarPoint = Avoid::Point(e->getPoint(false).first, e->getPoint(false).second);
-		connRef->updateEndPoint(Avoid::VertID::src, srcPoint);
-		connRef->updateEndPoint(Avoid::VertID::tar, tarPoint);
 
-		connRef->generatePath();
-		std::list< std::pair <int, int> > controlPoints;
-		Avoid::Polygn route = connRef->route();
-		for (int i=0; i<route.pn; ++i) controlPoints.push_back(std::pair<int,int>(route.ps[i].x, route.ps[i].y));
-		e->setPoints(controlPoints);			
-	}	
-	
-	time_t end = time(NULL);
-	double t = difftime(end, start);
-	if (t) std::cout << "Update " << t << std::endl;	
+	this->clear();
 }
-*/
\ No newline at end of file
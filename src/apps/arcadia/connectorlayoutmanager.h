@@ -34,43 +34,184 @@
 #define CONNECTORLAYOUTMANAGER_H
 
 #include <list>
+#include <map>
+#include <vector>
 #include <libavoid/libavoid.h>
 
 #include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QThreadPool>
 
 class Connector;
-class CloneContent;
+class Content;
+class ContainerContent;
 class GraphLayout;
 class QProgressDialog;
 
 /*************************
 * ConnectorLayoutManager *
-**************************/
+**************************
+* Routes the Connectors of a GraphLayout around its contents (libavoid)
+*
+* Routing follows the ContainerContent tree of the layout: each container is
+* a routing level of its own, where its inner connectors (cf. getInnerConnectors)
+* are routed around its direct children only, be they clones or containers
+* A connector between two compartments is thus routed at the level of their
+* parent, around the compartments as a whole, ignoring what they contain
+* Every level works in coordinates relative to the top left corner of its container,
+* so that a container moved as a whole doesn't need any rerouting inside it
+*
+* Each level keeps a persistent libavoid Router, alive from one layout call to
+* the next: each call only synchronizes the Router with the current state of the level
+* (shapes and connectors added, moved or removed) then reroutes the connectors
+* libavoid flags as needing it. On top of that, a level keeps the routes it found
+* along with the snapshot it found them for: as long as nothing changes inside
+* its container, the level is not even looked at again (cf. routeLevels)
+*
+* Routing runs in a background thread (cf. run), never in the GUI thread:
+* layout() gives every Connector a straight line, takes a snapshot of every level
+* (child rectangles and connector end points, cf. RoutingJob),
+* and hands it over to the thread.
+* The thread only ever works on that snapshot (the Content and Connector
+* pointers are used as keys, never dereferenced) and sends its routes back
+* in batches, which get copied into the Connectors in the GUI thread (cf. publish)
+* Views are then told which Connectors got a new route (connectorsRouted signal)
+*
+* Within a batch, the paths are searched in parallel by a pool of threads,
+* over the visibility graph of the Router (left untouched by the searches)
+* each thread with its own search buffers. The paths are then committed in order,
+* so the routes do not depend on the number of threads (cf. searchPaths)
+*
+* In orthogonal mode (cf. GraphLayout::isOrthogonal) the connectors are routed
+* with horizontal and vertical segments only, by an Avoid::OrthogonalRouter
+* instead: there is no session there, the orthogonal visibility graph of a level
+* is cheap enough to be built anew whenever the level changes (cf. routeOrthogonally)
+*
+* Every job has a generation number: a new layout() call or a cancel()
+* supersedes the job in progress, and the results of an old generation are dropped
+*
+* The whole session is only torn down (in the background thread too)
+* when avoiding gets switched off, or when the manager is destroyed
+* This is quick: a Router keeps its visibility graph in arenas,
+* and frees it all at once along with its remaining shapes and connectors
+*******************************************************************************/
 class ConnectorLayoutManager : public QThread
 {
+	Q_OBJECT
+
 public:
 	ConnectorLayoutManager(GraphLayout * gl);
 	~ConnectorLayoutManager();
 	void layout();
 
+	std::list<Connector*> getRoutedConnectors() { return this->routedConnectors; }
+
+public slots:
+	void cancel();
+
+signals:
+	void batchRouted(); // background thread -> GUI thread
+	void connectorsRouted(); // GUI thread -> views
+
+private slots:
+	void publish();
+
 protected:
-	int totalCleanUpSteps;
-	int currentCleanUpSteps;
+	// What the background thread knows of the layout, level by level (relative coordinates)
+	struct ShapeSnapshot
+	{
+		Content * child; double left, top, right, bottom;
+		bool operator==(const ShapeSnapshot & s) const
+		{
+			return (child == s.child) && (left == s.left) && (top == s.top) && (right == s.right) && (bottom == s.bottom);
+		}
+	};
+	struct ConnectorSnapshot
+	{
+		Connector * connector; Content * source, * target; Avoid::Point src, tar; // source and target are children of the level
+		bool operator==(const ConnectorSnapshot & c) const
+		{
+			return (connector == c.connector) && (source == c.source) && (target == c.target) && (src == c.src) && (tar == c.tar);
+		}
+	};
+	struct LevelSnapshot
+	{
+		ContainerContent * container;
+		int originX, originY;
+		std::vector<ShapeSnapshot> shapes;
+		std::vector<ConnectorSnapshot> connectors;
+	};
+	struct RoutingJob
+	{
+		int generation;
+		bool avoiding;
+		bool orthogonal;
+		std::vector<LevelSnapshot> levels;
+		unsigned int connectorCount;
+	};
+
+	// What it sends back
+	struct Route { int generation; Connector * connector; std::list< std::pair <int, int> > points; };
+
+	// The routing session of a container, and the routes it found last (relative coordinates)
+	struct RoutingLevel
+	{
+		RoutingLevel() : router(NULL), objectCount(0), routed(false), orthogonal(false) {}
+
+		Avoid::Router * router; // NULL in orthogonal mode
+		unsigned int objectCount;
+		std::map< Content *, Avoid::ShapeRef * > myShapeList;
+		std::map< Connector *, Avoid::ConnRef * > myConnList;
+
+		bool routed; // all the routes below are up to date with the snapshot below
+		bool orthogonal;
+		std::vector<ShapeSnapshot> shapes;
+		std::vector<ConnectorSnapshot> connectors;
+		std::map< Connector *, std::list< std::pair <int, int> > > routes;
+	};
 
 	void run();
-	
-	void init();
-	void process();
+
+	void snapshot(ContainerContent * container, RoutingJob * job);
+	void routeLevels(RoutingJob * job);
 	void clear();
+	void clearLevel(RoutingLevel & level);
+
+	void synchronize(RoutingJob * job, LevelSnapshot & ls, RoutingLevel & level);
+	void process(RoutingJob * job, LevelSnapshot & ls, RoutingLevel & level, std::list<Route> & batch);
+
+	void synchronizeShapes(RoutingJob * job, LevelSnapshot & ls, RoutingLevel & level);
+	void synchronizeConnectors(RoutingJob * job, LevelSnapshot & ls, RoutingLevel & level);
+	void searchPaths(RoutingJob * job, RoutingLevel & level, std::vector<Avoid::ConnRef *> & pending);
+
+	void routeOrthogonally(RoutingJob * job, LevelSnapshot & ls, RoutingLevel & level, std::list<Route> & batch);
+
+	bool isSuperseded(RoutingJob * job) { return job->generation != (int) this->generation; }
+	void post(RoutingJob * job, LevelSnapshot & ls, Connector * connector, std::list< std::pair <int, int> > & points, std::list<Route> & batch);
+	void send(RoutingJob * job, std::list<Route> & batch, bool last);
 
 	GraphLayout * graphLayout;
-	std::list<Connector*> connectors;
-	std::list<CloneContent*> cloneDescriptors;
 
-	Avoid::Router * router;
-	std::map< CloneContent *, Avoid::ShapeRef * > myShapeList;
-	std::map< Connector *, Avoid::ConnRef * > myConnList;	
+	// Background thread only
+	std::map< ContainerContent *, RoutingLevel > levels;
+	QThreadPool searchPool;
+	std::vector<Avoid::PathSearch> searches; // one per thread of the pool
+	std::vector<Avoid::OrthogonalSearch> orthogonalSearches; // same, in orthogonal mode
+
+	// Shared between both threads (guarded by the mutex, except for the generation)
+	QMutex mutex;
+	QWaitCondition jobPending;
+	RoutingJob * pendingJob;
+	bool stopping;
+	QAtomicInt generation;
+	std::list<Route> routedBatch;
+	int routedGeneration; // the last job whose routes have all been sent
 
+	// GUI thread only
+	std::list<Connector*> routedConnectors;
+	int nRouted;
 	QProgressDialog * pd;
 };
 
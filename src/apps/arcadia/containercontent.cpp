@@ -38,8 +38,21 @@
 #include "stylesheet.h"
 
 // STL
+#include <set>
 #include <sstream>
 #include <iostream>
+#include <stdexcept>
+
+// Qt, for timing
+#include <QTime>
+
+// Qt, for the parallel layout
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
 
 // [!] wild guesses on the font size!!
 int ContainerContent::labelWidth() { return this->label.size()*7.5; }
@@ -50,18 +63,81 @@ int ContainerContent::labelHeight() { return (label!="")? 20: 0; }
 **************************************/
 unsigned int ContainerContent::Count = 0;
 
+/*****************
+* UpdateFlagMutex *
+******************
+* Sibling containers may be laid out in parallel (cf. layoutContent),
+* and moving their content flags their common ancestors from several threads at once
+*************************************************************************************/
+static QMutex UpdateFlagMutex;
+
+/****************
+* setUpdateFlag *
+*****************
+* The bounding box of the Container is obsolete, and so are those of its ancestors
+* The ancestors of an obsolete Container are always obsolete already,
+* so we stop at the first one: a move costs O(depth) at worst, and mostly O(1)
+* The layout hears of each Container that just became obsolete (for the view)
+***********************************************************************************/
 void ContainerContent::setUpdateFlag()
 {
-	this->updateFlagHori = true;
-	this->updateFlagTop = true;	
-	this->updateFlagBottom = true;	
+	QMutexLocker locker(&UpdateFlagMutex);
 
-	this->myL = 0;
-	this->myR = 0;
-	this->myT = 0;
-	this->myB = 0;
-	
-	if (this->container) this->container->setUpdateFlag();
+	for (ContainerContent * c = this; c && !c->updateFlag; c = c->container)
+	{
+		c->updateFlag = true;
+		c->layout->containerChanged(c);
+	}
+}
+
+/****************
+* setLayoutFlag *
+*****************
+* The structure of the Container changed (children added or removed, new core,
+* inner connectors changed, new strategy or rotation): its layout is out of date
+* and so is that of its ancestors, as its dimensions will change
+* The flag is only reset once the Container has been laid out again (cf. layoutContent)
+*****************************************************************************************/
+void ContainerContent::setLayoutFlag()
+{
+	for (ContainerContent * c = this; c; c = c->container) c->layoutFlag = true;
+}
+
+/*************************
+* setOffspringLayoutFlag *
+**************************
+* Flags the Container and every Container below it, whether they changed or not,
+* so that the next layout computes everything again (cf. GraphLayout::update)
+**********************************************************************************/
+void ContainerContent::setOffspringLayoutFlag()
+{
+	this->setLayoutFlag();
+	std::list<ContainerContent*> pending(1, this);
+	while (!pending.empty())
+	{
+		ContainerContent * c = pending.front();
+		pending.pop_front();
+		c->layoutFlag = true;
+		for (std::list<Content*>::iterator it = c->children.begin(); it != c->children.end(); ++it)
+		{
+			if ((*it)->getId() != "") pending.push_back((ContainerContent*)(*it));
+		}
+	}
+}
+
+/*******************
+* GetContainerType *
+********************
+* The kind of container matching a type label
+* (the unknown ones are generic)
+*********************************************/
+static ContainerType GetContainerType(std::string t)
+{
+	if (t == "CloneContainer") return cloneContainer;
+	if (t == "BranchContainer") return branchContainer;
+	if (t == "TriangleContainer") return triangleContainer;
+	if (t == "CompContainer") return compartmentContainer;
+	return genericContainer;
 }
 
 /**************
@@ -72,15 +148,18 @@ void ContainerContent::setUpdateFlag()
 * and creates a default layoutManager
 * with a rotation opposite of that of its Container
 ***************************************************/
-ContainerContent::ContainerContent(GraphLayout *gl, ContainerContent *c, std::string t, std::string l) : Content(gl, c), containerType(t), label(l), core(NULL)
+ContainerContent::ContainerContent(GraphLayout *gl, ContainerContent *c, std::string t, std::string l) : Content(gl, c), containerType(t), type(GetContainerType(t)), label(l), core(NULL), updateFlag(false)
 {
 	this->setUpdateFlag(); // the dimensions have not been computed yet
+	this->setLayoutFlag(); // and neither has the layout
 
 	std::ostringstream oss;
 	oss << ContainerContent::Count++;
 	this->cId = oss.str();
 
 	this->layoutManager = ContentLayoutManager::GetLayoutManager();
+
+	this->layout->containerAdded(this);
 }
 
 void ContainerContent::setContainer(ContainerContent *c)
@@ -88,7 +167,9 @@ void ContainerContent::setContainer(ContainerContent *c)
 	Content::setContainer(c);
 	if (this->container && this->layoutManager && this->layoutManager->getType() != Hierarchy)
 	{
-		this->layoutManager->setRotation(!this->container->layoutManager->getRotation());
+		bool rotation = !this->container->layoutManager->getRotation();
+		if (this->layoutManager->getRotation() != rotation) this->setLayoutFlag();
+		this->layoutManager->setRotation(rotation);
 	}
 }
 
@@ -97,6 +178,7 @@ void ContainerContent::setContainer(ContainerContent *c)
 **************
 * Deletes all the children
 * and the layout manager
+* then tells the layout
 **************************/
 ContainerContent::~ContainerContent()
 {
@@ -104,6 +186,8 @@ ContainerContent::~ContainerContent()
 	for (std::list<Content*>::iterator it = cList.begin(); it != cList.end(); ++it) delete *it;
 
 	delete this->layoutManager;
+
+	this->layout->containerRemoved(this);
 }
 
 /***********************************************************************
@@ -149,7 +233,7 @@ int ContainerContent::x()
 	int value;
 	
 	// the condition on compartments means their core gets ignored layout wise
-	if (this->core && this->getTypeLabel() != "CompContainer")
+	if (this->core && this->getType() != compartmentContainer)
 	{
 		value = this->core->x();
 	}
@@ -167,7 +251,7 @@ int ContainerContent::y()
 	int value;
 
 	// the condition on compartments means their core gets ignored layout wise
-	if (this->core && this->getTypeLabel() != "CompContainer")
+	if (this->core && this->getType() != compartmentContainer)
  	{
 		value = this->core->y();
 	}
@@ -189,9 +273,9 @@ int ContainerContent::y()
 **********************************************/
 int ContainerContent::left(bool withMargin)
 {
+	this->updateBoundingBox();
 	if (this->children.empty()) return 0;
-	this->updateHori(withMargin);
-	return this->myL;
+	return this->myL - (withMargin? this->fullOffset: this->boundingOffset);
 }
 
 /********
@@ -201,38 +285,9 @@ int ContainerContent::left(bool withMargin)
 ***********************************************/
 int ContainerContent::right(bool withMargin)
 {
+	this->updateBoundingBox();
 	if (this->children.empty()) return 0;
-	this->updateHori(withMargin);	
-	return this->myR;
-}
-
-void ContainerContent::updateHori(bool withMargin)
-{
-	if (!this->updateFlagHori) return;
-
-	std::list<Content*>::iterator it = this->children.begin();
-	int r = (*it)->right(true);
-	int l = (*it)->left(true);
-	for (++it; it != this->children.end(); ++it)
-	{
-		if ((*it)->right(true)  > r) r = (*it)->right(true);			
-		if ((*it)->left(true) < l) l = (*it)->left(true);
-	}
-	
-	if (r-l < this->labelWidth()) { l = (r+l)/2 - this->labelWidth()/2; }
-	if (r-l < this->labelWidth()) { r = (r+l)/2 + this->labelWidth()/2; }
-
-	int offset;
-	ContainerStyle * cs = this->layout->getStyleSheet()->getContainerStyle(this->getLabel());
-	if (withMargin)  offset= cs->getFullOffset()/2; // padding + border + margin
-	else offset = cs->getBoundingOffset()/2; // padding + border
-	l -= offset;
-	r += offset;
-	
-	this->myL = l;	
-	this->myR = r;	
-
-	this->updateFlagHori = false;
+	return this->myR + (withMargin? this->fullOffset: this->boundingOffset);
 }
 
 /******
@@ -242,9 +297,9 @@ void ContainerContent::updateHori(bool withMargin)
 *********************************************/
 int ContainerContent::top(bool withMargin)
 {
+	this->updateBoundingBox();
 	if (this->children.empty()) return 0;
-	this->updateTop(withMargin);
-	return this->myT;
+	return this->myT - (withMargin? this->fullOffset: this->boundingOffset);
 }
 
 /*********
@@ -254,56 +309,60 @@ int ContainerContent::top(bool withMargin)
 *************************************************/
 int ContainerContent::bottom(bool withMargin)
 {
+	this->updateBoundingBox();
 	if (this->children.empty()) return 0;
-	this->updateBottom(withMargin);
-	return this->myB;
+	return this->myB + (withMargin? this->fullOffset: this->boundingOffset);
 }
 
-void ContainerContent::updateTop(bool withMargin)
+/********************
+* updateBoundingBox *
+*********************
+* If it is obsolete, computes the bounding box of the children again, in a single pass
+* (with room for the label) along with the offsets of the container style:
+* the borders with and without margin are then read from that cache
+* The flag is reset even when there is no child,
+* so that the next change does flag the ancestors (cf. setUpdateFlag)
+****************************************************************************************/
+void ContainerContent::updateBoundingBox()
 {
-	if (!this->updateFlagTop) return;
+	if (!this->updateFlag) return;
 
-	std::list<Content*>::iterator it = this->children.begin();
-	int t = (*it)->top(true);
-	for (++it; it != this->children.end(); ++it)
+	if (!this->children.empty())
 	{
-		if ((*it)->top(true) < t) t = (*it)->top(true);
-	}
-
-	int offset;
-	ContainerStyle * cs = this->layout->getStyleSheet()->getContainerStyle(this->getLabel());
-	if (withMargin)  offset= cs->getFullOffset()/2; // padding + border + margin
-	else offset = cs->getBoundingOffset()/2; // padding + border
-	t -= offset;
+		std::list<Content*>::iterator it = this->children.begin();
+		int l = (*it)->left(true);
+		int r = (*it)->right(true);
+		int t = (*it)->top(true);
+		int b = (*it)->bottom(true);
+		for (++it; it != this->children.end(); ++it)
+		{
+			int value = (*it)->left(true);
+			if (value < l) l = value;
+			value = (*it)->right(true);
+			if (value > r) r = value;
+			value = (*it)->top(true);
+			if (value < t) t = value;
+			value = (*it)->bottom(true);
+			if (value > b) b = value;
+		}
 
-	// extra space for the label
-	t -= this->labelHeight();
+		if (r-l < this->labelWidth()) { l = (r+l)/2 - this->labelWidth()/2; }
+		if (r-l < this->labelWidth()) { r = (r+l)/2 + this->labelWidth()/2; }
 
-	this->myT = t;
+		// extra space for the label
+		t -= this->labelHeight();
 
-	this->updateFlagTop = false;
-}
+		this->myL = l;
+		this->myR = r;
+		this->myT = t;
+		this->myB = b;
 
-void ContainerContent::updateBottom(bool withMargin)
-{
-	if (!this->updateFlagBottom) return;
-
-	std::list<Content*>::iterator it = this->children.begin();
-	int b = (*it)->bottom(true);
-	for (++it; it != this->children.end(); ++it)
-	{
-		if ((*it)->bottom(true) > b) b = (*it)->bottom(true);			
+		ContainerStyle * cs = this->layout->getStyleSheet()->getContainerStyle(this->getLabel());
+		this->fullOffset = cs->getFullOffset()/2; // padding + border + margin
+		this->boundingOffset = cs->getBoundingOffset()/2; // padding + border
 	}
 
-	int offset;
-	ContainerStyle * cs = this->layout->getStyleSheet()->getContainerStyle(this->getLabel());
-	if (withMargin)  offset= cs->getFullOffset()/2; // padding + border + margin
-	else offset = cs->getBoundingOffset()/2; // padding + border
-	b += offset;
-
-	this->myB = b;
-
-	this->updateFlagBottom = false;
+	this->updateFlag = false;
 }
 
 /***********************************************************************
@@ -350,11 +409,14 @@ ContainerContent * ContainerContent::CommonAncestor(ContainerContent * c1, Conta
 *******
 * adds the new child to the list
 * and sets itself up as its container
-*************************************/
+* The child leaves its old container first:
+* otherwise their common ancestors would count its connector ends twice
+***********************************************************************/
 void ContainerContent::add(Content *c, bool asCore)
 {
-	if (asCore) this->core = c;
-	if (!this->has(c)) this->children.push_back(c);
+	if (c->getContainer() && !c->hasContainer(this)) c->getContainer()->remove(c);
+	if (asCore && this->core != c) { this->core = c; this->setLayoutFlag(); }
+	if (!this->has(c)) { this->children.push_back(c); this->countChildEnds(c, 1); this->setLayoutFlag(); this->setUpdateFlag(); }
 	if (!c->hasContainer(this)) c->setContainer(this);
 
 	if (this->getContentLayoutStrategy() == Triangle)
@@ -381,6 +443,7 @@ void ContainerContent::add(std::list<CloneContent *> cList)
 ***********************************/
 void ContainerContent::remove(Content *c)
 {
+	if (this->has(c)) { this->countChildEnds(c, -1); this->setLayoutFlag(); this->setUpdateFlag(); }
 	this->children.remove(c);
 	c->setContainer(NULL);
 	if (c == this->core) this->core = NULL; // what is the new core, though???
@@ -410,19 +473,168 @@ std::list<Content*> ContainerContent::getChildren() { return this->children; }
 * Content layout                                                       *
 ***********************************************************************/
 
+/***************************
+* ContainerLayoutSchedule *
+***************************
+* The state shared by the layout tasks of a container tree (cf. layoutContent):
+* for each container, the number of its child containers that still need a layout
+* An exception can't cross threads: the first error message is kept, and the remaining layouts are skipped
+***********************************************************************************************************/
+struct ContainerLayoutSchedule
+{
+	ContainerLayoutSchedule() : failed(false) {}
+
+	QThreadPool pool;
+	std::map<ContainerContent*, QAtomicInt> pending;
+
+	QMutex mutex;
+	bool failed;
+	std::string error;
+};
+
+/**********************
+* ContainerLayoutTask *
+***********************
+* Performs the layout of one container, once all its child containers are done
+* Then, if that was the last child container its parent was waiting for, starts the parent's task
+**************************************************************************************************/
+class ContainerLayoutTask : public QRunnable
+{
+public:
+	ContainerLayoutTask(ContainerContent * c, ContainerLayoutSchedule & s) : container(c), schedule(s) {}
+
+	void run()
+	{
+		try
+		{
+			bool failed;
+			{ QMutexLocker locker(&this->schedule.mutex); failed = this->schedule.failed; }
+			if (!failed) this->container->layoutOwnContent();
+		}
+		catch (std::exception & err)
+		{
+			QMutexLocker locker(&this->schedule.mutex);
+			if (!this->schedule.failed) { this->schedule.failed = true; this->schedule.error = err.what(); }
+		}
+
+		std::map<ContainerContent*, QAtomicInt>::iterator it = this->schedule.pending.find(this->container->getContainer());
+		if (it == this->schedule.pending.end()) return; // the top of the tree, or a container held back for the serial layout
+		if (!it->second.deref()) this->schedule.pool.start(new ContainerLayoutTask(it->first, this->schedule));
+	}
+
+private:
+	ContainerContent * container;
+	ContainerLayoutSchedule & schedule;
+};
+
 /****************
 * layoutContent *
 *****************
 * Asks all the children to perform their own layout
 * then performs its own layout
-***************************************************/
+* Only the Containers flagged as changed are concerned (cf. setLayoutFlag):
+* the others keep the relative positions of their content, and just get moved around as a whole
+*
+* Sibling containers do not depend on each other, so the whole tree of containers
+* is laid out bottom-up by a thread pool: a container starts as soon as all its child containers are done
+* [!] QThreadPool has a single queue, no work stealing: fine, as there is one task per container
+* [!] graphviz (libgraph) is not reentrant, so graphviz layouts still take turns (cf. GraphvizContentLayoutManager)
+* [!] a container with triangle children reads the positions of their neighbours, wherever they are in the tree
+*     (cf. GraphvizContentLayoutManager::layoutTriangleContainers): such a container, and its ancestors,
+*     are held back and laid out serially, once every other container is done
+*
+* The bounding boxes are computed once beforehand, on this thread:
+* this creates every style the layouts will need (they are created on first use, without any lock)
+**************************************************************************************************************************/
 void ContainerContent::layoutContent()
 {
-	for (std::list<Content*>::iterator it = this->children.begin(); it != this->children.end(); ++it)
+	if (!this->layoutFlag) return;
+
+	// all the containers of the tree that changed, children first (in the order of a serial layout)
+	std::list<ContainerContent*> containers;
+	std::list< std::pair<ContainerContent*, std::list<Content*>::iterator> > path;
+	path.push_back(std::make_pair(this, this->children.begin()));
+	while (!path.empty())
+	{
+		ContainerContent * c = path.back().first;
+		std::list<Content*>::iterator & it = path.back().second;
+
+		if (it == c->children.end()) { containers.push_back(c); path.pop_back(); continue; }
+
+		Content * child = *(it++);
+		if (child->getId() != "" && ((ContainerContent*)child)->layoutFlag) path.push_back(std::make_pair((ContainerContent*)child, ((ContainerContent*)child)->children.begin()));
+	}
+
+	// nothing to parallelise
+	if (containers.size() == 1 || QThread::idealThreadCount() < 2)
+	{
+		for (std::list<ContainerContent*>::iterator it = containers.begin(); it != containers.end(); ++it) (*it)->layoutOwnContent();
+		return;
+	}
+
+	// the containers with triangle children, and their ancestors
+	std::set<ContainerContent*> held;
+	for (std::list<ContainerContent*>::iterator it = containers.begin(); it != containers.end(); ++it)
+	{
+		bool triangle = false;
+		for (std::list<Content*>::iterator ct = (*it)->children.begin(); ct != (*it)->children.end() && !triangle; ++ct)
+		{
+			triangle = (*ct)->getId() != "" && ((ContainerContent*)(*ct))->getContentLayoutStrategy() == Triangle;
+		}
+		if (!triangle) continue;
+
+		for (ContainerContent * c = *it; c && held.insert(c).second && c != this; c = c->container);
+	}
+
+	this->left(true); this->top(true); this->bottom(true);
+
+	ContainerLayoutSchedule schedule;
+	for (std::list<ContainerContent*>::iterator it = containers.begin(); it != containers.end(); ++it)
+	{
+		if (held.find(*it) == held.end()) schedule.pending[*it] = 0;
+	}
+	for (std::map<ContainerContent*, QAtomicInt>::iterator it = schedule.pending.begin(); it != schedule.pending.end(); ++it)
+	{
+		if (it->first == this) continue;
+		std::map<ContainerContent*, QAtomicInt>::iterator parent = schedule.pending.find(it->first->container);
+		if (parent != schedule.pending.end()) parent->second.ref();
+	}
+
+	for (std::map<ContainerContent*, QAtomicInt>::iterator it = schedule.pending.begin(); it != schedule.pending.end(); ++it)
+	{
+		if (it->second == 0) schedule.pool.start(new ContainerLayoutTask(it->first, schedule));
+	}
+	schedule.pool.waitForDone();
+
+	if (schedule.failed) throw std::runtime_error(schedule.error);
+
+	// the containers held back, children first
+	for (std::list<ContainerContent*>::iterator it = containers.begin(); it != containers.end(); ++it)
 	{
-		(*it)->layoutContent();
+		if (held.find(*it) != held.end()) (*it)->layoutOwnContent();
 	}
+}
+
+/*******************
+* layoutOwnContent *
+********************
+* Performs its own layout only, the children being done already
+* (and reports how long that took, cf. ContentLayoutManager::Timing)
+* The layout is then up to date
+**********************************************************************/
+void ContainerContent::layoutOwnContent()
+{
+	QTime timer;
+	timer.start();
+
 	this->layoutManager->layout(this);
+	this->layoutFlag = false;
+
+	if (ContentLayoutManager::Timing)
+	{
+		std::cerr << this->containerType << " \"" << this->label << "\" (" << this->children.size() << " children): "
+			<< timer.elapsed() << " ms" << std::endl;
+	}
 }
 
 /***********************************************************************
@@ -432,63 +644,63 @@ void ContainerContent::layoutContent()
 /********************
 * getInnerConnector *
 *********************
-* Browses the children's OutterConnector lists
-* Returns every connector that appears twice:
-* it means they begin and they end inside an offspring of the Container
-* + they spring out of the Container's direct children
-* [!] it works, but what about efficiency?
-***********************************************************************/
+* Returns every connector that begins and ends inside an offspring of the Container
+* but in two different direct children
+***********************************************************************************/
 std::list<Connector*> ContainerContent::getInnerConnectors()
 {
-	std::list<Connector*> iList;
-
-	std::map<Connector*, int> cMap;		
-	for (std::list< Content* >::iterator it = this->children.begin(); it != this->children.end(); ++it)
-	{
-		std::list<Connector*> oList = (*it)->getOutterConnectors();
-		for (std::list<Connector*>::iterator ot = oList.begin(); ot != oList.end(); ++ot)
-		{
-			if (cMap.find(*ot) == cMap.end()) { cMap[*ot] = 1; }
-			else { cMap[*ot]++; }
-		}
-	}
-	for (std::map<Connector*, int>::iterator it = cMap.begin(); it != cMap.end(); ++it)
-	{
-		if ((*it).second == 2) iList.push_back((*it).first);
-	}
-		
-	return iList;
+	return std::list<Connector*>(this->innerConnectors.begin(), this->innerConnectors.end());
 }
 	
 /********************
 * getOutterConnector *
 *********************
-* Browses the children's OutterConnector lists
-* Returns every connector that appears only once:
-* it means they begin or end inside an offspring of the Container
-* but end or begin at a point that is outside of the Container
-* [!] it works, but what about efficiency?
-***********************************************************************/
+* Returns every connector that begins or ends inside an offspring of the Container
+* but ends or begins at a point that is outside of the Container
+***********************************************************************************/
 std::list<Connector*> ContainerContent::getOutterConnectors()
 {
-	std::list<Connector*> iList;
+	return std::list<Connector*>(this->outterConnectors.begin(), this->outterConnectors.end());
+}
 
-	std::map<Connector*, bool> cMap;		
-	for (std::list< Content* >::iterator it = this->children.begin(); it != this->children.end(); ++it)
-	{
-		std::list<Connector*> oList = (*it)->getOutterConnectors();
-		for (std::list<Connector*>::iterator ot = oList.begin(); ot != oList.end(); ++ot)
-		{
-			if (cMap.find(*ot) == cMap.end()) { cMap[*ot] = true; }
-			else { cMap.erase(*ot); }
-		}
-	}
-	for (std::map<Connector*, bool>::iterator it = cMap.begin(); it != cMap.end(); ++it)
+/************
+* countEnds *
+*************
+* Some ends of a connector (delta, negative when removed) came in or left the Container
+* below is the number of ends now held by the child they went through
+* With one end inside, the connector is an outter one
+* With both ends inside, it is an inner one unless they are both held by the same child
+* Returns the number of ends now held by the Container, for its own container
+*****************************************************************************************/
+int ContainerContent::countEnds(Connector * c, int delta, int below)
+{
+	int & ends = this->connectorEnds[c];
+	ends += delta;
+	int n = ends;
+	if (n == 0) this->connectorEnds.erase(c);
+
+	if (n == 1) this->outterConnectors.insert(c);
+	else this->outterConnectors.erase(c);
+
+	if ((n == 2) && (below != 2)) this->innerConnectors.insert(c);
+	else this->innerConnectors.erase(c);
+
+	return n;
+}
+
+/*****************
+* countChildEnds *
+******************
+* A child came in (sign = 1) or left (sign = -1) along with the connector ends it holds:
+* the Container and its ancestors count them in or out
+****************************************************************************************/
+void ContainerContent::countChildEnds(Content * c, int sign)
+{
+	for (std::map<Connector*, int>::iterator it = c->connectorEnds.begin(); it != c->connectorEnds.end(); ++it)
 	{
-		iList.push_back((*it).first);
+		int below = this->countEnds(it->first, sign * it->second, (sign > 0)? it->second: 0);
+		for (ContainerContent * a = this->container; a; a = a->container) below = a->countEnds(it->first, sign * it->second, below);
 	}
-		
-	return iList;	
 }
 
 ContentLayoutStrategy ContainerContent::getContentLayoutStrategy() { return this->layoutManager->getType(); }
@@ -503,8 +715,11 @@ void ContainerContent::setContentLayoutStrategy(ContentLayoutStrategy s)
 		this->layoutManager->setRotation(!this->container->layoutManager->getRotation());	
 	}
 	
+	this->setLayoutFlag();
+
 	if (s == Clone) this->containerType = "CloneContainer";
 	if (s == Branch) this->containerType = "BranchContainer";
 	if (s == Triangle) this->containerType = "TriangleContainer";
 	if (s == Neighbourhood) this->containerType = "TriangleContainer";
+	this->type = GetContainerType(this->containerType);
 }
\ No newline at end of file
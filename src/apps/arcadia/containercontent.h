@@ -39,12 +39,20 @@
 // STL
 #include <list>
 #include <map>
+#include <set>
 
 // local, for laying out children
 #include "contentlayoutmanager.h"
+#include "graphrange.h"
 
 class CloneContent;
 
+typedef GraphRange<Content*, std::list<Content*>::const_iterator> ContentRange;
+typedef GraphRange<Connector*, std::set<Connector*>::const_iterator> ConnectorSetRange;
+
+// The kind of container, following its type label (one integer to compare, rather than the label)
+enum ContainerType { genericContainer, cloneContainer, branchContainer, triangleContainer, compartmentContainer };
+
 /************
 * ContainerContent *
 *************
@@ -54,22 +62,26 @@ class CloneContent;
 * 
 * The Container role is to manage its Content list, aka children (that get deleted upon its deletion)
 * For doing so, there are methods such as add, remove, has, and getChildren
+* (getChildRange browses the children in place, rather than copying the list)
 *
 * The Container also handles the layout of its content,
 * thanks to the layoutContent method and an internal layoutManager 
 * [!] no method to set that one!
+* Only the Containers whose structure changed since their last layout get laid out again (cf. setLayoutFlag)
 *
 * Being a Content itself, the Container has a geometry (for layout purposes)
 * When setting its own position, it's actually the children that are translated
 * Indeed, the position of the Container is the center of the rectangle bounding its content
 * Its width and height depend on its children's dimension and internal position
 * as they are computed from the difference between minimal/maximal left-right and top-bottom values
+* That bounding box is cached, until a change below flags the Container and its ancestors (cf. setUpdateFlag)
 *
 * Finally, although having no Connectors of its own,
 * a Container is affected by its clone children's (in term of layout)
 * GetInnerConnectors finds the Connectors spanning between its direct children
 * GetOutterConnector finds the Connectors linking some of its clone descendants to outsiders
-* [!] seems to work, but is a bit non trivial, so should double-check
+* Both sets are kept up to date as clones and connectors come and go (cf. countEnds),
+* and can be browsed in place (getInnerConnectorRange, getOutterConnectorRange)
 *****************************************************************************************************/
 class ContainerContent: public Content
 {
@@ -100,12 +112,15 @@ public:
  	void remove(Content *c);	
 	bool has(Content *c);
 	std::list< Content* > getChildren();
+	ContentRange getChildRange() { return ContentRange(this->children); }
 	// moveContentTo(ContainerContent *c) { c->add(this->getChildren()); }
 
 	void layoutContent();
 		
 	std::list<Connector*> getInnerConnectors();	
 	std::list<Connector*> getOutterConnectors();
+	ConnectorSetRange getInnerConnectorRange() { return ConnectorSetRange(this->innerConnectors.begin(), this->innerConnectors.end()); }
+	ConnectorSetRange getOutterConnectorRange() { return ConnectorSetRange(this->outterConnectors.begin(), this->outterConnectors.end()); }
 	
 	ContentLayoutStrategy getContentLayoutStrategy();
 	void setContentLayoutStrategy(ContentLayoutStrategy s);
@@ -113,6 +128,7 @@ public:
 	void setContainer(ContainerContent * c);
 		
 	std::string getTypeLabel() { return this->containerType; }
+	ContainerType getType() { return this->type; }
 		
 	std::string getLabel() { return this->label; }
 	virtual std::string getReference() { return ""; }
@@ -120,6 +136,9 @@ public:
 	Content * getCore() { return this->core; }
 	
 	void setUpdateFlag();
+	void setLayoutFlag();
+	void setOffspringLayoutFlag();
+	bool getLayoutFlag() { return this->layoutFlag; }
 
 	std::string stringVersion();
 
@@ -136,19 +155,31 @@ private:
 	std::list< Content* > children;	
 	ContentLayoutManager *layoutManager;
 	std::string containerType;
+	ContainerType type;
+
+	bool layoutFlag;
 
-	bool updateFlagHori;
-	bool updateFlagTop;
-	bool updateFlagBottom;
+	// cached bounding box of the children, without the offsets of the style
+	bool updateFlag;
 
 	int myL;
 	int myR;
 	int myT;
 	int myB;
+	int fullOffset;
+	int boundingOffset;
 	
-	void updateHori(bool b);
-	void updateTop(bool b);
-	void updateBottom(bool b);
+	void updateBoundingBox();
+
+	// connectors between the children, and between the descendants and the outside
+	std::set<Connector*> innerConnectors;
+	std::set<Connector*> outterConnectors;
+	int countEnds(Connector * c, int delta, int below);
+	void countChildEnds(Content * c, int sign);
+	friend class Content;
+
+	void layoutOwnContent();
+	friend class ContainerLayoutTask;
 };
 
 #endif
\ No newline at end of file
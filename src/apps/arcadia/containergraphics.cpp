@@ -288,8 +288,10 @@ QPainterPath ContainerGraphics::shape() const { return this->boundingShape; }
 * paint *
 *********
 * Sets up the pen to a fixed width (default color black)
-* then paints the painting shape
-********************************************************/	
+* then paints the painting shape, and the label
+* In overview, only fills the rectangle, with a light shade of the colour
+* and the label only shows when not too zoomed out
+***************************************************************************/	
 void ContainerGraphics::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
 	if (!this->style->isVisible()) return;
@@ -298,6 +300,17 @@ void ContainerGraphics::paint(QPainter *painter, const QStyleOptionGraphicsItem
 	std::string label = this->container->getLabel();
 
 	QColor c(this->style->red(), this->style->green(), this->style->blue());
+	DetailLevel detail = GraphGraphics::GetDetailLevel(option, widget);
+
+	if (detail == overviewDetail)
+	{
+		if (this->container->isHidden()) return;
+		QColor fill = c;
+		fill.setAlpha(63);
+		painter->fillRect(shape.boundingRect(), fill);
+		return;
+	}
+
 	Qt::PenStyle ps = this->style->getContinuousLine()? Qt::SolidLine: Qt::DashLine;
 
 	QPen p;
@@ -307,7 +320,7 @@ void ContainerGraphics::paint(QPainter *painter, const QStyleOptionGraphicsItem
 	painter->setPen(p);
 	if (!this->container->isHidden()) painter->drawPath(shape);
 	
-	if (label == "") return;
+	if (label == "" || detail < shapeDetail) return;
 
 	QRectF r = this->getRect(this->fullRect, -this->style->getFullOffset());
 	painter->drawText(r, Qt::AlignLeft || Qt::AlignTop, label.c_str());
@@ -34,6 +34,7 @@
 
 // local
 #include "containercontent.h"
+#include "graphlayout.h"
 
 #include <iostream>
 
@@ -62,6 +63,13 @@ Content::Content(GraphLayout *l, ContainerContent * c)
 *****************************************/
 Content::~Content() { this->setContainer(NULL); }
 
+/***************************************************************
+* operator new, operator delete: memory from the layout's pool *
+***************************************************************/
+void * Content::operator new(std::size_t size, GraphLayout * l) { return l->getPool().allocate(size); }
+void Content::operator delete(void * p, GraphLayout *) { LayoutPool::release(p); }
+void Content::operator delete(void * p) { LayoutPool::release(p); }
+
 /***********************************************************************
 * Id access                                                            *
 ***********************************************************************/
@@ -108,6 +116,19 @@ void Content::setContainer(ContainerContent * c)
 	if (c) if (!c->has(this)) c->add(this);
 }
 
+/****************
+* propagateEnds *
+*****************
+* The Content gained (or lost) some ends of a connector:
+* so did each of its ancestors, which update their connector sets accordingly
+*****************************************************************************/
+void Content::propagateEnds(Connector * c, int delta)
+{
+	std::map<Connector*, int>::iterator it = this->connectorEnds.find(c);
+	int below = (it == this->connectorEnds.end())? 0: it->second;
+	for (ContainerContent * a = this->container; a; a = a->container) below = a->countEnds(c, delta, below);
+}
+
 int Content::getLevel()
 {
 	ContainerContent * c = this->getContainer();
@@ -34,8 +34,10 @@
 #define CONTENT_H
 
 // STL
+#include <cstddef>
 #include <string>
 #include <list>
+#include <map>
 
 // local
 class Connector;
@@ -65,6 +67,10 @@ class GraphLayout;
 * (redefined by the Container class)
 *
 * Finally, a getOutterConnector function is declared, but not defined at that level
+* The number of connector ends held by each Content (itself if a Clone, its descendants if a Container)
+* is kept up to date in connectorEnds, so that Containers can index their connectors (cf. countEnds)
+*
+* Contents are allocated from the pool of their layout, through new (layout) Content(layout, ...)
 *****************************************************************************************************/
 class Content
 {
@@ -72,6 +78,13 @@ public:
 	Content(GraphLayout * l, ContainerContent * c = NULL);
 	virtual ~Content();
 
+	// memory from the pool of the layout (cf. LayoutPool)
+	static void * operator new(std::size_t size, GraphLayout * l);
+	static void operator delete(void * p, GraphLayout * l);
+	static void operator delete(void * p);
+
+	GraphLayout * getLayout() { return this->layout; }
+
 	bool setAsCore();
 
 	std::string getId();
@@ -111,6 +124,11 @@ protected:
 	ContainerContent * container;
 	
 	bool hidden; // [!] really only used for compartment containers, to hide the border...
+
+	std::map<Connector*, int> connectorEnds; // how many ends of each connector lie in that Content
+	void propagateEnds(Connector * c, int delta);
+
+	friend class ContainerContent;
 };
 
 #endif
\ No newline at end of file
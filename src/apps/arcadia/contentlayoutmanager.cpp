@@ -32,15 +32,24 @@
 
 #include "contentlayoutmanager.h"
 
+// for getenv
+#include <stdlib.h>
+
 // local subclasses to be instanciated by tghe factory
 #include "squarecontentlayoutmanager.h"
 #include "graphvizcontentlayoutmanager.h"
+#include "forcecontentlayoutmanager.h"
 
 /***************************************************
 * DefaultStrategy: Set to Hierarchy (graphviz dot) *
 ***************************************************/
 ContentLayoutStrategy ContentLayoutManager::DefaultStrategy = Hierarchy;
 
+/*********************************************************************
+* Timing: On if the ARCADIA_LAYOUT_TIMING environment variable is set *
+*********************************************************************/
+bool ContentLayoutManager::Timing = (getenv("ARCADIA_LAYOUT_TIMING") != NULL);
+
 /*******************
 * GetLayoutManager *
 ********************
@@ -69,6 +78,9 @@ ContentLayoutManager* ContentLayoutManager::GetLayoutManager(ContentLayoutStrate
 	case Neighbourhood:
 		layoutManager = new GraphvizContentLayoutManager("twopi");
 		break;
+	case Force:
+		layoutManager = new ForceContentLayoutManager();
+		break;
 	case NoStrategy:
 		layoutManager = new ContentLayoutManager();
 		break;
@@ -39,10 +39,10 @@ class ContainerContent;
 /************************
 * ContentLayoutStrategy *
 *************************
-* List of all the possible Layout Strategies (3 ATM, but should grow)
+* List of all the possible Layout Strategies (should grow)
 * [!] to store independently, somewhere else? (make extensible??)
 *********************************************************************/
-enum ContentLayoutStrategy { NoStrategy, Automatic, Hierarchy, Clone, Neighbourhood, Branch, Triangle };
+enum ContentLayoutStrategy { NoStrategy, Automatic, Hierarchy, Clone, Neighbourhood, Branch, Triangle, Force };
 
 /***********************
 * ContentLayoutManager *
@@ -57,12 +57,16 @@ enum ContentLayoutStrategy { NoStrategy, Automatic, Hierarchy, Clone, Neighbourh
 *
 * The main interface, that is the method to layout a Container, does NOTHING
 * (see sub-classes for different implementations)
+*
+* When Timing is on (ARCADIA_LAYOUT_TIMING environment variable set)
+* the time spent laying out each container is reported on the error output
 ****************************************************************************/
 class ContentLayoutManager {
 private:
 	static ContentLayoutStrategy DefaultStrategy;
 public:
 	static ContentLayoutManager * GetLayoutManager(ContentLayoutStrategy s = ContentLayoutManager::DefaultStrategy);
+	static bool Timing;
 
 	ContentLayoutManager();
 	virtual ~ContentLayoutManager() { }
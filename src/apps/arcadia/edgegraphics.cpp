@@ -39,7 +39,6 @@
 #include <QFrame> // for computing the visible area
 #include <QGraphicsView> // for computing the visible area
 
-#include <twines/include/twine.h>
 #include <math.h>
 
 // local
@@ -81,9 +80,10 @@ void EdgeGraphics::quickUpdate()
 	this->source = this->getPoint(true);
 	this->target = this->getPoint(false);
 
-	this->points.clear();
-	this->points.push_back(this->source);
-	this->points.push_back(this->target);
+	std::list<QPointF> newPoints;
+	newPoints.push_back(this->source);
+	newPoints.push_back(this->target);
+	this->setPoints(newPoints);
 
 	this->updateShapes();
 }
@@ -100,6 +100,9 @@ EdgeGraphics::EdgeGraphics(LayoutGraphView * gs, Connector * c, EdgeStyle *s, bo
 //	this->setFlags(QGraphicsItem::ItemIsSelectable|QGraphicsItem::ItemIsMovable);
 	
 	this->hidden = h;
+	this->splineFlag = true;
+	this->setZValue(0);
+//	this->setZValue(isSelected? 2: 0); // [!] ugly with decorations at the wrong place when selected
 	this->setStyle(s);
 	this->setPosition();
 }
@@ -136,21 +139,37 @@ void EdgeGraphics::updatePos()
 	}
 }
 
+// The connector got a new route (same end points, maybe the same number of points too)
+void EdgeGraphics::updateRoute()
+{
+	if (this->hidden) return;
+	this->setPosition();
+}
+
 void EdgeGraphics::setPosition()
 {
 	this->source = this->getPoint(true);
 	this->target = this->getPoint(false);
 
-	this->points.clear();
+	std::list<QPointF> newPoints;
 	std::list< std::pair <int, int> > cPoints = this->connector->getPoints();
 	for (std::list< std::pair <int, int> >::iterator it = cPoints.begin(); it != cPoints.end(); ++it)
 	{
-		this->points.push_back(QPointF((*it).first, (*it).second));		
+		newPoints.push_back(QPointF((*it).first, (*it).second));		
 	}
+	this->setPoints(newPoints);
 
 	this->updateShapes();
 }
 
+// the spline only gets computed again when the points change
+void EdgeGraphics::setPoints(const std::list<QPointF> & p)
+{
+	if (p == this->points) return;
+	this->points = p;
+	this->splineFlag = true;
+}
+
 /***********
 * getPoint *
 ************
@@ -219,9 +238,11 @@ QPainterPath EdgeGraphics::shape() const
 * With antialiasing, at depth zero,
 * paints the various shapes (line, source, target)
 * with the setting provided by the EdgeStyle 
+* When zoomed out, only the polyline through the connector points
+* gets painted, without antialiasing (with a thin pen, in overview)
 * [!] what about selection? change depth, width?
 * [!] shapes are NOT updated real time
-**************************************************/
+******************************************************************/
 void EdgeGraphics::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
 /*
@@ -236,7 +257,7 @@ void EdgeGraphics::paint(QPainter *painter, const QStyleOptionGraphicsItem *opti
 */
 	if (this->hidden) return;
 
-	painter->setRenderHint(QPainter::Antialiasing, true);
+	GraphGraphics::DetailLevel detail = GraphGraphics::GetDetailLevel(option, widget);
 
 	bool isSelected = false;
 	if (this->getVertexGraphics(true))
@@ -248,9 +269,17 @@ void EdgeGraphics::paint(QPainter *painter, const QStyleOptionGraphicsItem *opti
 		isSelected |= this->getVertexGraphics(false)->isSelected();
 	}
 
-//	this->setZValue(isSelected? 2: 0); // [!] ugly with decorations at the wrong place when selected
-	this->setZValue(0);
-	
+	if (detail <= outlineDetail)
+	{
+		painter->setRenderHint(QPainter::Antialiasing, false);
+		this->configurePainting( painter, linePart, isSelected );
+		if (detail == overviewDetail) { QPen p = painter->pen(); p.setWidth(0); painter->setPen(p); }
+		painter->drawPolyline( this->polyline );
+		return;
+	}
+
+	painter->setRenderHint(QPainter::Antialiasing, true);
+
 	this->configurePainting( painter, linePart, isSelected );
 	painter->drawPath( this->lineShape );
 
@@ -330,6 +359,8 @@ void EdgeGraphics::updateShapes(bool lineUpdate, bool sourceUpdate, bool targetU
 			path = getStraightPath(sourceShape, targetShape);			
 		}		
 		this->lineShape = path;
+		this->polyline.clear();
+		for (std::list<QPointF>::iterator it = this->points.begin(); it != this->points.end(); ++it) this->polyline << *it;
 	}
 
 	if (sourceUpdate)
@@ -461,95 +492,140 @@ QPointF EdgeGraphics::addDecorationOffset(QPointF p, EdgeDecoration deco, bool i
 	return p;
 }
 
-QPainterPath EdgeGraphics::getSplinePath(QGraphicsItem * sourceShape, QGraphicsItem * targetShape)
-{	
-	QPainterPath spline;
+/***************
+* updateSpline *
+****************
+* Computes the curve through the points, if they changed since last time
+* Same curve as a twine through the points (cf. libs/twines), in closed form:
+* the tangent at each inner point is half the vector between its neighbours,
+* inner segments are cubic (Catmull-Rom), end segments quadratic
+* All become cubic Bezier segments, that QPainterPath takes as they are
+****************************************************************************/
+void EdgeGraphics::updateSpline()
+{
+	if (!this->splineFlag) return;
+	this->splineFlag = false;
 
-	// Creating the spline
-	TW_TWINE xtwine;
-	TW_TWINE ytwine;
+	this->spline.clear();
+	std::vector<QPointF> p(this->points.begin(), this->points.end());
+	int n = p.size();
+	if (n < 3) return;
 
-	TW_InitialiseTwine(&xtwine, TW_TYPE_Limit);
-	TW_InitialiseTwine(&ytwine, TW_TYPE_Limit);
+	std::vector<QPointF> m(n); // tangents
+	for (int i = 1; i < n-1; ++i) m[i] = (p[i+1] - p[i-1]) / 2;
 
-	// Adding the control points
-	int i = 0;
-	for (std::list<QPointF>::iterator pi = this->points.begin(); pi != this->points.end(); ++pi) {
-		TW_AddControl(xtwine, i, (*pi).x());
-		TW_AddControl(ytwine, i, (*pi).y());	
-		++i;
+	this->spline.reserve(3*n - 2);
+	this->spline.push_back(p[0]);
+	for (int i = 0; i < n-1; ++i)
+	{
+		QPointF c1, c2;
+		if (i == 0 || i == n-2)
+		{
+			// quadratic, with q as its control point, raised to a cubic
+			QPointF q = (i == 0)? p[1] - m[1] / 2: p[n-2] + m[n-2] / 2;
+			c1 = p[i] + (q - p[i]) * 2 / 3;
+			c2 = p[i+1] + (q - p[i+1]) * 2 / 3;
+		}
+		else
+		{
+			c1 = p[i] + m[i] / 3;
+			c2 = p[i+1] - m[i+1] / 3;
+		}
+		this->spline.push_back(c1);
+		this->spline.push_back(c2);
+		this->spline.push_back(p[i+1]);
 	}
+}
 
-	// Computing the spline
-	QPointF src = this->points.front();
-	QPointF tar = this->points.back();
-
-	float d = sqrt((src.x()-tar.x())*(src.x()-tar.x()) + (src.y()-tar.y())*(src.y()-tar.y()));
-	float interval = (float) (this->points.size() - 1) / d;
-
-	spline.moveTo(src);
-
-	EdgeDecoration deco = this->style->getTargetDecoration();
+// the point at t (from 0 to 1) on a segment of the spline
+QPointF EdgeGraphics::getSplinePoint(int segment, float t) const
+{
+	const QPointF * p = &this->spline[3*segment];
+	float u = 1 - t;
+	return p[0]*(u*u*u) + p[1]*(3*u*u*t) + p[2]*(3*u*t*t) + p[3]*(t*t*t);
+}
 
-	TW_VALUE x, y;	
-	for (float f = interval; f<= this->points.size() - 1; f += interval)
+/****************
+* getSplineExit *
+*****************
+* Finds where the spline leaves the shape of the item at one of its ends
+* The segments are browsed from that end, up to the first one that gets out of the shape,
+* then the crossing is bisected on that segment (12 steps: 1/4096th of the segment)
+* Returns false if the spline never gets out of the shape
+* Otherwise, the segment and t give the first point found outside the shape
+*******************************************************************************************/
+bool EdgeGraphics::getSplineExit(QGraphicsItem * endItem, EdgeDecoration deco, bool isSource, int * segment, float * t)
+{
+	int last = this->spline.size() / 3 - 1;
+	for (int i = 0; i <= last; ++i)
 	{
-		TW_EvaluateTwine(&x, xtwine, f);
-		TW_EvaluateTwine(&y, ytwine, f);
+		int s = isSource? i: last - i;
+		float outside = isSource? 1: 0; // the end of the segment away from the item
+		if (this->isInShape(this->getSplinePoint(s, outside), endItem, deco)) continue;
 
-		QPointF p(x,y);
-		
-		if (deco != noDeco)
-			if ( isInShape( p, targetShape, this->style->getTargetDecoration()) ) break;
-		
-		spline.lineTo(p);
+		float inside = 1 - outside;
+		for (int j = 0; j < 12; ++j)
+		{
+			float middle = (inside + outside) / 2;
+			if (this->isInShape(this->getSplinePoint(s, middle), endItem, deco)) inside = middle;
+			else outside = middle;
+		}
+
+		*segment = s;
+		*t = outside;
+		return true;
 	}
-		
-	if (deco == noDeco) spline.lineTo(tar);
-	
-	return spline;	
+	return false;
 }
 
-QPointF EdgeGraphics::getDecorationPosOnSpline(QGraphicsItem * endItem, bool isSource, float * angle)
-{
-	// Creating the spline
-	TW_TWINE xtwine;
-	TW_TWINE ytwine;
+/****************
+* getSplinePath *
+*****************
+* The spline, as a path of cubic segments
+* With a target decoration, the path stops where the spline enters the target shape:
+* the segment it enters the shape on is cut there (de Casteljau)
+*************************************************************************************/
+QPainterPath EdgeGraphics::getSplinePath(QGraphicsItem * sourceShape, QGraphicsItem * targetShape)
+{	
+	QPainterPath spline;
 
-	TW_InitialiseTwine(&xtwine, TW_TYPE_Limit);
-	TW_InitialiseTwine(&ytwine, TW_TYPE_Limit);
+	this->updateSpline();
+	spline.moveTo(this->spline.front());
 
-	// Adding the control points
-	int i = 0;
-	for (std::list<QPointF>::iterator pi = this->points.begin(); pi != this->points.end(); ++pi)
-	{
-		TW_AddControl(xtwine, i, (*pi).x());
-		TW_AddControl(ytwine, i, (*pi).y());	
-		++i;
-	}
+	int last = this->spline.size() / 3 - 1;
+	float t = 1;
 
-	// Computing the spline intersection with the shape
-	QPointF src = this->points.front();
-	QPointF tar = this->points.back();	
+	EdgeDecoration deco = this->style->getTargetDecoration();
+	if (deco != noDeco)
+		if (!this->getSplineExit(targetShape, deco, false, &last, &t)) return spline;
 
-	QPointF pos = isSource? tar : src;
+	for (int i = 0; i < last; ++i) spline.cubicTo(this->spline[3*i+1], this->spline[3*i+2], this->spline[3*i+3]);
 
-	float d = sqrt((src.x()-tar.x())*(src.x()-tar.x()) + (src.y()-tar.y())*(src.y()-tar.y()));
-	float interval = (float) (this->points.size() - 1) / d;
+	const QPointF * p = &this->spline[3*last];
+	QPointF a = p[0] + (p[1] - p[0]) * t;
+	QPointF b = p[1] + (p[2] - p[1]) * t;
+	QPointF c = p[2] + (p[3] - p[2]) * t;
+	QPointF d = a + (b - a) * t;
+	QPointF e = b + (c - b) * t;
+	spline.cubicTo(a, d, d + (e - d) * t);
+
+	return spline;	
+}
+
+QPointF EdgeGraphics::getDecorationPosOnSpline(QGraphicsItem * endItem, bool isSource, float * angle)
+{
+	this->updateSpline();
 
 	EdgeDecoration deco = isSource? this->style->getSourceDecoration() : this->style->getTargetDecoration();
 
-	TW_VALUE x, y;	
-	for (float f = 0; f <= this->points.size() - 1; f += interval)
-	{
-		float g = isSource? f : this->points.size() - 1 - f;
-		TW_EvaluateTwine(&x, xtwine, g);
-		TW_EvaluateTwine(&y, ytwine, g);
+	// the spline intersection with the shape (or else, the other end)
+	QPointF pos = isSource? this->points.back() : this->points.front();
 
-		QPointF p(x,y);
-	
-		if ( !isInShape( p, endItem, deco, angle) ) { pos = p; break; }
-	}
+	int segment;
+	float t;
+	if (this->getSplineExit(endItem, deco, isSource, &segment, &t)) pos = this->getSplinePoint(segment, t);
+
+	this->isInShape(pos, endItem, deco, angle); // for the angle
 	
 	return pos;
 }
@@ -36,6 +36,12 @@
 // base class
 #include "graphgraphics.h"
 
+#include <QPolygonF>
+
+// STL
+#include <list>
+#include <vector>
+
 // local
 #include "edgestyle.h";
 
@@ -70,8 +76,10 @@ public:
 	void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = 0);
 
 	void updatePos();
+	void updateRoute();
 
 	void setHidden(bool h) { this->hidden = h; }
+	Connector * getConnector() { return this->connector; }
 
 	void quickTranslate();
 	void quickUpdate();
@@ -90,10 +98,20 @@ private:
 	QPainterPath lineShape;
 	QPainterPath sourceDecoration;
 	QPainterPath targetDecoration;	
+	QPolygonF polyline; // through the points, for the lower levels of detail
 	
 	QPointF source;
 	QPointF target;
 	std::list<QPointF> points;
+	void setPoints(const std::list<QPointF> & p);
+
+	// the curve through the points, as cubic Bezier segments (cf. updateSpline):
+	// segment i goes from spline[3i] to spline[3i+3], through control points spline[3i+1] and spline[3i+2]
+	std::vector<QPointF> spline;
+	bool splineFlag; // the points changed since the spline got computed
+	void updateSpline();
+	QPointF getSplinePoint(int segment, float t) const;
+	bool getSplineExit(QGraphicsItem * endItem, EdgeDecoration deco, bool isSource, int * segment, float * t);
 
 	QPointF getPoint(bool isSource) const;
 
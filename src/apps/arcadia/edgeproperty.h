@@ -37,21 +37,26 @@
 #include <string>
 #include <iostream>
 
+// The kind of edge, known upon construction (one integer to compare, rather than type labels)
+enum EdgeType { genericEdge, reactantEdge, productEdge, modifierEdge };
+
 /*****************
 * EdgeProperty *
 ******************
 * Generic properties for edges
 * Defines an interface for a stringVersion (for debugging output),
 * Also gives info on the edge type (for styling purposes)
+* The kind of edge (getType) is the one to test in loops: the label is for display
 **********************************************************************/
 class EdgeProperty
 {
 public:
-	EdgeProperty() { this->isOriented = true; } 
+	EdgeProperty() : type(genericEdge) { this->isOriented = true; } 
 	virtual ~EdgeProperty() { }
 
 	virtual std::string stringVersion();
 	virtual std::string getTypeLabel();
+	EdgeType getType() { return this->type; }
 	
 	virtual std::string getId() { return ""; }
 	
@@ -59,6 +64,9 @@ public:
 	virtual int inherits(int sbo) { return -1; } // [!] no meaning for non pathway vertex
 
 	bool isOriented;
+
+protected:
+	EdgeType type; // set by the constructors of the subclasses
 };
 
 #endif
\ No newline at end of file
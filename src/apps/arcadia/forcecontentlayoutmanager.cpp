@@ -0,0 +1,560 @@
+/***********************************************************************
+*
+*  Arcadia is a visualisation tool for metabolic pathways
+*
+*  This file is part of the arcadia1.0 application distribution
+*  Copyright (C) 2007-2009 Alice Villeger, University of Manchester
+*  <alice.villeger@manchester.ac.uk>
+*
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*************************************************************************/
+
+/*
+ *  ForceContentLayoutManager.cpp
+ *  arcadia
+ *
+ */
+
+#include "forcecontentlayoutmanager.h"
+
+// STL
+#include <math.h>
+#include <algorithm>
+#include <list>
+#include <map>
+#include <utility>
+
+// local
+#include "containercontent.h"
+#include "connector.h"
+
+// Strength of the repulsion, relative to the springs (cf. Hu 2005)
+static const float Repulsion = 0.2;
+// Pull towards the centre of the graph, so that unconnected parts stay together
+static const float Gravity = 0.2;
+// Barnes-Hut opening criterion: a cell that small, seen from that far, counts as a single node
+static const float Theta = 1.2;
+// Nodes per quadtree leaf
+static const int LeafSize = 8;
+// Coarsening stops at that many nodes, or when merging doesn't shrink the graph enough anymore
+static const unsigned int CoarsestSize = 20;
+static const float MinShrink = 0.9;
+// Number of iterations on the coarsest graph, then on each finer one
+static const int CoarsestIterations = 300;
+static const int RefineIterations = 40;
+// Room left between the rectangles of the children
+static const float Gap = 20;
+
+/*********
+* layout *
+**********
+* Builds the graph of the children (one node per child, as big as the child)
+* and coarsens it as much as possible
+* Lays out the coarsest graph from a pseudo-random spread (always the same one)
+* then every finer graph from the positions of the coarser one
+* Finally removes the overlaps and sets the new position of each child,
+* translated so that the core of the container doesn't appear to have moved
+* (cf. GraphvizContentLayoutManager::layout)
+*****************************************************************************/
+void ForceContentLayoutManager::layout(ContainerContent * container)
+{
+	ContentRange cList = container->getChildRange();
+	if (cList.empty()) return;
+
+	// the finest graph (the graphs vector grows below: always accessed by index)
+	std::vector<Graph> graphs(1);
+	std::map<Content*, int> index;
+	std::vector<float> halfWidth, halfHeight;
+	float radiusSum = 0;
+	for (ContentRange::iterator it = cList.begin(); it != cList.end(); ++it)
+	{
+		Content * c = (*it);
+		index[c] = graphs[0].size();
+
+		float w = c->width(true) / 2.0;
+		float h = c->height(true) / 2.0;
+		if (this->rotation) std::swap(w, h);
+		halfWidth.push_back(w);
+		halfHeight.push_back(h);
+
+		graphs[0].x.push_back(0);
+		graphs[0].y.push_back(0);
+		graphs[0].radius.push_back(sqrt(w * w + h * h));
+		graphs[0].mass.push_back(1);
+		radiusSum += graphs[0].radius.back();
+	}
+
+	ConnectorSetRange connectors = container->getInnerConnectorRange();
+	std::vector<Edge> edges;
+	for (ConnectorSetRange::iterator it = connectors.begin(); it != connectors.end(); ++it)
+	{
+		std::map<Content*, int>::iterator source = index.find((*it)->getSourceContent(container));
+		std::map<Content*, int>::iterator target = index.find((*it)->getTargetContent(container));
+		if ((source == index.end()) || (target == index.end()) || (source->second == target->second)) continue;
+
+		Edge e;
+		e.u = std::min(source->second, target->second);
+		e.v = std::max(source->second, target->second);
+		e.weight = 1;
+		edges.push_back(e);
+	}
+	setEdges(graphs[0], edges);
+
+	// natural length of the springs: a typical child, and some room around it
+	float k = 2 * radiusSum / graphs[0].size() + Gap;
+
+	while (graphs.back().size() > CoarsestSize)
+	{
+		Graph coarse;
+		if (!coarsen(graphs.back(), coarse)) break;
+		graphs.push_back(coarse);
+	}
+
+	Graph & coarsest = graphs.back();
+	float totalMass = 0;
+	for (unsigned int i = 0; i < coarsest.size(); ++i) totalMass += coarsest.mass[i];
+	float side = k * sqrt(totalMass);
+	unsigned int seed = 1;
+	for (unsigned int i = 0; i < coarsest.size(); ++i)
+	{
+		seed = seed * 1103515245 + 12345;	coarsest.x[i] = side * ((seed >> 16) & 0x7fff) / 32768.0;
+		seed = seed * 1103515245 + 12345;	coarsest.y[i] = side * ((seed >> 16) & 0x7fff) / 32768.0;
+	}
+	refine(coarsest, k, CoarsestIterations, k);
+
+	// the nodes of a finer graph start around the node they got merged into
+	for (int l = graphs.size() - 2; l >= 0; --l)
+	{
+		Graph & fine = graphs[l];
+		Graph & coarse = graphs[l+1];
+		for (unsigned int i = 0; i < fine.size(); ++i)
+		{
+			int p = fine.parent[i];
+			float angle = 2.4 * i; // golden angle: merged nodes end up on different sides
+			fine.x[i] = coarse.x[p] + cos(angle) * fine.radius[i] / 2;
+			fine.y[i] = coarse.y[p] + sin(angle) * fine.radius[i] / 2;
+		}
+		refine(fine, k, RefineIterations, k / 2);
+	}
+
+	Graph & g = graphs[0];
+	removeOverlaps(g.x, g.y, halfWidth, halfHeight, Gap);
+
+	// old and new coordinates of the core of the container (its centre if none)
+	float x0, y0, X0, Y0;
+	Content * core = container->getCore();
+	if (core && (index.find(core) != index.end()))
+	{
+		x0 = core->x(); y0 = core->y();
+		X0 = g.x[index[core]]; Y0 = g.y[index[core]];
+	}
+	else
+	{
+		x0 = container->x(); y0 = container->y();
+		float left = g.x[0], right = g.x[0], top = g.y[0], bottom = g.y[0];
+		for (unsigned int i = 1; i < g.size(); ++i)
+		{
+			left = std::min(left, g.x[i]);	right = std::max(right, g.x[i]);
+			top = std::min(top, g.y[i]);	bottom = std::max(bottom, g.y[i]);
+		}
+		X0 = (left + right) / 2; Y0 = (top + bottom) / 2;
+	}
+
+	// Translation + rotation if need be
+	for (std::map<Content*, int>::iterator it = index.begin(); it != index.end(); ++it)
+	{
+		float X = g.x[it->second] - X0;
+		float Y = g.y[it->second] - Y0;
+		if (this->rotation)	it->first->setPosition(x0 + Y, y0 + X);
+		else				it->first->setPosition(x0 + X, y0 + Y);
+	}
+}
+
+/***********
+* setEdges *
+************
+* Sets the adjacency of a graph from a list of edges (u < v)
+* Duplicate edges are merged into one, with the sum of their weights
+*********************************************************************/
+void ForceContentLayoutManager::setEdges(Graph & g, std::vector<Edge> & edges)
+{
+	std::sort(edges.begin(), edges.end());
+
+	std::vector<Edge> merged;
+	for (std::vector<Edge>::iterator it = edges.begin(); it != edges.end(); ++it)
+	{
+		if (!merged.empty() && (merged.back().u == it->u) && (merged.back().v == it->v)) merged.back().weight += it->weight;
+		else merged.push_back(*it);
+	}
+
+	g.first.assign(g.size() + 1, 0);
+	for (std::vector<Edge>::iterator it = merged.begin(); it != merged.end(); ++it) { g.first[it->u + 1]++; g.first[it->v + 1]++; }
+	for (unsigned int i = 0; i < g.size(); ++i) g.first[i + 1] += g.first[i];
+
+	std::vector<int> next(g.first.begin(), g.first.end() - 1);
+	g.adj.resize(2 * merged.size());
+	g.weight.resize(2 * merged.size());
+	for (std::vector<Edge>::iterator it = merged.begin(); it != merged.end(); ++it)
+	{
+		g.adj[next[it->u]] = it->v;	g.weight[next[it->u]++] = it->weight;
+		g.adj[next[it->v]] = it->u;	g.weight[next[it->v]++] = it->weight;
+	}
+}
+
+/**********
+* coarsen *
+***********
+* Merges the nodes of the fine graph two by two into the coarse graph
+* Nodes are visited by increasing degree, each merged with its free neighbour
+* of heaviest connection for the lightest merged node, or else with a free neighbour of a neighbour
+* (e.g. the many leaves around a hub), or else, for an isolated node, with another isolated node
+* Returns false (leaving the coarse graph empty) if the graph would not shrink enough
+*****************************************************************************************************/
+bool ForceContentLayoutManager::coarsen(Graph & fine, Graph & coarse)
+{
+	unsigned int n = fine.size();
+	fine.parent.assign(n, -1);
+
+	std::vector< std::pair<int, int> > order;
+	for (unsigned int u = 0; u < n; ++u) order.push_back(std::make_pair(fine.first[u + 1] - fine.first[u], u));
+	std::sort(order.begin(), order.end());
+
+	int count = 0;
+	int isolated = -1; // an isolated node still waiting for another one
+	for (unsigned int o = 0; o < n; ++o)
+	{
+		int u = order[o].second;
+		if (fine.parent[u] != -1) continue;
+
+		int best = -1;
+		float bestScore = 0;
+		for (int j = fine.first[u]; j < fine.first[u + 1]; ++j)
+		{
+			int v = fine.adj[j];
+			if (fine.parent[v] != -1) continue;
+			float score = fine.weight[j] / (fine.mass[u] + fine.mass[v]);
+			if (score > bestScore) { best = v; bestScore = score; }
+		}
+
+		int checks = 0;
+		for (int j = fine.first[u]; (best == -1) && (j < fine.first[u + 1]) && (checks < 64); ++j)
+		{
+			int v = fine.adj[j];
+			for (int jj = fine.first[v]; (jj < fine.first[v + 1]) && (checks < 64); ++jj, ++checks)
+			{
+				int t = fine.adj[jj];
+				if ((t == u) || (fine.parent[t] != -1)) continue;
+				float score = 1 / (fine.mass[u] + fine.mass[t]);
+				if (score > bestScore) { best = t; bestScore = score; }
+			}
+		}
+
+		if (fine.first[u] == fine.first[u + 1])
+		{
+			if (isolated == -1) { isolated = u; continue; }
+			best = isolated;
+			isolated = -1;
+		}
+
+		fine.parent[u] = count;
+		if (best != -1) fine.parent[best] = count;
+		++count;
+	}
+	if (isolated != -1) fine.parent[isolated] = count++;
+
+	if (count > MinShrink * n) return false;
+
+	coarse.x.assign(count, 0);
+	coarse.y.assign(count, 0);
+	coarse.radius.assign(count, 0);
+	coarse.mass.assign(count, 0);
+	for (unsigned int u = 0; u < n; ++u)
+	{
+		int p = fine.parent[u];
+		coarse.mass[p] += fine.mass[u];
+		coarse.radius[p] += fine.radius[u] * fine.radius[u];
+	}
+	for (int p = 0; p < count; ++p) coarse.radius[p] = sqrt(coarse.radius[p]);
+
+	std::vector<Edge> edges;
+	for (unsigned int u = 0; u < n; ++u)
+	{
+		for (int j = fine.first[u]; j < fine.first[u + 1]; ++j)
+		{
+			int v = fine.adj[j];
+			if ((int) u > v) continue;
+			int cu = fine.parent[u], cv = fine.parent[v];
+			if (cu == cv) continue;
+			Edge e;
+			e.u = std::min(cu, cv);
+			e.v = std::max(cu, cv);
+			e.weight = fine.weight[j];
+			edges.push_back(e);
+		}
+	}
+	setEdges(coarse, edges);
+
+	return true;
+}
+
+/*********
+* refine *
+**********
+* Force-directed layout of a graph, from its current positions (cf. Hu 2005)
+* Every node is attracted by its neighbours, as (d - r1 - r2)^2 / k,
+* and repelled by every other node, as Repulsion * k^2 * m1 * m2 / d
+* the far away ones being approximated by the quadtree cells they belong to
+* A weak pull towards the centre, as Gravity * m * d, keeps unconnected nodes from drifting away
+* Each node moves by the current step, in the direction of the force it gets
+* and the step adapts to the progress made (increased after 5 good iterations in a row,
+* up to its initial value)
+****************************************************************************************/
+void ForceContentLayoutManager::refine(Graph & g, float k, int iterations, float step)
+{
+	unsigned int n = g.size();
+	if (n < 2) return;
+
+	std::vector<Cell> cells;
+	std::vector<int> order;
+	std::vector<int> stack;
+	float c = Repulsion * k * k;
+	float energy0 = 0;
+	int progress = 0;
+	float maxStep = step;
+
+	for (int it = 0; (it < iterations) && (step > k / 100); ++it)
+	{
+		buildQuadtree(g, cells, order);
+		float cx = cells[0].x, cy = cells[0].y;
+
+		float energy = 0;
+		for (unsigned int i = 0; i < n; ++i)
+		{
+			float fx = 0, fy = 0;
+
+			stack.clear();
+			stack.push_back(0);
+			while (!stack.empty())
+			{
+				Cell & cell = cells[stack.back()];
+				stack.pop_back();
+				if (cell.begin == cell.end) continue;
+
+				if (cell.child == -1)
+				{
+					for (int o = cell.begin; o < cell.end; ++o)
+					{
+						int j = order[o];
+						if (j == (int) i) continue;
+						float dx = g.x[i] - g.x[j], dy = g.y[i] - g.y[j];
+						float d2 = dx * dx + dy * dy;
+						if (d2 < 0.01) { dx = ((int) i < j)? -0.1: 0.1; dy = 0; d2 = 0.01; }
+						float f = c * g.mass[i] * g.mass[j] / d2;
+						fx += dx * f; fy += dy * f;
+					}
+					continue;
+				}
+
+				float dx = g.x[i] - cell.x, dy = g.y[i] - cell.y;
+				float d2 = dx * dx + dy * dy;
+				bool inside = (g.x[i] >= cell.left) && (g.x[i] < cell.left + cell.size)
+					&& (g.y[i] >= cell.top) && (g.y[i] < cell.top + cell.size);
+				if (!inside && (cell.size * cell.size < Theta * Theta * d2))
+				{
+					float f = c * g.mass[i] * cell.mass / d2;
+					fx += dx * f; fy += dy * f;
+				}
+				else
+				{
+					for (int q = 0; q < 4; ++q) stack.push_back(cell.child + q);
+				}
+			}
+
+			for (int j = g.first[i]; j < g.first[i + 1]; ++j)
+			{
+				int v = g.adj[j];
+				float dx = g.x[v] - g.x[i], dy = g.y[v] - g.y[i];
+				float d = sqrt(dx * dx + dy * dy);
+				float s = d - g.radius[i] - g.radius[v];
+				if ((d <= 0) || (s <= 0)) continue;
+				float f = g.weight[j] * s * s / k / d;
+				fx += dx * f; fy += dy * f;
+			}
+
+			fx += Gravity * g.mass[i] * (cx - g.x[i]);
+			fy += Gravity * g.mass[i] * (cy - g.y[i]);
+
+			float norm = sqrt(fx * fx + fy * fy);
+			if (norm <= 0) continue;
+			g.x[i] += step * fx / norm;
+			g.y[i] += step * fy / norm;
+			energy += norm * norm;
+		}
+
+		if ((it == 0) || (energy < energy0))
+		{
+			if (++progress >= 5) { progress = 0; step = std::min(step / 0.9f, maxStep); }
+		}
+		else
+		{
+			progress = 0;
+			step *= 0.9;
+		}
+		energy0 = energy;
+	}
+}
+
+// Moves the nodes of order[begin] to order[end-1] whose coordinate is below mid first
+// and returns where the others start
+static int Split(std::vector<int> & order, int begin, int end, const std::vector<float> & coord, float mid)
+{
+	int i = begin, j = end - 1;
+	while (i <= j)
+	{
+		if (coord[order[i]] < mid) ++i;
+		else std::swap(order[i], order[j--]);
+	}
+	return i;
+}
+
+/****************
+* buildQuadtree *
+*****************
+* Builds the Barnes-Hut quadtree of the current positions:
+* the root cell is a square around every node, and a cell with more than LeafSize nodes
+* is split into four children (stored next to each other), down to a minimal size
+* Each cell knows the total mass of its nodes, and their centre of mass
+*****************************************************************************************/
+void ForceContentLayoutManager::buildQuadtree(Graph & g, std::vector<Cell> & cells, std::vector<int> & order)
+{
+	unsigned int n = g.size();
+	order.resize(n);
+	for (unsigned int i = 0; i < n; ++i) order[i] = i;
+
+	float left = g.x[0], right = g.x[0], top = g.y[0], bottom = g.y[0];
+	for (unsigned int i = 1; i < n; ++i)
+	{
+		left = std::min(left, g.x[i]);	right = std::max(right, g.x[i]);
+		top = std::min(top, g.y[i]);	bottom = std::max(bottom, g.y[i]);
+	}
+
+	cells.clear();
+	Cell root = { left, top, std::max(right - left, bottom - top) + 1, 0, 0, 0, -1, 0, (int) n };
+	cells.push_back(root);
+
+	for (unsigned int c = 0; c < cells.size(); ++c)
+	{
+		Cell cell = cells[c];
+
+		float mass = 0, x = 0, y = 0;
+		for (int o = cell.begin; o < cell.end; ++o)
+		{
+			int i = order[o];
+			mass += g.mass[i]; x += g.mass[i] * g.x[i]; y += g.mass[i] * g.y[i];
+		}
+		cells[c].mass = mass;
+		if (mass > 0) { cells[c].x = x / mass; cells[c].y = y / mass; }
+
+		if ((cell.end - cell.begin <= LeafSize) || (cell.size < 0.01)) continue;
+
+		float half = cell.size / 2;
+		int middle = Split(order, cell.begin, cell.end, g.y, cell.top + half);
+		int bounds[5] = { cell.begin, Split(order, cell.begin, middle, g.x, cell.left + half),
+			middle, Split(order, middle, cell.end, g.x, cell.left + half), cell.end };
+
+		cells[c].child = cells.size();
+		for (int q = 0; q < 4; ++q)
+		{
+			Cell child = { cell.left + (q % 2) * half, cell.top + (q / 2) * half, half, 0, 0, 0, -1, bounds[q], bounds[q + 1] };
+			cells.push_back(child);
+		}
+	}
+}
+
+// Key of the grid cell (cx, cy), as two unsigned 32 bit halves (negative cells included)
+static unsigned long long CellKey(int cx, int cy)
+{
+	return ((unsigned long long) (unsigned int) cx << 32) | (unsigned int) cy;
+}
+
+/*****************
+* removeOverlaps *
+******************
+* Pushes apart the rectangles (centre, half width, half height) that overlap,
+* leaving a gap between them, along the axis where they overlap the least
+* Rectangles are put in a grid, so only those in the same grid cell get compared
+* Stops when there is no overlap left, or after a number of passes
+**********************************************************************************/
+void ForceContentLayoutManager::removeOverlaps(std::vector<float> & x, std::vector<float> & y,
+	std::vector<float> & halfWidth, std::vector<float> & halfHeight, float gap)
+{
+	unsigned int n = x.size();
+	if (n < 2) return;
+
+	float cellSize = 0;
+	for (unsigned int i = 0; i < n; ++i) cellSize += 2 * std::max(halfWidth[i], halfHeight[i]) + gap;
+	cellSize /= n;
+
+	std::vector< std::pair<unsigned long long, int> > grid;
+	for (int pass = 0; pass < 50; ++pass)
+	{
+		grid.clear();
+		for (unsigned int i = 0; i < n; ++i)
+		{
+			int l = (int) floor((x[i] - halfWidth[i] - gap / 2) / cellSize);
+			int r = (int) floor((x[i] + halfWidth[i] + gap / 2) / cellSize);
+			int t = (int) floor((y[i] - halfHeight[i] - gap / 2) / cellSize);
+			int b = (int) floor((y[i] + halfHeight[i] + gap / 2) / cellSize);
+			for (int cx = l; cx <= r; ++cx)
+				for (int cy = t; cy <= b; ++cy) grid.push_back(std::make_pair(CellKey(cx, cy), (int) i));
+		}
+		std::sort(grid.begin(), grid.end());
+
+		bool moved = false;
+		for (unsigned int begin = 0, end = 0; begin < grid.size(); begin = end)
+		{
+			while ((end < grid.size()) && (grid[end].first == grid[begin].first)) ++end;
+
+			for (unsigned int a = begin; a < end; ++a)
+			{
+				for (unsigned int b = a + 1; b < end; ++b)
+				{
+					int i = grid[a].second, j = grid[b].second;
+					float ox = halfWidth[i] + halfWidth[j] + gap - fabs(x[i] - x[j]);
+					float oy = halfHeight[i] + halfHeight[j] + gap - fabs(y[i] - y[j]);
+					if ((ox <= 0) || (oy <= 0)) continue;
+
+					// each pair only once: in the grid cell of the top left corner of their intersection
+					int cx = (int) floor((std::max(x[i] - halfWidth[i], x[j] - halfWidth[j]) - gap / 2) / cellSize);
+					int cy = (int) floor((std::max(y[i] - halfHeight[i], y[j] - halfHeight[j]) - gap / 2) / cellSize);
+					if (CellKey(cx, cy) != grid[begin].first) continue;
+
+					if (ox < oy)
+					{
+						float d = (x[i] < x[j] || ((x[i] == x[j]) && (i < j)))? -ox / 2: ox / 2;
+						x[i] += d; x[j] -= d;
+					}
+					else
+					{
+						float d = (y[i] < y[j] || ((y[i] == y[j]) && (i < j)))? -oy / 2: oy / 2;
+						y[i] += d; y[j] -= d;
+					}
+					moved = true;
+				}
+			}
+		}
+		if (!moved) break;
+	}
+}
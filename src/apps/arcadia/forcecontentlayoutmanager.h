@@ -0,0 +1,87 @@
+/***********************************************************************
+*
+*  Arcadia is a visualisation tool for metabolic pathways
+*
+*  This file is part of the arcadia1.0 application distribution
+*  Copyright (C) 2007-2009 Alice Villeger, University of Manchester
+*  <alice.villeger@manchester.ac.uk>
+*
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*************************************************************************/
+
+/*
+ *  ForceContentLayoutManager.h
+ *  arcadia
+ *
+ */
+
+#ifndef FORCECONTENTLAYOUTMANAGER_H
+#define FORCECONTENTLAYOUTMANAGER_H
+
+// local base class
+#include "contentlayoutmanager.h"
+
+// STL
+#include <vector>
+
+/****************************
+* ForceContentLayoutManager *
+*****************************
+* This subclass of ContentLayoutManager lays out the content
+* with a multilevel force-directed method (cf. Walshaw 2003, Hu 2005)
+*
+* The children of the container are the nodes of a graph,
+* linked by the inner connectors of the container
+* That graph gets coarsened again and again (neighbours merged two by two)
+* down to a handful of nodes, which get laid out first
+* Then each finer graph starts from the layout of the coarser one, and gets refined:
+* nodes attract their neighbours and repel all the others (spring-electrical model)
+* Repulsion is approximated with a Barnes-Hut quadtree, in O(n log n) per iteration
+* Finally, the rectangles of the children are pushed apart where they still overlap
+*
+* As with graphviz, children are laid out with their width and height swapped
+* when rotated, and the core of the container (its centre, if none) does not move
+* Meant for large containers, that graphviz can't deal with in a reasonable time
+*************************************************************************************/
+class ForceContentLayoutManager : public ContentLayoutManager {
+public:
+	void layout(ContainerContent * container);
+
+protected:
+	// A graph of (merged) children, with the total weight of the connectors between them
+	struct Graph
+	{
+		std::vector<float> x, y, radius, mass;
+		std::vector<int> parent; // node of the coarser graph it got merged into
+		std::vector<int> first; // the neighbours of node i are adj[first[i]] to adj[first[i+1]-1]
+		std::vector<int> adj;
+		std::vector<float> weight;
+
+		unsigned int size() const { return this->x.size(); }
+	};
+	struct Edge { int u, v; float weight; bool operator<(const Edge & e) const { return (u < e.u) || ((u == e.u) && (v < e.v)); } };
+
+	// A Barnes-Hut quadtree cell, over the nodes in order[begin] to order[end-1]
+	struct Cell { float left, top, size, x, y, mass; int child, begin, end; };
+
+	static void setEdges(Graph & g, std::vector<Edge> & edges);
+	static bool coarsen(Graph & fine, Graph & coarse);
+	static void refine(Graph & g, float k, int iterations, float step);
+	static void buildQuadtree(Graph & g, std::vector<Cell> & cells, std::vector<int> & order);
+	static void removeOverlaps(std::vector<float> & x, std::vector<float> & y,
+		std::vector<float> & halfWidth, std::vector<float> & halfHeight, float gap);
+};
+
+#endif
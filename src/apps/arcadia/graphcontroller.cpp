@@ -370,6 +370,17 @@ void GraphController::toggleAvoidingEdges()
 	this->busy = false;
 }
 
+void GraphController::toggleOrthogonalEdges()
+{
+	if (this->busy) return;
+	if (!this->_graphModel) return;
+
+	this->busy = true;
+	this->_graphModel->toggleOrthogonalEdges();
+	this->selfUpdateLayout(NULL, true, false);
+	this->busy = false;
+}
+
 void GraphController::destroyLayout()
 {
 	if (this->busy) return;
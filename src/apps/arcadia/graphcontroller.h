@@ -88,6 +88,7 @@ public:
 	virtual void toggleModifiersCloning() {} //[!] shouldn't be defined here!
 	virtual void toggleReactionsFusing() {} //[!] shouldn't be defined here!
 	void toggleAvoidingEdges();
+	void toggleOrthogonalEdges();
 	void destroyLayout();
 	void arrangeSelection();
 	void newLayout();
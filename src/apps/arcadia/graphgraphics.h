@@ -35,13 +35,37 @@
 
 // Qt base class
 #include <QGraphicsItem>
+#include <QStyleOptionGraphicsItem>
 
+/****************
+* GraphGraphics *
+*****************
+* The base class of the items of a LayoutGraphView
+*
+* On screen, items get painted with less and less detail as the view zooms out:
+* labels go first, then antialiasing and edge decorations, then borders
+* (edges become single polylines, compartments filled rectangles)
+* Off screen (print, export), QGraphicsScene::render paints without a widget:
+* items always get the full detail there
+*********************************************************************************/
 class GraphGraphics: public QGraphicsItem
 {
 public:
 	virtual bool isEdge() { return false; }
 	virtual bool isVertex() { return false; }
 	virtual bool isContainer() { return false; }
+
+	enum DetailLevel { overviewDetail, outlineDetail, shapeDetail, fullDetail };
+
+	static DetailLevel GetDetailLevel(const QStyleOptionGraphicsItem * option, QWidget * widget)
+	{
+		if (!widget) return fullDetail; // off screen rendering
+		qreal zoom = option->levelOfDetail;
+		if (zoom < 1./8) return overviewDetail;
+		if (zoom < 1./4) return outlineDetail;
+		if (zoom < 1./2) return shapeDetail;
+		return fullDetail;
+	}
 };
 
 #endif
\ No newline at end of file
@@ -33,11 +33,13 @@
 #include "graphlayout.h"
 
 #include <iostream>
+#include <set>
 
 // local
 #include "clonecontent.h"
 #include "connector.h"
 #include "connectorlayoutmanager.h"
+#include "graphsnapshot.h"
 #include "vertexproperty.h"
 #include <pathways/pathwayvertexproperty.h> // [!]
 
@@ -48,10 +50,10 @@
 * [!] can't chose the layout type!                                       *
 *************************************************************************/
 GraphLayout::GraphLayout(GraphModel * gm, std::string n) : graphModel(gm), visible(false),
-	avoiding(false), name(n)
+	avoiding(false), orthogonal(false), name(n), pool(gm->getLayoutSpares())
 {
-	this->root = new ContainerContent(this);
 	this->connectorLayoutManager = new ConnectorLayoutManager(this);
+	this->root = new (this) ContainerContent(this);
 	this->layoutStyleSheet = this->graphModel->getStyleSheet();
 }
 
@@ -72,6 +74,10 @@ GraphLayout::~GraphLayout() { delete this->root; delete this->connectorLayoutMan
 void GraphLayout::map(BGL_Vertex v, CloneContent * cd)
 {
 	this->cloneMap[v].push_back(cd);
+	this->cloneMoved(cd); // new clones have no orientation yet
+
+	QMutexLocker locker(&this->movedMutex);
+	this->changes.remappedVertices.insert(v);
 }
 
 /*****************************************************************
@@ -79,8 +85,9 @@ void GraphLayout::map(BGL_Vertex v, CloneContent * cd)
 *****************************************************************/
 CloneContent * GraphLayout::getClone(BGL_Vertex v)
 {
-	if (this->cloneMap[v].empty()) return NULL;
-	else return this->cloneMap[v].front();
+	std::map< BGL_Vertex, std::list<CloneContent*> >::iterator it = this->cloneMap.find(v);
+	if (it == this->cloneMap.end() || it->second.empty()) return NULL;
+	else return it->second.front();
 }
 
 /******************************************************
@@ -88,6 +95,21 @@ CloneContent * GraphLayout::getClone(BGL_Vertex v)
 ******************************************************/
 std::list<CloneContent *> GraphLayout::getClones(BGL_Vertex v) { return this->cloneMap[v]; }
 
+/****************
+* getCloneRange *
+*****************
+* Same as getClones, but browses the list in place
+* (no entry gets added to the map for a vertex without clones)
+***************************************************************/
+CloneRange GraphLayout::getCloneRange(BGL_Vertex v)
+{
+	static const std::list<CloneContent*> NoClone;
+
+	std::map< BGL_Vertex, std::list<CloneContent*> >::iterator it = this->cloneMap.find(v);
+	if (it == this->cloneMap.end()) return CloneRange(NoClone);
+	else return CloneRange(it->second);
+}
+
 /***********************************************************************************
 * Root Container management                                                        *
 ***********************************************************************************/
@@ -99,145 +121,291 @@ ContainerContent * GraphLayout::getRoot() { return this->root; }
 
 /****************************************************
 * update: Layouts the content of the Root Container *
-****************************************************/
-void GraphLayout::update(bool edgesOnly, bool fast)
+*****************************************************
+* Only the containers that changed since the last update get laid out again,
+* along with their ancestors (cf. ContainerContent::setLayoutFlag)
+* unless the update is forced: then every container is (the user asked for it,
+* and manual moves don't flag anything)
+* Likewise, only the reactions next to a clone that moved get oriented again:
+* the ones that actually flipped need a new style (cf. takeChanges)
+**********************************************************************************/
+void GraphLayout::update(bool edgesOnly, bool fast, bool force)
 {
 	if (!edgesOnly && !fast)
 	{
-		this->getRoot()->layoutContent(); // calls graphviz to compute the whole node layout
+		if (force) this->getRoot()->setOffspringLayoutFlag();
+		this->getRoot()->layoutContent(); // calls graphviz to compute the node layout of whatever changed
 	}
 
 	// fix the orientation of reactions then computes the path of edges to avoid nodes
 	if (!fast)
 	{
 		// [!] First I need to update the orientation of reactions (pathway only!!)
-		BGL_Vertex r;
-		////////////////////////////////////////
-		// we look up every node in the model //
-		////////////////////////////////////////
-		std::list<BGL_Vertex> vList = this->graphModel->getVertices();	
-		for (std::list<BGL_Vertex>::iterator vit = vList.begin(); vit != vList.end(); ++vit)
+		// only the reactions next to a clone that moved since the last update can turn
+		std::set<CloneContent *> reactions;
 		{
-			// for every reaction...
-			if (this->graphModel->getProperties(*vit)->getTypeLabel(true) != "Reaction")
-				continue;
-			r = (*vit); 
-			CloneContent * rClone = this->getClone(r); // has always only one clone
-			// actually, sometimes, no clone at all! (partial view)
-			if (!rClone) continue;
-			
-			//////////////////////////////////////////////////////////////////////////////////
-			// we compute the global position of reactants and products around the reaction
-			float x = 0;
-			float y = 0;
-			// by adding up the reactionToReactant and productToReaction vectors
-			// we can see an overall emerging orientation
-			// if x is bigger than y, the reaction is horizontal, if not, vertical
-			// with this system, the orientation of the reaction gets updated automatically
-			// as reactants and products move around it                                    
-			//////////////////////////////////////////////////////////////////////////////////
-	
-			// first we have a look at all the edges around the reaction
-			std::list<BGL_Edge> edges = this->graphModel->getEdges(r);
-			for (std::list<BGL_Edge>::iterator eit = edges.begin(); eit != edges.end(); ++eit)
+			QMutexLocker locker(&this->movedMutex);
+			for (std::set<CloneContent *>::iterator it = this->movedClones.begin(); it != this->movedClones.end(); ++it)
 			{
-				BGL_Edge e = (*eit);
-				int factor = 0;
-
-				// we only care about reactants and products
-				std::string type = this->graphModel->getProperties(e)->getTypeLabel();
-				if (type == "Reactant") factor = -1;
-				else if (type == "Product") factor = 1;
-				else // we ignore modifiers at the moment
-				{
-					continue;
-				}
-
-				BGL_Vertex s;
-				if (factor < 0)	s = this->graphModel->getSource(e);
-				else 			s = this->graphModel->getTarget(e);
-				// now back at the layout level!
-				CloneContent * sClone = NULL;
-				if (factor < 0) sClone = this->getConnector(s, r, e)->getSource();
-				else			sClone = this->getConnector(r, s, e)->getTarget();
-				
-				x += factor*(sClone->x() - rClone->x());
-				y += factor*(sClone->y() - rClone->y());
-			} // for every reactant and product
-
-			bool rotated = (x*x > y*y)? true: false;
-			bool inverted = rotated? (x < 0) : (y < 0) ;
-
-			rClone->rotated = rotated;
-			rClone->inverted = inverted;
-
-			// now to deal with modifiers => they must point at the correct side of the reaction
-			for (std::list<BGL_Edge>::iterator eit = edges.begin(); eit != edges.end(); ++eit)
-			{
-				BGL_Edge e = (*eit);
-				std::string type = this->graphModel->getProperties(e)->getTypeLabel();
+				CloneContent * c = *it;
+				if (this->graphModel->getProperties(c->getVertex())->getType() == reactionVertex) reactions.insert(c);
 
-				if (type != "Modifier") continue;
-
-				BGL_Vertex s = this->graphModel->getSource(e);
-				CloneContent * sClone;
-				Connector * c = this->getConnector(s, r, e);
-				sClone = c->getSource();
-				
-				if (rClone->rotated)
-				{
-					if (rClone->inverted)
-					{
-						if (sClone->y() >= rClone->y()) c->setTargetConnection(side1);
-						else c->setTargetConnection(side2);
-					}
-					else
-					{
-						if (sClone->y() <= rClone->y()) c->setTargetConnection(side1);
-						else c->setTargetConnection(side2);
-					}
-				}
-				else
+				std::list<Connector *> connectors = c->getOutterConnectors();
+				for (std::list<Connector *>::iterator ic = connectors.begin(); ic != connectors.end(); ++ic)
 				{
-					if (rClone->inverted)
-					{
-						if (sClone->x() >= rClone->x()) c->setTargetConnection(side1);
-						else c->setTargetConnection(side2);
-					}
-					else
-					{
-						if (sClone->x() <= rClone->x()) c->setTargetConnection(side1);
-						else c->setTargetConnection(side2);
-					}				
+					CloneContent * n = (*ic)->getNeighbour(c);
+					if (n && (this->graphModel->getProperties(n->getVertex())->getType() == reactionVertex)) reactions.insert(n);
 				}
-			} // for every modifier
+			}
+			this->movedClones.clear();
+		}
 
-		} // for every reaction	
+		const GraphSnapshot & graph = this->graphModel->getSnapshot(); // the model doesn't change in here
+		for (std::set<CloneContent *>::iterator it = reactions.begin(); it != reactions.end(); ++it)
+		{
+			if (this->orientReaction(*it, graph)) this->cloneRestyled(*it);
+		}
 
 		// now we update the path of edges
 		this->connectorLayoutManager->layout();
 	}
 
 	// to do a quick update, we translate the connectors that were selected and moved, and update the others?
-	if (fast)
-	{
+	if (fast) this->quickUpdate();
+}
+
+/**************
+* quickUpdate *
+***************
+* While clones get dragged around: the connectors around them go straight
+* (inList: both ends moved, outList: only one end moved)
+* Also called directly by the view, once per frame of the drag
+****************************************************************************/
+void GraphLayout::quickUpdate()
+{
+	// routes of a previous update would undo the quick moves below
+	this->connectorLayoutManager->cancel();
+
 // do something with this->inList and this->outList, similar to the quicktranslate and quickupdate of edgegraphics	
-		for (std::list<Connector *>::iterator it = this->inList.begin(); it != this->inList.end(); ++it)
+	for (std::list<Connector *>::iterator it = this->inList.begin(); it != this->inList.end(); ++it)
+	{
+		(*it)->quickTranslate();
+	}
+	for (std::list<Connector *>::iterator it = this->outList.begin(); it != this->outList.end(); ++it)
+	{
+		(*it)->quickUpdate();
+	}
+// actually, it may be useless to distinguish in and out connectors at that level (it's only important for the updateshape part of edgegraphics)
+}
+
+/*****************
+* orientReaction *
+******************
+* Given the clone of a reaction (reactions are never cloned),
+* sets its orientation from the position of its reactants and products
+* then points its modifiers at the correct side of the reaction
+* Returns true if the reaction changed orientation
+*************************************************************************/
+bool GraphLayout::orientReaction(CloneContent * rClone, const GraphSnapshot & graph)
+{
+	BGL_Vertex r = rClone->getVertex();
+
+	//////////////////////////////////////////////////////////////////////////////////
+	// we compute the global position of reactants and products around the reaction
+	float x = 0;
+	float y = 0;
+	// by adding up the reactionToReactant and productToReaction vectors
+	// we can see an overall emerging orientation
+	// if x is bigger than y, the reaction is horizontal, if not, vertical
+	// with this system, the orientation of the reaction gets updated automatically
+	// as reactants and products move around it                                    
+	//////////////////////////////////////////////////////////////////////////////////
+	
+	// first we have a look at all the edges around the reaction
+	GraphRange<BGL_Edge> edges = graph.getEdges(r);
+	for (GraphRange<BGL_Edge>::iterator eit = edges.begin(); eit != edges.end(); ++eit)
+	{
+		BGL_Edge e = (*eit);
+		int factor = 0;
+
+		// we only care about reactants and products
+		EdgeType type = this->graphModel->getProperties(e)->getType();
+		if (type == reactantEdge) factor = -1;
+		else if (type == productEdge) factor = 1;
+		else // we ignore modifiers at the moment
 		{
-			(*it)->quickTranslate();
+			continue;
 		}
-		for (std::list<Connector *>::iterator it = this->outList.begin(); it != this->outList.end(); ++it)
+
+		BGL_Vertex s;
+		if (factor < 0)	s = this->graphModel->getSource(e);
+		else 			s = this->graphModel->getTarget(e);
+		// now back at the layout level!
+		CloneContent * sClone = NULL;
+		if (factor < 0) sClone = this->getConnector(s, r, e)->getSource();
+		else			sClone = this->getConnector(r, s, e)->getTarget();
+		
+		x += factor*(sClone->x() - rClone->x());
+		y += factor*(sClone->y() - rClone->y());
+	} // for every reactant and product
+
+	bool rotated = (x*x > y*y)? true: false;
+	bool inverted = rotated? (x < 0) : (y < 0) ;
+
+	bool flipped = (rClone->rotated != rotated) || (rClone->inverted != inverted);
+	rClone->setOrientation(rotated, inverted);
+
+	// now to deal with modifiers => they must point at the correct side of the reaction
+	for (GraphRange<BGL_Edge>::iterator eit = edges.begin(); eit != edges.end(); ++eit)
+	{
+		BGL_Edge e = (*eit);
+		if (this->graphModel->getProperties(e)->getType() != modifierEdge) continue;
+
+		BGL_Vertex s = this->graphModel->getSource(e);
+		CloneContent * sClone;
+		Connector * c = this->getConnector(s, r, e);
+		sClone = c->getSource();
+		
+		if (rClone->rotated)
 		{
-			(*it)->quickUpdate();
+			if (rClone->inverted)
+			{
+				if (sClone->y() >= rClone->y()) c->setTargetConnection(side1);
+				else c->setTargetConnection(side2);
+			}
+			else
+			{
+				if (sClone->y() <= rClone->y()) c->setTargetConnection(side1);
+				else c->setTargetConnection(side2);
+			}
 		}
-// actually, it may be useless to distinguish in and out connectors at that level (it's only important for the updateshape part of edgegraphics)
-	}
+		else
+		{
+			if (rClone->inverted)
+			{
+				if (sClone->x() >= rClone->x()) c->setTargetConnection(side1);
+				else c->setTargetConnection(side2);
+			}
+			else
+			{
+				if (sClone->x() <= rClone->x()) c->setTargetConnection(side1);
+				else c->setTargetConnection(side2);
+			}				
+		}
+	} // for every modifier
+
+	return flipped;
+}
+
+/*************
+* cloneMoved *
+**************
+* Called by the clones when their position changes, possibly from a layout thread
+* The reactions around them get oriented again at the next update
+***********************************************************************************/
+void GraphLayout::cloneMoved(CloneContent * cd)
+{
+	QMutexLocker locker(&this->movedMutex);
+	this->movedClones.insert(cd);
+	this->changes.movedClones.insert(cd);
+}
+
+/****************
+* cloneRestyled *
+*****************
+* The clone looks different: a reaction that flipped,
+* or a clone that changed container (cf. CloneContent::setContainer)
+*********************************************************************/
+void GraphLayout::cloneRestyled(CloneContent * cd)
+{
+	QMutexLocker locker(&this->movedMutex);
+	this->changes.restyledClones.insert(cd);
 }
 
 /* // [!] from the old ModelGraphView... we also must layout the edges and resize the scene!
 	this->resizeScene();
 */		
 
+/***********************************************************************************
+* Changes                                                                          *
+***********************************************************************************/
+
+/*******
+* swap *
+********/
+void LayoutChanges::swap(LayoutChanges & changes)
+{
+	this->movedClones.swap(changes.movedClones);
+	this->restyledClones.swap(changes.restyledClones);
+	this->remappedVertices.swap(changes.remappedVertices);
+	this->addedConnectors.swap(changes.addedConnectors);
+	this->changedConnectors.swap(changes.changedConnectors);
+	this->removedConnectors.swap(changes.removedConnectors);
+	this->addedContainers.swap(changes.addedContainers);
+	this->changedContainers.swap(changes.changedContainers);
+	this->removedContainers.swap(changes.removedContainers);
+}
+
+/**************
+* takeChanges *
+***************
+* Hands over what changed since the last call (the given changes are expected empty)
+* and starts gathering afresh
+*************************************************************************************/
+void GraphLayout::takeChanges(LayoutChanges & changes)
+{
+	QMutexLocker locker(&this->movedMutex);
+	LayoutChanges none;
+	this->changes.swap(changes);
+	this->changes.swap(none);
+}
+
+/**********************************************************************
+* connectorAdded, connectorChanged, connectorRemoved                  *
+* containerAdded, containerChanged, containerRemoved                  *
+* called by the objects themselves (cf. Connector, ContainerContent)  *
+* A removed object is forgotten, as its memory may get reused         *
+**********************************************************************/
+void GraphLayout::connectorAdded(Connector * c)
+{
+	QMutexLocker locker(&this->movedMutex);
+	this->changes.addedConnectors.insert(c);
+}
+
+void GraphLayout::connectorChanged(Connector * c)
+{
+	QMutexLocker locker(&this->movedMutex);
+	this->changes.changedConnectors.insert(c);
+}
+
+void GraphLayout::connectorRemoved(Connector * c)
+{
+	QMutexLocker locker(&this->movedMutex);
+	this->changes.addedConnectors.erase(c);
+	this->changes.changedConnectors.erase(c);
+	this->changes.removedConnectors.insert(c);
+}
+
+void GraphLayout::containerAdded(ContainerContent * c)
+{
+	QMutexLocker locker(&this->movedMutex);
+	this->changes.addedContainers.insert(c);
+}
+
+void GraphLayout::containerChanged(ContainerContent * c)
+{
+	QMutexLocker locker(&this->movedMutex);
+	this->changes.changedContainers.insert(c);
+}
+
+void GraphLayout::containerRemoved(ContainerContent * c)
+{
+	QMutexLocker locker(&this->movedMutex);
+	this->changes.addedContainers.erase(c);
+	this->changes.changedContainers.erase(c);
+	this->changes.removedContainers.insert(c);
+}
+
 /***********************************************************************************
 * Connector management                                                             *
 ***********************************************************************************/
@@ -266,13 +434,13 @@ Connector * GraphLayout::connectClones(CloneContent * uc, CloneContent * vc, BGL
 {	
 	if (!this->graphModel->isEdge(uc->getVertex(), vc->getVertex())) return NULL;
 
-	Connector * c =  new Connector (uc, vc, e);
+	Connector * c =  new (this) Connector(uc, vc, e);
 	this->connectorList.push_back(c);
 
 	// [!] to display adequate SBGN reactions in views created on the fly
-	if (this->graphModel->getProperties(e)->getTypeLabel() == "Reactant") c->setTargetConnection(in);
-	if (this->graphModel->getProperties(e)->getTypeLabel() == "Product")  c->setSourceConnection(out);		
-	if (this->graphModel->getProperties(e)->getTypeLabel() == "Modifier") c->setTargetConnection(side1);
+	if (this->graphModel->getProperties(e)->getType() == reactantEdge) c->setTargetConnection(in);
+	if (this->graphModel->getProperties(e)->getType() == productEdge)  c->setSourceConnection(out);		
+	if (this->graphModel->getProperties(e)->getType() == modifierEdge) c->setTargetConnection(side1);
 	// [!] pbm: this should be in pathways, not arcadia
 
 	return c;
@@ -281,27 +449,65 @@ Connector * GraphLayout::connectClones(CloneContent * uc, CloneContent * vc, BGL
 /***************
 * getConnector *
 ****************
-* Given a pair of BGL_Vertex,
-* browses the list of connectors to find the one connecting them
-* [!] that looks terribly inefficient. Better indexing?
-****************************************************************/
+* Given a pair of BGL_Vertex and the edge between them,
+* looks up the connector of the edge in the index
+* and checks it connects clones of these two vertices
+*****************************************************/
 Connector * GraphLayout::getConnector(BGL_Vertex u, BGL_Vertex v, BGL_Edge e)
 {
-	Connector * c = NULL;
-	for (std::list<Connector*>::iterator it = this->connectorList.begin(); it != this->connectorList.end(); ++it)
-	{
-		c = (*it);
-		
-		c->getSource()->getVertex();
-		c->getTarget()->getVertex();
-		
-		if (c->getSource()->getVertex() == u) if (c->getTarget()->getVertex() == v) if (c->getEdge() == e) break;
-
-		c = NULL;
-	}
+	Connector * c = this->edgeToConnector.value(e.get_property(), NULL);
+	if (!c) return NULL;
+	if (c->getSource()->getVertex() != u) return NULL;
+	if (c->getTarget()->getVertex() != v) return NULL;
 	return c;
 }
 
+/***************
+* getConnector *
+****************
+* Given a source clone and a target clone,
+* returns the connector between them, or NULL
+*********************************************/
+Connector * GraphLayout::getConnector(CloneContent * u, CloneContent * v)
+{
+	return this->clonesToConnector.value(qMakePair(u, v), NULL);
+}
+
+/*****************
+* indexConnector *
+******************
+* Once both ends of a connector are set, records it
+* under its edge and under its pair of clones
+* [!] a BGL_Edge is supposed to have a single connector: the first one is kept
+**********************************************************************************/
+void GraphLayout::indexConnector(Connector * c)
+{
+	if (!c->getSource() || !c->getTarget()) return;
+
+	void * key = c->getEdge().get_property();
+	if (!this->edgeToConnector.contains(key)) this->edgeToConnector.insert(key, c);
+
+	QPair<CloneContent *, CloneContent *> clones = qMakePair(c->getSource(), c->getTarget());
+	if (!this->clonesToConnector.contains(clones)) this->clonesToConnector.insert(clones, c);
+}
+
+/*******************
+* unindexConnector *
+********************
+* Before one end of a connector changes (or the connector dies),
+* forgets it under its edge and under its current pair of clones
+*****************************************************************/
+void GraphLayout::unindexConnector(Connector * c)
+{
+	if (!c->getSource() || !c->getTarget()) return;
+
+	void * key = c->getEdge().get_property();
+	if (this->edgeToConnector.value(key, NULL) == c) this->edgeToConnector.remove(key);
+
+	QPair<CloneContent *, CloneContent *> clones = qMakePair(c->getSource(), c->getTarget());
+	if (this->clonesToConnector.value(clones, NULL) == c) this->clonesToConnector.remove(clones);
+}
+
 /**********************
 * getCloneContents *
 ***********************
@@ -313,7 +519,7 @@ std::list< CloneContent * > GraphLayout::getCloneContents()
 	std::list< CloneContent *> cList;
 	for (std::map< BGL_Vertex, std::list<CloneContent*> >::iterator it = cloneMap.begin(); it != cloneMap.end(); ++it)
 	{
-		std::list<CloneContent*> v = (*it).second;
+		std::list<CloneContent*> & v = (*it).second;
 		for (std::list<CloneContent *>::iterator ic = v.begin(); ic != v.end(); ++ic)
 		{
 			cList.push_back(*ic);
@@ -338,6 +544,16 @@ std::list< Connector * > GraphLayout::getConnectors() { return this->connectorLi
 void GraphLayout::unmap(CloneContent * cd)
 {
 	this->cloneMap[cd->getVertex()].remove(cd);
+	{
+		QMutexLocker locker(&this->movedMutex);
+		this->movedClones.erase(cd);
+		this->changes.movedClones.erase(cd);
+		this->changes.restyledClones.erase(cd);
+		this->changes.remappedVertices.insert(cd->getVertex());
+	}
+
+	// routes still on their way may refer to the connectors of that clone
+	this->connectorLayoutManager->cancel();
 }
 
 /****************
@@ -443,18 +659,11 @@ void GraphLayout::branch(CloneContent * c, ContainerContent * parent, ContainerC
 		// a common ancestor (triangle up) or a common child (triangle down)
 		bool found = false;
 		std::list<Connector*> edges1 = r1->getOutterConnectors();
-		std::list<Connector*> edges2 = r2->getOutterConnectors();
 		for (std::list<Connector*>::iterator e1 = edges1.begin(); e1 != edges1.end(); ++e1)
 		{
-			bool isSource = ((*e1)->getSource() == r1);
-			bool isTarget = ((*e1)->getTarget() == r1);
-			for (std::list<Connector*>::iterator e2 = edges2.begin(); e2 != edges2.end(); ++e2)
-			{
-				if (isSource && ((*e2)->getSource() == r2))
-					if ((*e1)->getTarget() == (*e2)->getTarget()) { found = true; break; }
-				if (isTarget && ((*e2)->getTarget() == r2))
-					if ((*e1)->getSource() == (*e2)->getSource()) { found = true; break; }
-			}
+			// is the other end of that connector also connected to r2, in the same direction?
+			if (((*e1)->getSource() == r1) && this->getConnector(r2, (*e1)->getTarget())) { found = true; break; }
+			if (((*e1)->getTarget() == r1) && this->getConnector((*e1)->getSource(), r2)) { found = true; break; }
 		}
 		if (!found) { /* std::cerr << "no common child or ancestor for triangle" << std::endl; */ return; }
 		
@@ -476,7 +685,7 @@ void GraphLayout::branch(CloneContent * c, ContainerContent * parent, ContainerC
 		}
 		
 		// Then we can create the new container
-		branchContainer = new ContainerContent(this, parent);
+		branchContainer = new (this) ContainerContent(this, parent);
 		branchContainer->setContentLayoutStrategy(Triangle);
 		
 		// the middle node of the triangle is the core!
@@ -505,7 +714,7 @@ void GraphLayout::branch(CloneContent * c, ContainerContent * parent, ContainerC
 		if (rParent->getContentLayoutStrategy() == Branch) branchContainer = rParent;
 		else
 		{
-			branchContainer = new ContainerContent(this, parent);
+			branchContainer = new (this) ContainerContent(this, parent);
 			branchContainer->setContentLayoutStrategy(Branch);
 			branchContainer->add(r1, true);
 		}		
@@ -591,7 +800,7 @@ void GraphLayout::clone(BGL_Vertex v)
 	for (std::list<Connector*>::iterator it = connectors.begin(); it != connectors.end(); ++it)
 	{
 		// we create a new clone, at the same position as the old clone
-		CloneContent * newClone = new CloneContent(v, this);
+		CloneContent * newClone = new (this) CloneContent(v, this);
 		newClone->setPosition(cd->x(), cd->y());
 
 		// we identify the source and target of the connector
@@ -666,7 +875,7 @@ void GraphLayout::clone(BGL_Vertex v)
 		if (cloneContainer == NULL)
 		{ 
 			// we create a new one, in the current container of the root (or its parent, cf convoluted case)
-			cloneContainer = new ContainerContent(this, parent, "CloneContainer");
+			cloneContainer = new (this) ContainerContent(this, parent, "CloneContainer");
 			// we set that container as a clone container
 			cloneContainer->setContentLayoutStrategy(Clone); // [!] what about edges? avoiding?
 			// we add the root/neighbour to it, as a root
@@ -731,7 +940,7 @@ void GraphLayout::unclone(BGL_Vertex v, CloneContent * c)
 	std::list<CloneContent *> cList = this->getClones(v);
 
 	// we create a new clone
-	CloneContent * newClone = new CloneContent(v, this);
+	CloneContent * newClone = new (this) CloneContent(v, this);
 
 	// if an old clone position is given, we use it for the new clone
 	if (c) newClone->setPosition(c->x(), c->y());
@@ -887,7 +1096,7 @@ std::list<CloneContent*> GraphLayout::addNeighbourFromEdge(BGL_Edge edge, CloneC
 	{
 		if (isVisible)  // if it should be visible, we create it and add it to the neighbourhood
 		{
-			neighbour = new CloneContent(v, this);
+			neighbour = new (this) CloneContent(v, this);
 			neighbourhood.push_back(neighbour);
 		}
 //		else clone->hasMoreEdges = true; // if it should remain invisible, we mark the clone has having undisplayed edges
@@ -905,12 +1114,14 @@ std::list<CloneContent*> GraphLayout::addNeighbourFromEdge(BGL_Edge edge, CloneC
 
 std::list<CloneContent*> GraphLayout::buildNeighbours(CloneContent * clone, std::list<CloneContent *> neighbourhood, bool isVisible)
 {
-	std::list<BGL_Edge> inEdges = this->graphModel->getInEdges(clone->getVertex());
-	for (std::list<BGL_Edge>::iterator ei = inEdges.begin(); ei != inEdges.end(); ++ei)
+	const GraphSnapshot & graph = this->graphModel->getSnapshot();
+
+	GraphRange<BGL_Edge> inEdges = graph.getInEdges(clone->getVertex());
+	for (GraphRange<BGL_Edge>::iterator ei = inEdges.begin(); ei != inEdges.end(); ++ei)
 		neighbourhood = this->addNeighbourFromEdge(*ei, clone, neighbourhood, true, isVisible);
 
-	std::list<BGL_Edge> outEdges = this->graphModel->getOutEdges(clone->getVertex());
-	for (std::list<BGL_Edge>::iterator ei = outEdges.begin(); ei != outEdges.end(); ++ei)
+	GraphRange<BGL_Edge> outEdges = graph.getOutEdges(clone->getVertex());
+	for (GraphRange<BGL_Edge>::iterator ei = outEdges.begin(); ei != outEdges.end(); ++ei)
 		neighbourhood = this->addNeighbourFromEdge(*ei, clone, neighbourhood, false, isVisible);
 
 	return neighbourhood;			
@@ -925,7 +1136,7 @@ void GraphLayout::expand(std::list<BGL_Vertex> vList)
 	for (std::list<BGL_Vertex>::iterator it = vList.begin(); it != vList.end(); ++it)
 	{
 		std::list<CloneContent*> clones = this->cloneMap[*it];
-		if (clones.empty()) clones.push_back(new CloneContent(*it, this));
+		if (clones.empty()) clones.push_back(new (this) CloneContent(*it, this));
 		for (std::list<CloneContent*>::iterator ic = clones.begin(); ic != clones.end(); ++ic)
 		{
 			roots.push_back(*ic);
@@ -966,7 +1177,7 @@ void GraphLayout::expand(std::list<BGL_Vertex> vList)
 			}
 			else
 			{
-				neighbour = new CloneContent(v, this);
+				neighbour = new (this) CloneContent(v, this);
 				neighbourhood.push_back(neighbour);
 			}
 
@@ -1003,7 +1214,7 @@ void GraphLayout::expand(std::list<BGL_Vertex> vList)
 
 			if (!neighbour)
 			{
-				neighbour = new CloneContent(v, this);
+				neighbour = new (this) CloneContent(v, this);
 				neighbourhood.push_back(neighbour);
 			}
 
@@ -1054,7 +1265,7 @@ void GraphLayout::fillGaps(std::list<CloneContent*> roots)
 			}
 			else
 			{
-				neighbour = new CloneContent(v, this);
+				neighbour = new (this) CloneContent(v, this);
 				neighbourhood.push_back(neighbour);
 			}
 
@@ -1091,7 +1302,7 @@ void GraphLayout::fillGaps(std::list<CloneContent*> roots)
 
 			if (!neighbour)
 			{
-				neighbour = new CloneContent(v, this);
+				neighbour = new (this) CloneContent(v, this);
 				neighbourhood.push_back(neighbour);
 			}
 
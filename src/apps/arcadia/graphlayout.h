@@ -37,19 +37,62 @@
 #include "graphmodel.h"
 #include "containercontent.h"
 
+// STL
+#include <set>
+
+// Qt, for the connector index
+#include <QHash>
+#include <QPair>
+#include <QMutex>
+
+// local, for the memory of the layout objects
+#include "layoutpool.h"
+
 // local (managed by the GraphLayout)
 class CloneContent;
 class Connector;
 class ConnectorLayoutManager;
+class GraphSnapshot;
 //class StyleSheet;
 class StyleSheet;
 
+typedef GraphRange<CloneContent*, std::list<CloneContent*>::const_iterator> CloneRange;
+typedef GraphRange<Connector*, std::list<Connector*>::const_iterator> ConnectorRange;
+
+/****************
+* LayoutChanges *
+*****************
+* What changed in a GraphLayout since its view last looked (cf. GraphLayout::takeChanges)
+* so that the view only updates the graphics items concerned
+*
+* A destroyed object is only listed as removed, whatever happened to it before
+* Its memory may already hold a new object (cf. LayoutPool), listed as added:
+* the removed objects are to be dealt with first, and never dereferenced
+******************************************************************************************/
+struct LayoutChanges
+{
+	std::set<CloneContent *> movedClones;
+	std::set<CloneContent *> restyledClones; // reactions that flipped, clones that changed container
+	std::set<BGL_Vertex> remappedVertices; // whose clones got created or destroyed
+
+	std::set<Connector *> addedConnectors;
+	std::set<Connector *> changedConnectors; // new points, or new ends
+	std::set<Connector *> removedConnectors;
+
+	std::set<ContainerContent *> addedContainers;
+	std::set<ContainerContent *> changedContainers; // obsolete bounding box
+	std::set<ContainerContent *> removedContainers;
+
+	void swap(LayoutChanges & changes);
+};
+
 /**************
 * GraphLayout *
 ***************
 * This class manages a set of objects describing a layout for a given graph
 * [!] maybe I should keep a reference to the graph here? (a pointer)
 * These objects are usually created by, and ALWAYS destroyed along with the layout
+* (their memory comes from the LayoutPool of the layout, freed in a few large blocks)
 * Rem: in many ways, this replaces some of the old LayoutGraphView roles
 *
 * CloneContent objects
@@ -58,12 +101,15 @@ class StyleSheet;
 * The map can be written with the map and unmap methods
 * For a given vertex, the map is read through the getClone/s methods
 * A list of all clones can also be obtained with getCloneContents
+* (or, for a given vertex, browsed in place with getCloneRange)
 *
 * Root Container
 * Every Content type objects (CloneContent and Container) are listed in a tree
 * The root of that tree is accessible through the getRoot method
 * By default, any newly mapped CloneContent gets placed at the root
 * The Root can be laid out automatically thanks to the update method
+* which also orients the reactions around the clones that moved since the last update
+* (the reactions that flipped are then listed as restyled, cf. takeChanges)
 * The Root is created automatically with a default LayoutManager
 * [!] should let configure the root layout method
 * When the root is destroyed, so are every objects it contains
@@ -74,12 +120,20 @@ class StyleSheet;
 * But instead of linking 2 BGL_Vertex, they link the 2 corresponding clones
 * Connectors are created with the connect method stating two BGL_Vertex
 * Connectors are accessed with the getConnector method stating two BGL_Vertex
-* or through a method returning the global connector list
+* (or two CloneContents) or through a method returning the global connector list
 * Internally, Connectors are kept as a list, and refer to CloneContents
+* They are also indexed by BGL_Edge and by pair of clones, for constant time lookups:
+* the clones keep that index up to date whenever a Connector gets attached to them
+* or detached from them (creation, cloning, uncloning, destruction...)
 * The GraphLayout class has a private method for finding the clone
 * corresponding to a given (vertex, neighbour) pair
 * Connectors are normally destroyed along with the Clone they point at
 *
+* Changes
+* The clones, connectors and containers report what happens to them (creation, move, new route...)
+* and the layout gathers it until its view takes it (cf. LayoutChanges)
+* [!] assumes a single view per layout: a second one would miss what the first one took
+*
 * Specific actions can be performed on the GraphLayout
 * in particular cloning related action on a given vertex
 ***********************************************************************************************/
@@ -91,20 +145,26 @@ public:
 
 	// Root Container
 	ContainerContent *getRoot();
-	void update(bool edgesOnly = false, bool fast = false);
+	void update(bool edgesOnly = false, bool fast = false, bool force = false);
+	void quickUpdate(); // the fast part of update, for dragged clones
 
 	// CloneContent
 	void map(BGL_Vertex v, CloneContent * cd);
 	void unmap(CloneContent * cd);	
+	void cloneMoved(CloneContent * cd);
+	void cloneRestyled(CloneContent * cd);
 	CloneContent * getClone(BGL_Vertex v); // the first one
 	std::list<CloneContent*> getClones(BGL_Vertex v);
+	CloneRange getCloneRange(BGL_Vertex v);
 	std::list< CloneContent * > getCloneContents();
 
 	// Connector
 	Connector * connect(BGL_Edge e);
 	Connector * connectClones(CloneContent * u, CloneContent * v, BGL_Edge e);
 	Connector * getConnector(BGL_Vertex u, BGL_Vertex v, BGL_Edge e);	
+	Connector * getConnector(CloneContent * u, CloneContent * v);
 	std::list< Connector * > getConnectors();
+	ConnectorRange getConnectorRange() { return ConnectorRange(this->connectorList); }
 
 	// cloning/branching actions
 	void toggleCloning(BGL_Vertex v, CloneContent * c);
@@ -124,6 +184,12 @@ public:
 	bool isAvoiding() { return this->avoiding; }
 	void toggleAvoiding() { this->avoiding = !this->avoiding; }
 	void setAvoiding(bool v) { this->avoiding = v; }
+	// when avoiding, connectors get horizontal and vertical segments only
+	bool isOrthogonal() { return this->orthogonal; }
+	void toggleOrthogonal() { this->orthogonal = !this->orthogonal; }
+	void setOrthogonal(bool v) { this->orthogonal = v; }
+	ConnectorLayoutManager * getConnectorLayoutManager() { return this->connectorLayoutManager; }
+	LayoutPool & getPool() { return this->pool; }
 
 /*
 	void expand(std::list<BGL_Vertex> vList);
@@ -140,9 +206,24 @@ public:
 	void map(ContainerContent * container);
 	void unMap(ContainerContent * container);
 
+	// called by the clones, as connectors get attached to or detached from them
+	void indexConnector(Connector * c);
+	void unindexConnector(Connector * c);
+
+	// what changed since the last call, for the view
+	void takeChanges(LayoutChanges & changes);
+	// called by the connectors and containers themselves
+	void connectorAdded(Connector * c);
+	void connectorChanged(Connector * c);
+	void connectorRemoved(Connector * c);
+	void containerAdded(ContainerContent * c);
+	void containerChanged(ContainerContent * c);
+	void containerRemoved(ContainerContent * c);
+
 private:
 	bool visible;
 	bool avoiding;
+	bool orthogonal;
 
 	std::list<CloneContent*> buildNeighbours(CloneContent * clone, std::list<CloneContent *> neighbourhood, bool isVisible);
 	std::list<CloneContent*> addNeighbourFromEdge(BGL_Edge edge, CloneContent * clone,
@@ -156,11 +237,20 @@ private:
 	void branch(CloneContent * c, ContainerContent * parent, ContainerContent * cloneContainer);
 	void unbranch(CloneContent * c, ContainerContent * parent, ContainerContent * cloneContainer);
 
+	LayoutPool pool; // memory of the clones, containers and connectors below
 	ContainerContent *root;
 	std::map< BGL_Vertex, std::list<CloneContent*> > cloneMap;
 	std::list< Connector * > connectorList;
+	QHash< void *, Connector * > edgeToConnector; // by edge property, unique to each edge
+	QHash< QPair<CloneContent *, CloneContent *>, Connector * > clonesToConnector;
 	
 	CloneContent * findClone (BGL_Edge edge, bool isSource);
+
+	// reactions to orient again at the next update
+	bool orientReaction(CloneContent * rClone, const GraphSnapshot & graph);
+	std::set< CloneContent * > movedClones;
+	LayoutChanges changes;
+	QMutex movedMutex; // clones move and containers get flagged from the layout threads (guards the changes too)
 	
 	ConnectorLayoutManager * connectorLayoutManager;
 	
@@ -44,6 +44,7 @@
 #include "graphlayout.h"
 #include "clonecontent.h"
 #include "graphloader.h"
+#include "graphsnapshot.h"
 #include "stylesheet.h"
 
 // [!] should I add a copy constructor for this class and subclasses?
@@ -81,7 +82,7 @@ PathwayGraph* PathwayGraph::getProjection()
 * Creates the two property maps
 * and sets the fileName (by default, Untitled.graph)
 ****************************************************/
-GraphModel::GraphModel(std::string fName, bool createStyleSheet) : fileName(fName), layoutStyleSheet(NULL)
+GraphModel::GraphModel(std::string fName, bool createStyleSheet) : fileName(fName), layoutStyleSheet(NULL), version(0), snapshot(NULL)
 {
 	this->vertexProperties = get(vertex_name, this->graph);
 	this->edgeProperties = get(edge_name, this->graph);
@@ -102,6 +103,7 @@ GraphModel::~GraphModel()
 	this->removeEdges();
 	this->removeVertices();
 	if (this->layoutStyleSheet) delete this->layoutStyleSheet;
+	delete this->snapshot;
 }
 
 /****************************************************************************************
@@ -193,6 +195,7 @@ BGL_Vertex GraphModel::addVertex(VertexProperty * properties)
 	BGL_Vertex v = add_vertex(this->graph);
 	if (!properties) properties = new VertexProperty();
 	this->vertexProperties[v] = properties;
+	this->version++;
 	
 	return v;
 }
@@ -214,6 +217,7 @@ BGL_Edge GraphModel::addEdge(BGL_Vertex source, BGL_Vertex target, EdgeProperty
 	tie (e, inserted) = add_edge(source, target, this->graph);
 	if (!properties) properties = new EdgeProperty();
 	this->edgeProperties[e] = properties;
+	this->version++;
 
 	return e;
 }
@@ -235,6 +239,7 @@ void GraphModel::removeVertex(BGL_Vertex v)
 	this->removeEdges(v);
 	if (this->vertexProperties[v]) delete this->vertexProperties[v];
 	remove_vertex(v, this->graph);
+	this->version++;
 }
 
 /*************
@@ -248,6 +253,7 @@ void GraphModel::removeEdge(BGL_Edge e)
 {
 	if (this->edgeProperties[e]) delete this->edgeProperties[e];
 	remove_edge(e, this->graph);
+	this->version++;
 }
 
 /*****************
@@ -432,6 +438,23 @@ bool GraphModel::isEdge(BGL_Vertex u, BGL_Vertex v)
 	return edge(u, v, this->graph).second;
 }
 
+/**************
+* getSnapshot *
+***************
+* returns the compressed copy of the graph structure
+* built anew if the graph changed since the last one
+* (it must not be kept across changes)
+****************************************************/
+const GraphSnapshot & GraphModel::getSnapshot()
+{
+	if (!this->snapshot || this->snapshot->getVersion() != this->version)
+	{
+		delete this->snapshot;
+		this->snapshot = new GraphSnapshot(this->graph, this->version);
+	}
+	return *this->snapshot;
+}
+
 /*
 BGL_Edge GraphModel::getEdge(BGL_Vertex u, BGL_Vertex v);
 {
@@ -486,7 +509,7 @@ void GraphModel::defaultLayout(bool update)
 	std::list<BGL_Vertex> vList = this->getVertices();
 	for (std::list<BGL_Vertex>::iterator it = vList.begin(); it != vList.end(); ++it)
 	{
-		new CloneContent(*it, graphLayout);
+		new (graphLayout) CloneContent(*it, graphLayout);
 	}
 
 	// adds edges as Connectors (1-1)
@@ -532,10 +555,16 @@ int GraphModel::getNumber(GraphLayout * gl)
 	return n;
 }
 
+/***************
+* updateLayout *
+****************
+* The updates asked for through the controller (update layout commands, moves...)
+* A full update is forced: the whole layout is computed again, not just what changed
+************************************************************************************/
 void GraphModel::updateLayout(GraphLayout * gl, bool edgesOnly, bool fast)
 {
-	if (gl) gl->update(edgesOnly, fast);
-	else for (int i = 0; i < this->layoutNumber(); ++i) this->getLayout(i)->update(edgesOnly, fast);
+	if (gl) gl->update(edgesOnly, fast, true);
+	else for (int i = 0; i < this->layoutNumber(); ++i) this->getLayout(i)->update(edgesOnly, fast, true);
 }
 
 /****************
@@ -647,7 +676,7 @@ GraphLayout * GraphModel::addLayout(std::list<BGL_Vertex> vList, bool neighbourh
 		for (std::list<BGL_Vertex>::iterator it = vList.begin(); it != vList.end(); ++it)
 		{
 			BGL_Vertex v = *it;
-			CloneContent * clone = new CloneContent(v, graphLayout);
+			CloneContent * clone = new (graphLayout) CloneContent(v, graphLayout);
 			// clone->setSelected(true);
 			roots.push_back(clone);
 		
@@ -693,6 +722,14 @@ void GraphModel::toggleAvoidingEdges()
 	}
 }
 
+void GraphModel::toggleOrthogonalEdges()
+{
+	for (int i = 0; i < this->layoutNumber(); ++i)
+	{
+		if (this->getLayout(i)->isVisible()) this->getLayout(i)->toggleOrthogonal();
+	}
+}
+
 GraphLayout * GraphModel::getCurrentLayout()
 {
 	GraphLayout * layout = NULL;
@@ -41,10 +41,12 @@
 using namespace boost;
 
 // local
+#include "layoutpool.h"
 class VertexProperty;
 class EdgeProperty;
 class GraphLayout;
 class CloneContent;
+class GraphSnapshot;
 //class StyleSheet;
 class StyleSheet;
 
@@ -88,6 +90,8 @@ typedef graph_traits<BGL_Graph>::adjacency_iterator BGL_Adj_iter;
 * (individually or in bulk for removal)
 * Also we can obtain lists of BGL_Vertex and BGL_Edge objects
 * for the whole graph, or adjacent to a given graph object
+* Read only algorithms should rather browse the GraphSnapshot of the graph (cf. getSnapshot)
+* which is only rebuilt when vertices or edges have been added or removed in the meantime
 *
 * BGL_Vertex and BGL_Edge are also associated to individual properties
 * through a protected property map (read only public access)
@@ -123,6 +127,9 @@ public:
 	std::list<BGL_Edge> getOutEdges(BGL_Vertex v);
 	bool isEdge(BGL_Vertex u, BGL_Vertex v);
 
+	// read the whole structure, without copies
+	const GraphSnapshot & getSnapshot();
+
 	// read edges
 	std::list<BGL_Edge> getEdges();
 	BGL_Vertex getSource(BGL_Edge e);
@@ -166,8 +173,10 @@ public:
 	GraphLayout * getNextLayout(GraphLayout * gl, int i);
 	
 	StyleSheet * getStyleSheet() { return this->layoutStyleSheet; }
+	LayoutSpares & getLayoutSpares() { return this->layoutSpares; }
 
 	void toggleAvoidingEdges();
+	void toggleOrthogonalEdges();
 	GraphLayout * destroyLayout();
 	void destroyLayout(GraphLayout * gl);
 	
@@ -175,6 +184,11 @@ public:
 
 private:
 	BGL_Graph graph;
+
+	unsigned int version; // incremented whenever a vertex or an edge gets added or removed
+	GraphSnapshot * snapshot;
+
+	LayoutSpares layoutSpares; // blocks left by the deleted layouts, freed after the last one
 	
 protected:
 	StyleSheet * layoutStyleSheet;
@@ -0,0 +1,71 @@
+/***********************************************************************
+*
+*  Arcadia is a visualisation tool for metabolic pathways
+*
+*  This file is part of the arcadia1.0 application distribution
+*  Copyright (C) 2007-2009 Alice Villeger, University of Manchester
+*  <alice.villeger@manchester.ac.uk>
+*
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*************************************************************************/
+
+/*
+ *  GraphRange.h
+ *  arcadia
+ *
+ */
+
+#ifndef GRAPHRANGE_H
+#define GRAPHRANGE_H
+
+// STL
+#include <iterator>
+#include <list>
+
+/*************
+* GraphRange *
+**************
+* A read only view on consecutive elements owned by someone else
+* (a GraphSnapshot, the children of a ContainerContent, the connectors of a GraphLayout...)
+* Can be browsed like a list (begin, end, size...) but copies nothing
+* (the ranges on the graph structure still cost one GraphSnapshot rebuild
+* after each change of the graph, cf. GraphModel::getSnapshot)
+*
+* It is only valid as long as its owner doesn't change:
+* callers that add or remove elements while browsing still need a copy of the list
+*******************************************************************************************/
+template <class T, class I = const T *> class GraphRange
+{
+public:
+	typedef I iterator;
+
+	GraphRange() : first(), last() {}
+	GraphRange(I f, I l) : first(f), last(l) {}
+	GraphRange(const std::list<T> & l) : first(l.begin()), last(l.end()) {}
+
+	iterator begin() const { return this->first; }
+	iterator end() const { return this->last; }
+	unsigned int size() const { return std::distance(this->first, this->last); }
+	bool empty() const { return this->first == this->last; }
+
+	const T & front() const { return *this->first; }
+	const T & operator[](unsigned int i) const { return this->first[i]; } // [!] only for vectors
+
+private:
+	I first;
+	I last;
+};
+
+#endif
@@ -0,0 +1,172 @@
+/***********************************************************************
+*
+*  Arcadia is a visualisation tool for metabolic pathways
+*
+*  This file is part of the arcadia1.0 application distribution
+*  Copyright (C) 2007-2009 Alice Villeger, University of Manchester
+*  <alice.villeger@manchester.ac.uk>
+*
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*************************************************************************/
+
+/*
+ *  GraphSnapshot.cpp
+ *  arcadia
+ *
+ */
+
+#include "graphsnapshot.h"
+
+/**************
+* Constructor *
+***************
+* Numbers the vertices then the edges, in the order of the graph
+* Then stores the edges around each vertex, in then out
+* along with the vertex at their other end
+***************************************************************/
+GraphSnapshot::GraphSnapshot(BGL_Graph & graph, unsigned int v) : version(v)
+{
+	this->vertices.reserve(num_vertices(graph));
+	BGL_Vertex_iter vi, vi_end;
+	for (tie(vi, vi_end) = boost::vertices(graph); vi != vi_end; ++vi)
+	{
+		this->vertexToIndex[*vi] = this->vertices.size();
+		this->vertices.push_back(*vi);
+	}
+
+	this->edges.reserve(num_edges(graph));
+	this->sources.reserve(num_edges(graph));
+	this->targets.reserve(num_edges(graph));
+	BGL_Edge_iter ei, ei_end;
+	for (tie(ei, ei_end) = boost::edges(graph); ei != ei_end; ++ei)
+	{
+		BGL_Edge e = *ei;
+		this->edgeToIndex[e.get_property()] = this->edges.size();
+		this->edges.push_back(e);
+		this->sources.push_back(this->vertexToIndex[source(e, graph)]);
+		this->targets.push_back(this->vertexToIndex[target(e, graph)]);
+	}
+
+	this->first.reserve(this->vertices.size() + 1);
+	this->middle.reserve(this->vertices.size());
+	this->incidentEdges.reserve(2 * this->edges.size());
+	this->incidentEdgeIndices.reserve(2 * this->edges.size());
+	this->neighbours.reserve(2 * this->edges.size());
+	this->neighbourIndices.reserve(2 * this->edges.size());
+	for (std::vector<BGL_Vertex>::iterator it = this->vertices.begin(); it != this->vertices.end(); ++it)
+	{
+		this->first.push_back(this->incidentEdges.size());
+
+		BGL_In_iter i, i_end;
+		for (tie(i, i_end) = in_edges(*it, graph); i != i_end; ++i)
+		{
+			BGL_Edge e = *i;
+			int index = this->edgeToIndex[e.get_property()];
+			this->incidentEdges.push_back(e);
+			this->incidentEdgeIndices.push_back(index);
+			this->neighbours.push_back(source(e, graph));
+			this->neighbourIndices.push_back(this->sources[index]);
+		}
+
+		this->middle.push_back(this->incidentEdges.size());
+
+		BGL_Out_iter o, o_end;
+		for (tie(o, o_end) = out_edges(*it, graph); o != o_end; ++o)
+		{
+			BGL_Edge e = *o;
+			int index = this->edgeToIndex[e.get_property()];
+			this->incidentEdges.push_back(e);
+			this->incidentEdgeIndices.push_back(index);
+			this->neighbours.push_back(target(e, graph));
+			this->neighbourIndices.push_back(this->targets[index]);
+		}
+	}
+	this->first.push_back(this->incidentEdges.size());
+}
+
+/***********
+* getIndex *
+************
+* returns the index of a vertex, or -1 if it is not in the snapshot
+*******************************************************************/
+int GraphSnapshot::getIndex(BGL_Vertex v) const
+{
+	std::map<BGL_Vertex, int>::const_iterator it = this->vertexToIndex.find(v);
+	return (it == this->vertexToIndex.end())? -1: it->second;
+}
+
+/***********
+* getIndex *
+************
+* returns the index of an edge, or -1 if it is not in the snapshot
+******************************************************************/
+int GraphSnapshot::getIndex(BGL_Edge e) const
+{
+	std::map<void *, int>::const_iterator it = this->edgeToIndex.find(e.get_property());
+	return (it == this->edgeToIndex.end())? -1: it->second;
+}
+
+/****************************************************************************************
+* Traversing vertices and edges                                                         *
+* (same contents and order as the GraphModel methods of the same name)                  *
+****************************************************************************************/
+
+GraphRange<BGL_Vertex> GraphSnapshot::getVertices() const
+{
+	return GraphSnapshot::Range(this->vertices, 0, this->vertices.size());
+}
+
+GraphRange<BGL_Edge> GraphSnapshot::getEdges() const
+{
+	return GraphSnapshot::Range(this->edges, 0, this->edges.size());
+}
+
+GraphRange<BGL_Vertex> GraphSnapshot::getNeighbours(BGL_Vertex v) const
+{
+	int i = this->getIndex(v);
+	if (i == -1) return GraphRange<BGL_Vertex>();
+	return GraphSnapshot::Range(this->neighbours, this->first[i], this->first[i+1]);
+}
+
+GraphRange<BGL_Edge> GraphSnapshot::getEdges(BGL_Vertex v) const
+{
+	int i = this->getIndex(v);
+	if (i == -1) return GraphRange<BGL_Edge>();
+	return GraphSnapshot::Range(this->incidentEdges, this->first[i], this->first[i+1]);
+}
+
+GraphRange<BGL_Edge> GraphSnapshot::getInEdges(BGL_Vertex v) const
+{
+	int i = this->getIndex(v);
+	if (i == -1) return GraphRange<BGL_Edge>();
+	return GraphSnapshot::Range(this->incidentEdges, this->first[i], this->middle[i]);
+}
+
+GraphRange<BGL_Edge> GraphSnapshot::getOutEdges(BGL_Vertex v) const
+{
+	int i = this->getIndex(v);
+	if (i == -1) return GraphRange<BGL_Edge>();
+	return GraphSnapshot::Range(this->incidentEdges, this->middle[i], this->first[i+1]);
+}
+
+GraphRange<int> GraphSnapshot::getNeighbourIndices(int i) const
+{
+	return GraphSnapshot::Range(this->neighbourIndices, this->first[i], this->first[i+1]);
+}
+
+GraphRange<int> GraphSnapshot::getEdgeIndices(int i) const
+{
+	return GraphSnapshot::Range(this->incidentEdgeIndices, this->first[i], this->first[i+1]);
+}
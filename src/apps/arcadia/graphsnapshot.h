@@ -0,0 +1,113 @@
+/***********************************************************************
+*
+*  Arcadia is a visualisation tool for metabolic pathways
+*
+*  This file is part of the arcadia1.0 application distribution
+*  Copyright (C) 2007-2009 Alice Villeger, University of Manchester
+*  <alice.villeger@manchester.ac.uk>
+*
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*************************************************************************/
+
+/*
+ *  GraphSnapshot.h
+ *  arcadia
+ *
+ */
+
+#ifndef GRAPHSNAPSHOT_H
+#define GRAPHSNAPSHOT_H
+
+// STL
+#include <map>
+#include <vector>
+
+// local, for the BGL types
+#include "graphmodel.h"
+#include "graphrange.h"
+
+/****************
+* GraphSnapshot *
+*****************
+* An immutable copy of the structure of a BGL_Graph, in compressed adjacency form:
+* vertices and edges get dense indices (in the order of the BGL_Graph),
+* and the edges around each vertex are stored next to each other in a single vector
+* (the in edges first, then the out edges, as with GraphModel::getEdges)
+*
+* The BGL_Graph stores its vertices and edges in linked lists, which are slow to browse
+* and GraphModel returns fresh copies of them: the snapshot is meant for the algorithms
+* that browse the graph again and again without modifying it (cf. GraphModel::getSnapshot)
+*
+* The snapshot holds the version of the graph it was built from:
+* it is obsolete as soon as a vertex or an edge gets added or removed
+******************************************************************************************/
+class GraphSnapshot
+{
+public:
+	GraphSnapshot(BGL_Graph & graph, unsigned int v);
+
+	unsigned int getVersion() const { return this->version; }
+
+	// dense indices
+	unsigned int vertexCount() const { return this->vertices.size(); }
+	unsigned int edgeCount() const { return this->edges.size(); }
+	int getIndex(BGL_Vertex v) const;
+	int getIndex(BGL_Edge e) const;
+	BGL_Vertex getVertex(int i) const { return this->vertices[i]; }
+	BGL_Edge getEdge(int i) const { return this->edges[i]; }
+	int getSourceIndex(int e) const { return this->sources[e]; }
+	int getTargetIndex(int e) const { return this->targets[e]; }
+
+	// read vertices
+	GraphRange<BGL_Vertex> getVertices() const;
+	GraphRange<BGL_Vertex> getNeighbours(BGL_Vertex v) const;
+	GraphRange<BGL_Edge> getEdges(BGL_Vertex v) const;
+	GraphRange<BGL_Edge> getInEdges(BGL_Vertex v) const;
+	GraphRange<BGL_Edge> getOutEdges(BGL_Vertex v) const;
+
+	// read edges
+	GraphRange<BGL_Edge> getEdges() const;
+
+	// same, with indices
+	GraphRange<int> getNeighbourIndices(int i) const;
+	GraphRange<int> getEdgeIndices(int i) const;
+
+private:
+	unsigned int version;
+
+	std::vector<BGL_Vertex> vertices;
+	std::map<BGL_Vertex, int> vertexToIndex;
+
+	std::vector<BGL_Edge> edges;
+	std::map<void *, int> edgeToIndex; // by edge property, unique to each edge
+	std::vector<int> sources;
+	std::vector<int> targets;
+
+	// the in edges of vertex i are at [first[i], middle[i]), its out edges at [middle[i], first[i+1])
+	std::vector<int> first;
+	std::vector<int> middle;
+	std::vector<BGL_Edge> incidentEdges;
+	std::vector<int> incidentEdgeIndices;
+	std::vector<BGL_Vertex> neighbours; // at the other end of the incident edge
+	std::vector<int> neighbourIndices;
+
+	template <class T> static GraphRange<T> Range(const std::vector<T> & v, int begin, int end)
+	{
+		if (begin == end) return GraphRange<T>();
+		return GraphRange<T>(&v[0] + begin, &v[0] + end);
+	}
+};
+
+#endif
@@ -63,10 +63,16 @@ const lt_symlist_t lt_preloaded_symbols[] = {
 #include <iostream>
 
 // STL
-#include <sstream>
+#include <stdio.h>
 #include <list>
 #include <stack>
 #include <stdexcept>
+#include <vector>
+
+// Qt
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTime>
 
 // local
 #include "containercontent.h"
@@ -74,6 +80,57 @@ const lt_symlist_t lt_preloaded_symbols[] = {
 
 #include "clonecontent.h" // [!] for label display
 
+/************************
+* GraphvizContextPool *
+*************************
+* The graphviz contexts not in use at the moment (none until the first layout)
+* Creating a context loads the graphviz plugins, which is much too slow to do
+* for every container: instead, contexts get reused, and are only freed at exit
+* The pool can serve several layouts at once, hence the mutex
+*********************************************************************************/
+class GraphvizContextPool
+{
+public:
+	~GraphvizContextPool()
+	{
+		for (std::vector<GVC_t *>::iterator it = this->contexts.begin(); it != this->contexts.end(); ++it) gvFreeContext(*it);
+	}
+
+	GVC_t * acquire()
+	{
+		QMutexLocker locker(&this->mutex);
+		if (this->contexts.empty()) return gvContext();
+		GVC_t * graphContext = this->contexts.back();
+		this->contexts.pop_back();
+		return graphContext;
+	}
+
+	void release(GVC_t * graphContext)
+	{
+		QMutexLocker locker(&this->mutex);
+		this->contexts.push_back(graphContext);
+	}
+
+private:
+	QMutex mutex;
+	std::vector<GVC_t *> contexts;
+};
+
+static GraphvizContextPool ContextPool;
+
+GVC_t * GraphvizContentLayoutManager::AcquireContext() { return ContextPool.acquire(); }
+
+void GraphvizContentLayoutManager::ReleaseContext(GVC_t * graphContext) { ContextPool.release(graphContext); }
+
+/****************
+* GraphvizMutex *
+*****************
+* libgraph keeps its own global state (current graph, attribute dictionaries...)
+* so, when containers get laid out in parallel, only one graphviz graph may exist at a time
+* The lock is held from agopen to agclose: the placement of the content works on a copy of the coordinates
+*****************************************************************************************************************/
+static QMutex GraphvizMutex;
+
 /**************************************************************************************************************************
 * Constructor: Initialises the graph to NULL, and the graphContext to a new one. Also sets up the method (dot by default) *
 **************************************************************************************************************************/
@@ -102,6 +159,9 @@ GraphvizContentLayoutManager::~GraphvizContentLayoutManager() {}
 * and sets the new value of each content's position
 * [!] the zoom value is pretty arbitrary
 * [!] the logical center of the content is not used...
+* Only one graphviz graph may exist at a time (cf. GraphvizMutex)
+* The time spent building the graph, in graphviz, and placing the content
+* is reported when timing is on (cf. ContentLayoutManager::Timing)
 *******************************************************/
 void GraphvizContentLayoutManager::layout(ContainerContent * container)
 {
@@ -114,11 +174,12 @@ void GraphvizContentLayoutManager::layout(ContainerContent * container)
 
 	////////////////////////////////////////////////////////////////////////////////////////////////
 		
-	// security for unmanageable graphs : uses a simpler layout method instead
-	if (container->getChildren().size() > 280)
+	// security for unmanageable graphs : uses a faster layout method instead
+	// (same rotation, and the core doesn't move either)
+	if (container->getChildRange().size() > 280)
 	{
-		std::cout << "security" << std::endl;
-		ContentLayoutManager * layoutManager = ContentLayoutManager::GetLayoutManager(Automatic);
+		ContentLayoutManager * layoutManager = ContentLayoutManager::GetLayoutManager(Force);
+		layoutManager->setRotation(this->rotation);
 		layoutManager->layout(container);
 		delete layoutManager;
 		return;
@@ -128,9 +189,15 @@ void GraphvizContentLayoutManager::layout(ContainerContent * container)
 
 	////////////////////////////////////////////////////////////////////////////////////////////////
 
-	// init graphviz objects
-    GVC_t * graphContext = gvContext();
-    Agraph_t * graph = agopen("g", AGDIGRAPH);
+	QTime timer;
+	timer.start();
+
+	// init graphviz objects (the width and height attributes are declared once for the whole graph)
+	QMutexLocker locker(&GraphvizMutex);
+	GVC_t * graphContext = GraphvizContentLayoutManager::AcquireContext();
+	Agraph_t * graph = agopen("g", AGDIGRAPH);
+	int widthIndex = agnodeattr(graph, "width", "")->index;
+	int heightIndex = agnodeattr(graph, "height", "")->index;
 
 
 
@@ -144,24 +211,25 @@ void GraphvizContentLayoutManager::layout(ContainerContent * container)
 
 	// We turn the children of the main container into graphviz nodes of similar-ish(?) dimensions
 	int nodeId = 0;
+	char nodeName[16], w[16], h[16];
 	std::map <Content*, Agnode_t *> contentToGraphVizNode;
 	for (std::list<Content*>::iterator it= cList.begin(); it != cList.end(); ++it)
 	{
 		Content * c = (*it);
 				
-		std::ostringstream nodeName; nodeName << nodeId++;
-		Agnode_t * gvNode = agnode(graph, (char*)nodeName.str().c_str());
+		sprintf(nodeName, "%d", nodeId++);
+		Agnode_t * gvNode = agnode(graph, nodeName);
 		contentToGraphVizNode[c] = gvNode;
 
-		std::ostringstream w;	w <<  c->width(true)/50; std::ostringstream h;	h <<  c->height(true)/50;
-		if (this->rotation)	{ agsafeset(gvNode, "width", (char*)h.str().c_str(), "");	agsafeset(gvNode, "height", (char*)w.str().c_str(), ""); }
-		else				{ agsafeset(gvNode, "width", (char*)w.str().c_str(), "");	agsafeset(gvNode, "height", (char*)h.str().c_str(), ""); }
+		sprintf(w, "%d", c->width(true)/50); sprintf(h, "%d", c->height(true)/50);
+		if (this->rotation)	{ agxset(gvNode, widthIndex, h);	agxset(gvNode, heightIndex, w); }
+		else				{ agxset(gvNode, widthIndex, w);	agxset(gvNode, heightIndex, h); }
 	}
 	if (nodeId == 0)
 	{
 		// destroy graphviz objects first
 		agclose( graph );
-		gvFreeContext( graphContext );
+		GraphvizContentLayoutManager::ReleaseContext( graphContext );
 		
 		return; // if there is none, no need to layout any further...
 	}
@@ -199,21 +267,39 @@ void GraphvizContentLayoutManager::layout(ContainerContent * container)
 
 	////////////////////////////////////////////////////////////////////////////////////////////////
 
+	int buildTime = timer.restart();
+
 	// layout						
 	gvLayout(graphContext, graph, (char*)this->method.c_str());
 
-
-	////////////////////////////////////////////////////////////////////////////////////////////////
-	
-	// setting the local zoom
-	float zoom = (this->method == "twopi")? 1.25: 0.75;
-
 	// getting the bounding box of the graph
 	box bb = GD_bb(graph); // boxf in latest version
 //	boxf bb = GD_bb(graph);
 	float right = bb.UR.x;	float top    = bb.UR.y;
 	float left  = bb.LL.x;	float bottom = bb.LL.y;
 
+	// getting the coordinates of every node, before the graph goes
+	std::map <Content*, point> contentToCoord;
+	for (std::list<Content*>::iterator it = cList.begin(); it != cList.end(); ++it)
+	{
+		contentToCoord[*it] = ND_coord_i(contentToGraphVizNode[*it]); // ND_coord and pointf in latest version
+//		contentToCoord[*it] = ND_coord(contentToGraphVizNode[*it]);
+	}
+
+	// destroy graphviz objects first
+	gvFreeLayout(graphContext, graph);
+	agclose( graph );
+	GraphvizContentLayoutManager::ReleaseContext( graphContext );
+	locker.unlock();
+
+	int graphvizTime = timer.restart();
+
+
+	////////////////////////////////////////////////////////////////////////////////////////////////
+	
+	// setting the local zoom
+	float zoom = (this->method == "twopi")? 1.25: 0.75;
+
 
 	////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -228,9 +314,7 @@ void GraphvizContentLayoutManager::layout(ContainerContent * container)
 		// we get it's current coordinates in our layout
 		x0 = core->x(); y0 = core->y();
 		// we get the new coordinates in graphviz layout
-		Agnode_t * coreNode = contentToGraphVizNode[core];
-		point p0 = ND_coord_i(coreNode); // ND_coord and pointf in latest version
-//		pointf p0 = ND_coord(coreNode);
+		point p0 = contentToCoord[core];
 		// we translate the graphviz coordinates in our coordinates system
 		X0 = p0.x*zoom; Y0 = (top - p0.y)*zoom;
 	}
@@ -246,9 +330,7 @@ void GraphvizContentLayoutManager::layout(ContainerContent * container)
 	{
 		Content * c = (*it);
 		// graphviz coordinates
-		Agnode_t * gvNode = contentToGraphVizNode[c];
-		point p = ND_coord_i(gvNode); // ND_coord and pointf in latest version
-//		pointf p = ND_coord(gvNode);
+		point p = contentToCoord[c];
 		
 		// translated coordinates so that the core of the main container doesn't move
 		float X = p.x*zoom - X0;
@@ -287,20 +369,15 @@ void GraphvizContentLayoutManager::layout(ContainerContent * container)
 		else				c->setPosition((x0 + X + dx) * xCompactFactor, (y0 + Y + dy) * yCompactFactor);		
 	}
 
-	// destroy graphviz objects first
-	gvFreeLayout(graphContext, graph);
-	agclose( graph );
-	gvFreeContext( graphContext );
-
 	// [!] fixing the position of compartments
 	for (std::list<Content*>::iterator it = cList.begin(); it != cList.end(); ++it)
 	{
 		Content * c = (*it);
 		if ( c->getId() == "" ) continue;
-		if ( ( (ContainerContent *) (c) )->getTypeLabel() != "CompContainer" ) continue;
+		if ( ( (ContainerContent *) (c) )->getType() != compartmentContainer ) continue;
 		ContainerContent * comp = (ContainerContent*)c;
 		
-		std::list<Connector*> eList = comp->getOutterConnectors();
+		ConnectorSetRange eList = comp->getOutterConnectorRange();
 		if (eList.size() != 1) continue; // can't deal with compartements with more than one core...
 		Connector * e = eList.front();
 		Content * reaction = e->getSourceContent(container);
@@ -357,6 +434,12 @@ void GraphvizContentLayoutManager::layout(ContainerContent * container)
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	this->layoutTriangleContainers(tList);
+
+	if (ContentLayoutManager::Timing)
+	{
+		std::cerr << "  " << this->method << ": " << nodeId << " nodes, " << connectors.size() << " edges, "
+			<< "build " << buildTime << " ms, layout " << graphvizTime << " ms, placement " << timer.elapsed() << " ms" << std::endl;
+	}
 }
 
 // in container and connectors, out inverselist and crossroad
@@ -449,8 +532,8 @@ void GraphvizContentLayoutManager::initTriangleContainerEdges(std::list<Containe
 	std::list<Connector*> oCon;
 	for (std::list<ContainerContent*>::iterator it= tList.begin(); it != tList.end(); ++it)
 	{
-		std::list<Connector*> eList = (*it)->getOutterConnectors();
-		for (std::list<Connector*>::iterator et= eList.begin(); et != eList.end(); ++et)
+		ConnectorSetRange eList = (*it)->getOutterConnectorRange();
+		for (ConnectorSetRange::iterator et= eList.begin(); et != eList.end(); ++et)
 		{
 			oCon.push_back(*et);
 		}
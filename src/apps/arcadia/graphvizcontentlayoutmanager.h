@@ -63,8 +63,10 @@ class Content;
 * Internally, this requires graphviz objects (graph and graphContext)
 * and a map between content and graphviz nodes
 *
-* The graphviz graph and graphContext are created and destroyed along with the class
-* However the graph content (nodes, edges) is reset every time a layout is computed
+* The graphviz graph is built anew every time a layout is computed
+* but the graphContexts are shared by all the layout managers, in a pool:
+* each layout borrows one (AcquireContext) and gives it back (ReleaseContext)
+* rather than paying for a new one every time
 ************************************************************************************/
 class GraphvizContentLayoutManager: public ContentLayoutManager {
 public:
@@ -72,6 +74,9 @@ public:
 	~GraphvizContentLayoutManager();
 	void layout(ContainerContent * container);
 
+	static GVC_t * AcquireContext();
+	static void ReleaseContext(GVC_t * graphContext);
+
 private:
 	std::string method;
 	
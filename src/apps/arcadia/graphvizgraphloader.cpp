@@ -52,6 +52,7 @@
 #include "graphlayout.h"
 #include "clonecontent.h"
 #include "connector.h"
+#include "graphvizcontentlayoutmanager.h"
 
 /***********
 * getModel *
@@ -84,7 +85,7 @@ void GraphvizGraphLoader::save(GraphModel *m, std::string fName)
 		
 		std::map <CloneContent*, Agnode_t *> cloneToGraphVizNode;	
 
-		GVC_t *graphContext = gvContext();
+		GVC_t *graphContext = GraphvizContentLayoutManager::AcquireContext();
 		Agraph_t *graph = agopen("g", AGDIGRAPH);
 
 		int nodeId = 0;
@@ -121,6 +122,6 @@ void GraphvizGraphLoader::save(GraphModel *m, std::string fName)
 		fclose(f);
 
 		agclose(graph);
-		gvFreeContext(graphContext);
+		GraphvizContentLayoutManager::ReleaseContext(graphContext);
 	}
 }
\ No newline at end of file
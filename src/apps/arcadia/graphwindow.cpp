@@ -49,6 +49,8 @@
 #include "propertygraphview.h"
 
 #include "graphcontroller.h"
+#include "graphmodel.h"
+#include "graphlayout.h"
 
 /*********************************************************************
 * Public Methods                                                     *
@@ -333,11 +335,21 @@ void GraphWindow::createControls(bool fullVersion)
 	action->setChecked(false);
 */
 
+	// no shortcut here: Ctrl+Shift+R belongs to the same toggle in the view toolbar
+	// the state of the current layout is shown whenever the menu opens (cf. updateViewActions)
+	action = this->createAction(viewActionList, "&Orthogonal Edges", "", "Toggles orthogonal edge routing (horizontal and vertical segments only), once Route Edges is on in the view toolbar");
+	QObject::connect(action, SIGNAL( triggered() ), this, SLOT( toggleOrthogonalEdges() ));
+	action->setCheckable(true);
+	action->setChecked(false);
+	action->setEnabled(false);
+	this->orthogonalAction = action;
+
 	if (menu)
 	{
 		this->createMenu(fileActionList, "&File");
 		this->createMenu(editActionList, "&Action");
-		this->createMenu(viewActionList, "&View");
+		QMenu * viewMenu = this->createMenu(viewActionList, "&View");
+		QObject::connect(viewMenu, SIGNAL( aboutToShow() ), this, SLOT( updateViewActions() ));
 	}
 	
 	if (toolbar)
@@ -411,6 +423,26 @@ void GraphWindow::toggleAvoidingEdges()
 	if (this->controller) this->controller->toggleAvoidingEdges();
 }
 
+void GraphWindow::toggleOrthogonalEdges()
+{
+	if (this->controller) this->controller->toggleOrthogonalEdges();
+}
+
+/********************
+* updateViewActions *
+*********************
+* The edge routing is set per layout, from the menu or from the toolbar of each view:
+* the menu shows the state of the current layout
+* (orthogonal routing only makes sense once edges are routed)
+*****************************************************************************************/
+void GraphWindow::updateViewActions()
+{
+	GraphModel * model = this->controller? this->controller->graphModel(): NULL;
+	GraphLayout * layout = model? model->getCurrentLayout(): NULL;
+	this->orthogonalAction->setChecked(layout && layout->isOrthogonal());
+	this->orthogonalAction->setEnabled(layout && layout->isAvoiding());
+}
+
 void GraphWindow::toggleModifiersCloning()
 {
 	if (this->controller) this->controller->toggleModifiersCloning();
@@ -82,6 +82,8 @@ private slots:
 	void toggleModifiersCloning();
 	void toggleReactionsFusing();
 	void toggleAvoidingEdges();
+	void toggleOrthogonalEdges();
+	void updateViewActions();
 	void destroyLayout();
 	void updateLayout();
 	void arrangeSelection();
@@ -101,6 +103,7 @@ private:
 	QToolBar * createToolbar(QAction * action, const char * name, Qt::ToolBarAreas allowedAreas, Qt::ToolBarArea defaultArea);
 
 	QAction * undoAction;
+	QAction * orthogonalAction;
 
 protected:
 	GraphController * controller;
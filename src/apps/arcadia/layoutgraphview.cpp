@@ -43,6 +43,9 @@
 // local
 #include "graphloader.h"
 #include "graphlayout.h"
+#include "graphsnapshot.h"
+#include "connectorlayoutmanager.h"
+#include "connector.h"
 #include "vertexgraphics.h"
 #include "edgegraphics.h"
 #include "vertexproperty.h"
@@ -70,6 +73,14 @@ LayoutGraphView::LayoutGraphView(GraphController * c, unsigned int lNumber) :  G
 
 	QObject::connect(this, SIGNAL(selectionChanged()), this, SLOT(changeVertexSelection()));
 
+	// pointer moves during a drag get applied at most once per frame (60 Hz)
+	this->dragTimer.setSingleShot(true);
+	this->dragTimer.setInterval(16);
+	QObject::connect(&this->dragTimer, SIGNAL(timeout()), this, SLOT(applyDrag()));
+
+	// edge routes are computed in the background, and show up as they come
+	if (this->layout) QObject::connect(this->layout->getConnectorLayoutManager(), SIGNAL(connectorsRouted()), this, SLOT(updateRoutedEdges()));
+
 	this->setVisible(false);
 
 	this->display();
@@ -106,6 +117,7 @@ void LayoutGraphView::display()
 	this->containers.clear();
 	this->vertexToGraphics.clear();
 	this->connectorToGraphics.clear();
+	this->containerToGraphics.clear();
 	QList<QGraphicsItem *> list = this->items();
 	for (int i=0; i<list.size(); ++i)
 	{
@@ -113,10 +125,11 @@ void LayoutGraphView::display()
 		delete(list.at(i));
 	}
 	
-	// adding Vertices		
-	std::list<BGL_Vertex> vList = this->graphModel->getVertices();	
+	// adding Vertices (the model doesn't change while displaying)
+	const GraphSnapshot & graph = this->graphModel->getSnapshot();
+	GraphRange<BGL_Vertex> vList = graph.getVertices();	
 	
-	for (std::list<BGL_Vertex>::iterator it = vList.begin(); it != vList.end(); ++it)
+	for (GraphRange<BGL_Vertex>::iterator it = vList.begin(); it != vList.end(); ++it)
 	{	
 		this->displayVertex(*it);
 		if (this->vertices.size() > 4000) { this->supersize = true; break; }
@@ -125,9 +138,9 @@ void LayoutGraphView::display()
 	if (!this->supersize)
 	{
 		// adding Edges
-		std::list<BGL_Edge> eList = this->graphModel->getEdges();
+		GraphRange<BGL_Edge> eList = graph.getEdges();
 
-		for (std::list<BGL_Edge>::iterator it = eList.begin(); it != eList.end(); ++it)
+		for (GraphRange<BGL_Edge>::iterator it = eList.begin(); it != eList.end(); ++it)
 		{
 			this->displayEdge(*it);
 			if (this->edges.size() > 9000) { this->supersize = true; break; }
@@ -142,6 +155,7 @@ void LayoutGraphView::display()
 		this->containers.clear();
 		this->vertexToGraphics.clear();
 		this->connectorToGraphics.clear();
+		this->containerToGraphics.clear();
 		QList<QGraphicsItem *> list = this->items();
 		for (int i=0; i<list.size(); ++i)
 		{
@@ -156,34 +170,50 @@ void LayoutGraphView::display()
 
 	// let's not forget our containers!
 	this->displayContainerTree(this->layout->getRoot());
+
+	// the scene is up to date: what changed in the layout so far doesn't matter anymore (cf. refresh)
+	LayoutChanges changes;
+	this->layout->takeChanges(changes);
 	
 	// to layout edges
 	this->updateLayout(this->layout, true);
 }
 
-/***********************
-* displayContainerTree *
-************************
-* That recursive method adds the given container as a ContainerGraphics
+/*******************
+* displayContainer *
+********************
+* Adds the given container as a ContainerGraphics
 * [!] no styling!
-* then does the same again for every children that is a Container too
-* [!] detected through the id, a bit dodgy, ugly casting...? (getType?)
-***********************************************************************/
-void LayoutGraphView::displayContainerTree(ContainerContent *root)
+*************************************************/
+void LayoutGraphView::displayContainer(ContainerContent *c)
 {
-	std::string type = root->getTypeLabel(); 
-	// if (root->isHidden()) type = "GenericContainer"; // actually, it's upon painting that we decide what to do about the hidden parameter = hide the border but not the text
+	std::string type = c->getTypeLabel(); 
+	// if (c->isHidden()) type = "GenericContainer"; // actually, it's upon painting that we decide what to do about the hidden parameter = hide the border but not the text
 
 	ContainerStyle * cls = this->layout->getStyleSheet()->getContainerStyle(type);
 
-	ContainerGraphics * cg = new ContainerGraphics(root, cls);
+	ContainerGraphics * cg = new ContainerGraphics(c, cls);
 
 	this->addItem(cg);
 
 	this->containers.push_back(cg);
 
-	std::list< Content* > children = root->getChildren();
-	for (std::list< Content* >::iterator it = children.begin(); it != children.end(); ++it)
+	this->containerToGraphics[c] = cg;
+}
+
+/***********************
+* displayContainerTree *
+************************
+* That recursive method adds the given container as a ContainerGraphics
+* then does the same again for every children that is a Container too
+* [!] detected through the id, a bit dodgy, ugly casting...? (getType?)
+***********************************************************************/
+void LayoutGraphView::displayContainerTree(ContainerContent *root)
+{
+	this->displayContainer(root);
+
+	ContentRange children = root->getChildRange();
+	for (ContentRange::iterator it = children.begin(); it != children.end(); ++it)
 	{
 		Content * c = *it;
 		if (c->getId() != "") this->displayContainerTree((ContainerContent*)c);
@@ -195,7 +225,8 @@ void LayoutGraphView::displayContainerTree(ContainerContent *root)
 ******************
 * For this given layout, creates 3 files:
 * a pdf, ps and svg file
-* The scene is rendered in each format
+* The scene is rendered in each format, at full detail whatever the zoom
+* (rendering off screen, the items get no widget, cf. GraphGraphics)
 * [!] the SVG export of Qt is broken, labels don't appear
 *********************************************************/
 void LayoutGraphView::exportGraphics(std::string filename)
@@ -269,7 +300,7 @@ void LayoutGraphView::displayVertex(BGL_Vertex v)
 		CloneProperty cp;
 
 		if (clones.size() > 1) cp = isClone;
-		else if (clones.front()->getContainer()->getTypeLabel() == "CloneContainer") cp = isMidget;
+		else if (clones.front()->getContainer()->getType() == cloneContainer) cp = isMidget;
 		else cp = notClone;
 
 		// for reactions
@@ -301,16 +332,24 @@ void LayoutGraphView::displayVertex(BGL_Vertex v)
 *******************************************************************/
 void LayoutGraphView::displayEdge(BGL_Edge e)
 {
-	GraphLayout * graphLayout = this->layout;
-	
-	EdgeStyle *els = graphLayout->getStyleSheet()->getEdgeStyle(this->graphModel->getProperties(e));
-	
 	BGL_Vertex u = this->graphModel->getSource(e);
 	BGL_Vertex v = this->graphModel->getTarget(e);
 
-	Connector * c = graphLayout->getConnector(u, v, e);
+	Connector * c = this->layout->getConnector(u, v, e);
 	if (!c) return; // this can happen when displaying a neighbourhood layout
 
+	this->displayConnector(c);
+}
+
+/*******************
+* displayConnector *
+********************
+* Same as displayEdge, given the connector
+******************************************/
+void LayoutGraphView::displayConnector(Connector * c)
+{
+	EdgeStyle *els = this->layout->getStyleSheet()->getEdgeStyle(this->graphModel->getProperties(c->getEdge()));
+
 	EdgeGraphics* ei = new EdgeGraphics(this, c, els);
 
 	this->addItem(ei);
@@ -390,6 +429,22 @@ void PathwayScene::doubleClickNode(NodeView* node) {
 }
 */
 
+/********************
+* updateRoutedEdges *
+*********************
+* Called when the ConnectorLayoutManager has published a batch of routes
+* Only the EdgeGraphics of those connectors get updated
+*************************************************************************/
+void LayoutGraphView::updateRoutedEdges()
+{
+	std::list<Connector*> routed = this->layout->getConnectorLayoutManager()->getRoutedConnectors();
+	for (std::list<Connector*>::iterator it = routed.begin(); it != routed.end(); ++it)
+	{
+		EdgeGraphics * eg = this->getEdgeGraphics(*it);
+		if (eg) eg->updateRoute();
+	}
+}
+
 /************************
 * changeVertexSelection *
 *************************
@@ -429,21 +484,14 @@ void LayoutGraphView::changeVertexSelection()
 * First checks whether the scene is concerned by that update:
 * -1 (= global update), or the local layout number
 *
-* then we resets the display of the current model
-* [!] that's a bit of an overkill!
-* [!] we should just remove and re-add the concerned vertex
-* [!] + notify other items they should check their pos agains the model
-* [!] also what about clone styles???
+* then only the items of the clones, connectors and containers
+* that got created, destroyed or changed are dealt with (cf. refresh)
 ***********************************************************************/
 void LayoutGraphView::cloningGotToggled(BGL_Vertex v, GraphLayout * gl)
 {
 	if ((gl) && (gl != this->layout)) return;
 
-	this->display();
-	
-	this->update();
-
-	this->resize();
+	this->refresh();
 }
 
 // [!] we totally ignore the edge only bit...
@@ -451,73 +499,192 @@ void LayoutGraphView::layoutGotUpdated(GraphLayout * gl, bool edgesOnly, bool fa
 {
 	if ((gl) && (gl != this->layout)) return;
 	
-	if (!fast)
+	// only what moved, got routed or flipped since the last refresh gets updated
+	if (!fast) this->refresh();
+	
+	if (fast)
 	{
-		// updating edge position is only required when moving them non manually
-		// but the reaction orientation question is always on
-		for (std::list<VertexGraphics*>::iterator it = this->vertices.begin(); it != this->vertices.end(); ++it)
-		{
-			if (!edgesOnly)	(*it)->updatePos(); // but this is fast, anyway
-		
-			// to display reactions with the right style...
-			CloneContent * c = (*it)->getCloneContent();
-			BGL_Vertex v = c->getVertex();
-			std::list<CloneContent *> clones = this->layout->getClones(v);
+		this->updateDraggedEdges();
+		this->resize();
+	}
+}
+
+// the edges around the dragged vertices go straight, following their ends
+void LayoutGraphView::updateDraggedEdges()
+{
+	for (QSet<EdgeGraphics *>::iterator it = this->movingEdges.begin(); it != this->movingEdges.end(); ++it)
+	{
+		(*it)->quickTranslate();
+	}
+	for (QSet<EdgeGraphics *>::iterator it = this->stretchedEdges.begin(); it != this->stretchedEdges.end(); ++it)
+	{
+		(*it)->quickUpdate();
+	}	
 
-			if (clones.size() > 1) continue; // reactions cannot be cloned
+	this->update();
+}
 
-			CloneProperty cp = notClone;		
-			if (clones.front()->getContainer()->getTypeLabel() == "CloneContainer") cp = isMidget; // but they can be part of a clone container
+/**********
+* refresh *
+***********
+* Takes what changed in the layout since the last refresh (cf. GraphLayout::takeChanges)
+* and only updates the items concerned, so that the cost follows the size of the change:
+* the items of destroyed objects go first (their memory may hold new objects by now)
+* then the vertices whose clones changed get displayed again, new connectors and containers get added
+* Finally the moved or restyled vertices get updated, along with the edges around them,
+* the edges whose connector changed and the containers whose bounding box changed
+*******************************************************************************************************/
+void LayoutGraphView::refresh()
+{
+	LayoutChanges changes;
+	this->layout->takeChanges(changes);
 
-			if (clones.front()->rotated) cp = isRotated;
+	if (this->supersize) return; // nothing is displayed anyway
 
-			VertexStyle * vls = this->layout->getStyleSheet()->getVertexStyle(this->graphModel->getProperties(v), cp);
-		
-			(*it)->updateStyle(vls); // ideally I should only update reactions for which rotation has just changed
-		}
-	
-		// this takes a stupid lot of time, especially when selections are big
-		for (std::list<EdgeGraphics*>::iterator it = this->edges.begin(); it != this->edges.end(); ++it)
-		{
-			(*it)->updatePos();
-		}
+	// no selection signal while removing: the items left behind may belong to destroyed clones too
+	bool blocked = this->blockSignals(true);
 
-		// and the whole container thing takes lot of time too
-		for (std::list<ContainerGraphics*>::iterator it = this->containers.begin(); it != this->containers.end(); ++it)
-		{
-			(*it)->setUpdateFlag(); // notify all the containers that their data may be obsolete
-		}
+	for (std::set<Connector *>::iterator it = changes.removedConnectors.begin(); it != changes.removedConnectors.end(); ++it)
+	{
+		std::map<Connector *, EdgeGraphics *>::iterator ig = this->connectorToGraphics.find(*it);
+		if (ig == this->connectorToGraphics.end()) continue;
+
+		EdgeGraphics * eg = ig->second;
+		this->removeItem(eg);
+		this->edges.remove(eg);
+		this->connectorToGraphics.erase(ig);
+		delete eg;
+	}
+
+	for (std::set<ContainerContent *>::iterator it = changes.removedContainers.begin(); it != changes.removedContainers.end(); ++it)
+	{
+		std::map<ContainerContent *, ContainerGraphics *>::iterator ig = this->containerToGraphics.find(*it);
+		if (ig == this->containerToGraphics.end()) continue;
+
+		ContainerGraphics * cg = ig->second;
+		this->removeItem(cg);
+		this->containers.remove(cg);
+		this->containerToGraphics.erase(ig);
+		delete cg;
+	}
+
+	for (std::set<BGL_Vertex>::iterator it = changes.remappedVertices.begin(); it != changes.remappedVertices.end(); ++it)
+	{
+		this->removeVertex(*it);
+	}
+
+	this->blockSignals(blocked);
+
+	// new items
+	for (std::set<BGL_Vertex>::iterator it = changes.remappedVertices.begin(); it != changes.remappedVertices.end(); ++it)
+	{
+		this->displayVertex(*it);
+	}
+
+	for (std::set<ContainerContent *>::iterator it = changes.addedContainers.begin(); it != changes.addedContainers.end(); ++it)
+	{
+		this->displayContainer(*it);
+	}
 
-		for (std::list<ContainerGraphics*>::iterator it = this->containers.begin(); it != this->containers.end(); ++it)
+	for (std::set<Connector *>::iterator it = changes.addedConnectors.begin(); it != changes.addedConnectors.end(); ++it)
+	{
+		this->displayConnector(*it);
+	}
+
+	// restyled vertices (reactions that flipped, clones that changed container)
+	for (std::set<CloneContent *>::iterator it = changes.restyledClones.begin(); it != changes.restyledClones.end(); ++it)
+	{
+		VertexGraphics * vg = this->getVertexGraphics(*it);
+		if (vg) vg->updateStyle(this->getCloneStyle(*it));
+	}
+
+	// the edges around them, and around the vertices displayed again
+	std::set<EdgeGraphics *> reshaped; // the shape of their ends changed, or their route
+	std::set<EdgeGraphics *> stretched; // their ends may have moved
+
+	for (std::set<BGL_Vertex>::iterator it = changes.remappedVertices.begin(); it != changes.remappedVertices.end(); ++it)
+	{
+		CloneRange clones = this->layout->getCloneRange(*it);
+		for (CloneRange::iterator ic = clones.begin(); ic != clones.end(); ++ic)
 		{
-			(*it)->updatePos(); // gets the new pos for the containers (the data is only updated once per container)
+			changes.restyledClones.insert(*ic);
 		}
-		
-		// and so does that bit, to some extent?
-		this->update();
-		this->resize();
 	}
-	
-	if (fast)
+	for (std::set<CloneContent *>::iterator it = changes.restyledClones.begin(); it != changes.restyledClones.end(); ++it)
 	{
-		for (std::list<EdgeGraphics *>::iterator it = inList.begin(); it != inList.end(); ++it)
+		std::list<Connector *> connectors = (*it)->getOutterConnectors();
+		for (std::list<Connector *>::iterator ic = connectors.begin(); ic != connectors.end(); ++ic)
 		{
-			(*it)->quickTranslate();
+			EdgeGraphics * eg = this->getEdgeGraphics(*ic);
+			if (eg) reshaped.insert(eg);
 		}
-		for (std::list<EdgeGraphics *>::iterator it = outList.begin(); it != outList.end(); ++it)
+	}
+
+	// moved vertices, and the edges around them
+	for (std::set<CloneContent *>::iterator it = changes.movedClones.begin(); it != changes.movedClones.end(); ++it)
+	{
+		VertexGraphics * vg = this->getVertexGraphics(*it);
+		if (vg) vg->updatePos();
+
+		std::list<Connector *> connectors = (*it)->getOutterConnectors();
+		for (std::list<Connector *>::iterator ic = connectors.begin(); ic != connectors.end(); ++ic)
 		{
-			(*it)->quickUpdate();
-		}	
+			EdgeGraphics * eg = this->getEdgeGraphics(*ic);
+			if (eg) stretched.insert(eg);
+		}
+	}
 
-		this->update();
-		this->resize();
+	// edges whose connector changed (new points, new ends)
+	for (std::set<Connector *>::iterator it = changes.changedConnectors.begin(); it != changes.changedConnectors.end(); ++it)
+	{
+		EdgeGraphics * eg = this->getEdgeGraphics(*it);
+		if (eg) reshaped.insert(eg);
+	}
+
+	for (std::set<EdgeGraphics *>::iterator it = reshaped.begin(); it != reshaped.end(); ++it)
+	{
+		(*it)->updateRoute();
+		stretched.erase(*it);
 	}
+	for (std::set<EdgeGraphics *>::iterator it = stretched.begin(); it != stretched.end(); ++it)
+	{
+		(*it)->updatePos();
+	}
+
+	// the containers whose content changed got flagged along the way (cf. ContainerContent::setUpdateFlag)
+	for (std::set<ContainerContent *>::iterator it = changes.changedContainers.begin(); it != changes.changedContainers.end(); ++it)
+	{
+		std::map<ContainerContent *, ContainerGraphics *>::iterator ig = this->containerToGraphics.find(*it);
+		if (ig != this->containerToGraphics.end()) ig->second->updatePos(); // the data is only updated once per container
+	}
+
+	this->update();
+	this->resize();
+}
+
+/****************
+* getCloneStyle *
+*****************
+* The style of a single clone, as in displayVertex:
+* from its vertex, whether that vertex is cloned, the container of the clone
+* (clones in a clone container look smaller) and its orientation (for reactions)
+*********************************************************************************/
+VertexStyle * LayoutGraphView::getCloneStyle(CloneContent * c)
+{
+	CloneProperty cp = notClone;
+
+	if (this->layout->getCloneRange(c->getVertex()).size() > 1) cp = isClone;
+	else if (c->getContainer()->getType() == cloneContainer) cp = isMidget;
+
+	// for reactions
+	if (c->rotated) cp = isRotated;
+
+	return this->layout->getStyleSheet()->getVertexStyle(this->graphModel->getProperties(c->getVertex()), cp);
 }
 
 /***************
 * removeVertex *
 ****************
-* [!] Currently not really used
 * Removes and deletes ([!]overkill?)
 * all the VertexGraphics mapped to a Vertex
 * and removes the reference to them in the map too
@@ -535,8 +702,6 @@ void LayoutGraphView::removeVertex(BGL_Vertex v)
 	this->vertexToGraphics.erase(v);
 }
 
-#include "connector.h"
-
 // Mouse Events: cf. manual placement
 // [!] maybe I only need one state variable = moving
 // [!] would it be possible to define a new temporary container tree in which the moving items would be layed out?
@@ -585,11 +750,8 @@ void LayoutGraphView::mouseMoveEvent (QGraphicsSceneMouseEvent * event ) {
 		// Edges between moving nodes just need to be translated
 		// While edges between static and moving nodes need to be more fully updated
 		// Other edges are unaffected by a fast update
-		this->inList.clear();
-		this->outList.clear();
-
-		this->getLayout()->inList.clear();
-		this->getLayout()->outList.clear();
+		this->movingEdges.clear();
+		this->stretchedEdges.clear();
 
 		// The edge lists are based on selected items
 		QList<QGraphicsItem *> list = this->selectedItems();
@@ -613,33 +775,55 @@ void LayoutGraphView::mouseMoveEvent (QGraphicsSceneMouseEvent * event ) {
 					}
 					else
 					{
-						// if the edge is not already in our list, then it is an edge between a static node and a moving node
-						if (std::find(outList.begin(), outList.end(), eg) == outList.end())
-						{
-							outList.push_back(eg);
-							this->getLayout()->outList.push_back(*it);
-						}
-						else // if it is already in the list, it is an edge between two moving nodes, and should switch list
-						{
-							outList.remove(eg);
-							inList.push_back(eg);
-							this->getLayout()->outList.remove(*it);
-							this->getLayout()->inList.push_back(*it);
-						}
+						// if the edge is not already in our set, then it is an edge between a static node and a moving node
+						// if it is already in the set, it is an edge between two moving nodes, and should switch set
+						if (this->stretchedEdges.remove(eg)) this->movingEdges.insert(eg);
+						else this->stretchedEdges.insert(eg);
 					}
 				}
 			}
 		}
+
+		// the layout quickly updates the same connectors
+		this->getLayout()->inList.clear();
+		this->getLayout()->outList.clear();
+		for (QSet<EdgeGraphics *>::iterator it = this->movingEdges.begin(); it != this->movingEdges.end(); ++it)
+		{
+			this->getLayout()->inList.push_back((*it)->getConnector());
+		}
+		for (QSet<EdgeGraphics *>::iterator it = this->stretchedEdges.begin(); it != this->stretchedEdges.end(); ++it)
+		{
+			this->getLayout()->outList.push_back((*it)->getConnector());
+		}
 	}
 	
 	// If things have moved, we update the position of nodes in the layout object, then quickly update the position of edges based on this information
-	// The layout update triggers a call to layoutgotupdated = the view is refreshed (fast version)
-	// [!] To be honest, there is no need to update the layout objects at that stage... I could deal with everything internally in the canvas! (calling directly the appropriate egde router if need be)
-	if (this->moved)
-	{	
-		this->updateMovingVertices();
-		this->updateLayout(this->layout, true, true);
-	}	
+	// This is done at most once per frame, however many moves the mouse sends (cf. applyDrag)
+	if (this->moved && !this->dragTimer.isActive()) this->dragTimer.start();
+}
+
+/************
+* applyDrag *
+*************
+* Applies the pointer moves of a drag since the last frame:
+* the clones get the new position of their vertices, then the connectors and edges
+* around them go straight, following their ends
+* This stays within the scene (no layout update through the controller,
+* no other view to notify): the full update waits for the mouse release
+*************************************************************************************/
+void LayoutGraphView::applyDrag()
+{
+	if (!this->moved) return;
+
+	this->updateMovingVertices();
+	this->layout->quickUpdate();
+	this->updateDraggedEdges();
+
+	// the scene only needs to grow if the selection got out of it
+	QRectF r;
+	QList<QGraphicsItem *> list = this->selectedItems();
+	for (int i = 0; i < list.size(); ++i) r |= list.at(i)->sceneBoundingRect();
+	if (!this->sceneRect().contains(r)) this->resize();
 }
 
 void LayoutGraphView::mouseReleaseEvent (QGraphicsSceneMouseEvent * event ) 
@@ -660,9 +844,12 @@ void LayoutGraphView::mouseReleaseEvent (QGraphicsSceneMouseEvent * event )
 		// we go back to normal edge avoiding mode now that manual movement has stopped
 		this->layout->setAvoiding(this->saveAvoidingValue);
 	
+		// the moves not applied yet get applied by the full update below
+		this->dragTimer.stop();
+
 		// [!] suboptimal? Maybe I should only update these when the selection actually changes? (as I am losing all the information on edges around the selection...)
-		this->inList.clear();
-		this->outList.clear();
+		this->movingEdges.clear();
+		this->stretchedEdges.clear();
 
 		this->getLayout()->inList.clear();
 		this->getLayout()->outList.clear();
@@ -36,6 +36,10 @@
 // Qt base class
 #include <QGraphicsScene>
 
+// Qt
+#include <QSet>
+#include <QTimer>
+
 // STL
 #include <map>
 #include <list>
@@ -50,6 +54,7 @@ class ContainerGraphics;
 class CloneContent;
 class ContainerContent;
 class Connector;
+class VertexStyle;
 
 /*************
 * LayoutGraphView *
@@ -71,11 +76,15 @@ class Connector;
 *
 * Specific methods let display a Vertex, Edge and Container tree
 * as well as remove a Vertex
-* [!] not used ATM, the entire view is reset when, eg, cloning happens
+* Once displayed, the scene follows what changes in the layout (cf. refresh):
+* only the items concerned get added, removed or updated
 *
 * Specific action is undertaken (sending signals to the Controller)
 * when the selection changes or a double click is observed
-**********************************************************************/
+*
+* Dragging vertices around only updates the clones and edges once per frame
+* (cf. applyDrag), the full update of the layout waits for the mouse release
+******************************************************************************/
 class LayoutGraphView : public QGraphicsScene, public GraphView
 {
 	Q_OBJECT
@@ -118,17 +127,24 @@ protected:
 
 private slots:
 	void changeVertexSelection();
+	void updateRoutedEdges();
+	void applyDrag();
 	
 private:
 	bool supersize;
 
 	void displayVertex(BGL_Vertex v);
 	void displayEdge(BGL_Edge e);
+	void displayConnector(Connector * c);
+	void displayContainer(ContainerContent * c);
 	void displayContainerTree(ContainerContent *c);
 	
 	void removeVertex(BGL_Vertex v);
+	void refresh();
+	VertexStyle * getCloneStyle(CloneContent * c);
 	
 	void resize();
+	void updateDraggedEdges();
 
 	GraphLayout * layout;
 	
@@ -138,8 +154,10 @@ private:
 	std::map<BGL_Vertex, std::list<VertexGraphics*> > vertexToGraphics;
 
 	std::map<Connector *, EdgeGraphics * > connectorToGraphics;
-	std::list<EdgeGraphics *> inList;
-	std::list<EdgeGraphics *> outList;
+	std::map<ContainerContent *, ContainerGraphics * > containerToGraphics;
+	QSet<EdgeGraphics *> movingEdges; // between two dragged vertices: just translated
+	QSet<EdgeGraphics *> stretchedEdges; // between a dragged vertex and a static one
+	QTimer dragTimer;
 	
 	bool mouseDown;
 	bool moving;
@@ -0,0 +1,126 @@
+/***********************************************************************
+*
+*  Arcadia is a visualisation tool for metabolic pathways
+*
+*  This file is part of the arcadia1.0 application distribution
+*  Copyright (C) 2007-2009 Alice Villeger, University of Manchester
+*  <alice.villeger@manchester.ac.uk>
+*
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*************************************************************************/
+
+/*
+ *  LayoutPool.cpp
+ *  arcadia
+ *
+ */
+
+#include "layoutpool.h"
+
+#include <new>
+
+/*************************
+* LayoutSpares destructor *
+***************************
+* The spare blocks die with their GraphModel
+**********************************************/
+LayoutSpares::~LayoutSpares()
+{
+	for (std::vector<char *>::iterator it = this->blocks.begin(); it != this->blocks.end(); ++it)
+		::operator delete(*it);
+}
+
+/***************************
+* Constructor / Destructor *
+*****************************
+* The first block only gets allocated with the first object
+* The blocks are all released along with the pool
+* (kept aside for the next layout of the model, up to LayoutSpares::MaxBlocks)
+*******************************************************************************/
+LayoutPool::LayoutPool(LayoutSpares & s) : spares(s), current(NULL), available(0) {}
+
+LayoutPool::~LayoutPool()
+{
+	for (std::vector<char *>::iterator it = this->blocks.begin(); it != this->blocks.end(); ++it)
+	{
+		if (this->spares.blocks.size() < LayoutSpares::MaxBlocks) this->spares.blocks.push_back(*it);
+		else ::operator delete(*it);
+	}
+}
+
+/***********
+* allocate *
+************
+* Recycles a deleted chunk of the same size if there is one,
+* or else carves a new chunk at the end of the last block (after a new block, if full)
+* Objects too large for a block get their own allocation, outside of the pool
+****************************************************************************************/
+void * LayoutPool::allocate(std::size_t size)
+{
+	std::size_t slot = (sizeof(Header) + size + Grain - 1) / Grain;
+	std::size_t chunk = slot * Grain;
+
+	Header * h;
+	if (chunk > BlockSize / 4)
+	{
+		h = (Header *) ::operator new(chunk);
+		h->pool = NULL;
+	}
+	else
+	{
+		if (slot >= this->freeChunks.size()) this->freeChunks.resize(slot + 1, NULL);
+
+		if (void * recycled = this->freeChunks[slot])
+		{
+			this->freeChunks[slot] = *(void **) recycled; // the next free chunk is stored in the chunk itself
+			h = (Header *) recycled;
+		}
+		else
+		{
+			if (chunk > this->available)
+			{
+				if (this->spares.blocks.empty()) this->current = (char *) ::operator new(BlockSize);
+				else { this->current = this->spares.blocks.back(); this->spares.blocks.pop_back(); }
+				this->available = BlockSize;
+				this->blocks.push_back(this->current);
+			}
+			h = (Header *) this->current;
+			this->current += chunk;
+			this->available -= chunk;
+		}
+		h->pool = this;
+	}
+	h->slot = slot;
+
+	return h + 1;
+}
+
+/**********
+* release *
+***********
+* Gives a chunk back to the pool it came from, for the next object of that size
+* (the chunks allocated outside of the pool are simply freed)
+*********************************************************************************/
+void LayoutPool::release(void * p)
+{
+	if (!p) return;
+
+	Header * h = ((Header *) p) - 1;
+	LayoutPool * pool = h->pool;
+	if (!pool) { ::operator delete(h); return; }
+
+	*(void **) h = pool->freeChunks[h->slot];
+	pool->freeChunks[h->slot] = h;
+}
@@ -0,0 +1,105 @@
+/***********************************************************************
+*
+*  Arcadia is a visualisation tool for metabolic pathways
+*
+*  This file is part of the arcadia1.0 application distribution
+*  Copyright (C) 2007-2009 Alice Villeger, University of Manchester
+*  <alice.villeger@manchester.ac.uk>
+*
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*************************************************************************/
+
+/*
+ *  LayoutPool.h
+ *  arcadia
+ *
+ */
+
+#ifndef LAYOUTPOOL_H
+#define LAYOUTPOOL_H
+
+// STL
+#include <cstddef>
+#include <vector>
+
+/***************
+* LayoutSpares *
+****************
+* The blocks of the layouts that got deleted, kept for the next layouts of the same GraphModel
+* (each model owns one, so the blocks are freed along with the model)
+* Only a few blocks are kept: the others are freed with their pool
+***********************************************************************************************/
+class LayoutSpares
+{
+public:
+	LayoutSpares() {}
+	~LayoutSpares();
+
+private:
+	friend class LayoutPool;
+
+	static const std::size_t MaxBlocks = 4;
+
+	std::vector<char *> blocks;
+
+	// not copyable
+	LayoutSpares(const LayoutSpares &);
+	LayoutSpares & operator=(const LayoutSpares &);
+};
+
+/*************
+* LayoutPool *
+**************
+* The memory of the objects owned by a GraphLayout (Contents and Connectors)
+* Instead of one heap allocation per object, objects are carved out of large blocks,
+* and the ones that get deleted (eg when cloning) are recycled for objects of the same size
+* Each chunk starts with a small header pointing at its pool, so that release
+* (called by the class specific operator delete) doesn't need to know the layout
+*
+* When the pool dies (along with its layout), the blocks are released all at once
+* (a few of them go to the spares of the model, for its next layout):
+* the objects themselves must have been deleted before (the layout deletes its root)
+* [!] not thread safe: layout objects (and layouts) are only created and deleted from the main thread
+*******************************************************************************************/
+class LayoutPool
+{
+public:
+	LayoutPool(LayoutSpares & s);
+	~LayoutPool();
+
+	void * allocate(std::size_t size);
+	static void release(void * p);
+
+	std::size_t getBlockCount() { return this->blocks.size(); }
+
+private:
+	struct Header { LayoutPool * pool; std::size_t slot; }; // slot: chunk size, in Grain units
+
+	static const std::size_t Grain = 16;
+	static const std::size_t BlockSize = 64 * 1024;
+
+	LayoutSpares & spares;
+	std::vector<char *> blocks;
+	char * current; // free space at the end of the last block
+	std::size_t available;
+
+	std::vector<void *> freeChunks; // for each slot, a linked list of recycled chunks
+
+	// not copyable
+	LayoutPool(const LayoutPool &);
+	LayoutPool & operator=(const LayoutPool &);
+};
+
+#endif
@@ -48,6 +48,7 @@
 #include "graphcontroller.h"
 
 #include "graphlayout.h"
+#include "graphsnapshot.h"
 
 #include <iostream>
 
@@ -229,7 +230,7 @@ void ListGraphView::addVertex(BGL_Vertex v)
 	
 	vertex->setText(1, instanceLabel.c_str());
 	
-	int connectivity = this->graphModel->getEdges(v).size();
+	int connectivity = this->graphModel->getSnapshot().getEdges(v).size();
 	char buf[8];
 	if (connectivity > 999)
 		sprintf(buf, " %d", connectivity);
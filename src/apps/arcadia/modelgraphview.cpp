@@ -222,6 +222,21 @@ void ModelGraphView::sceneSwitched(int scene)
 	}
 }
 
+/*******************
+* layoutGotUpdated *
+********************
+* The edge routing may have been toggled: the toolbars follow
+*************************************************************/
+void ModelGraphView::layoutGotUpdated(GraphLayout * gl, bool edgesOnly, bool fast)
+{
+	if (fast) return;
+	for (int i = 0; i < this->tabWidget->count(); ++i)
+	{
+		TabbedWidget * tw = (TabbedWidget *)(this->tabWidget->widget(i));
+		if (tw) tw->updateEdgeActions();
+	}
+}
+
 void ModelGraphView::layoutGotAdded()
 {
 	this->displayLayout(this->graphModel->layoutNumber() - 1);
@@ -305,6 +320,15 @@ TabbedWidget::TabbedWidget(QWidget * parent, bool zoomEnabled): QWidget(parent),
 	action->setCheckable(true);
 	action->setChecked(false);
 	toolBar->addAction(action);
+	this->avoidingAction = action;
+
+	action = this->createAction("&Orthogonal Edges", "Ctrl+Shift+R", "Toggles orthogonal edge routing (horizontal and vertical segments only) on the current view, once Route Edges is on");
+	QObject::connect(action, SIGNAL( triggered() ), this, SLOT( toggleOrthogonalEdges() ));
+	action->setCheckable(true);
+	action->setChecked(false);
+	action->setEnabled(false);
+	toolBar->addAction(action);
+	this->orthogonalAction = action;
 
 	toolBar->addSeparator();
 
@@ -460,6 +484,13 @@ QAction * TabbedWidget::createAction(const char * name, const char * shortCut, c
 void TabbedWidget::toggleAvoidingEdges()
 {
 	this->scene->getController()->toggleAvoidingEdges();
+	this->updateEdgeActions(); // in case the controller was busy
+}
+
+void TabbedWidget::toggleOrthogonalEdges()
+{
+	this->scene->getController()->toggleOrthogonalEdges();
+	this->updateEdgeActions(); // in case the controller was busy
 }
 
 /*****************
@@ -545,6 +576,22 @@ void TabbedWidget::setScene(GraphController * c, int l)
 	this->scene->update();
 
 	QObject::connect(this->scene, SIGNAL(newCenter(QPointF)), this, SLOT(changeCenter(QPointF)));
+
+	this->updateEdgeActions();
+}
+
+/********************
+* updateEdgeActions *
+*********************
+* The edge routing of the layout can also be toggled from the main window menu:
+* the toolbar shows its current state (orthogonal routing only makes sense once edges are routed)
+***************************************************************************************************/
+void TabbedWidget::updateEdgeActions()
+{
+	GraphLayout * layout = this->scene? this->scene->getLayout(): NULL;
+	this->avoidingAction->setChecked(layout && layout->isAvoiding());
+	this->orthogonalAction->setChecked(layout && layout->isOrthogonal());
+	this->orthogonalAction->setEnabled(layout && layout->isAvoiding());
 }
 
 TabbedWidget::~TabbedWidget()
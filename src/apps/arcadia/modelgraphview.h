@@ -107,6 +107,7 @@ public:
 	
 	void exportGraphics(std::string filename);
 	
+	void layoutGotUpdated(GraphLayout * gl, bool edgesOnly, bool fast);
 	void layoutGotAdded();
 	void layoutGotRemoved(GraphLayout * gl);
 	void selectLayout(GraphLayout * gl);
@@ -141,6 +142,7 @@ public:
 	void setScene(GraphController * c, int l);
 	LayoutGraphView * getScene() { return this->scene; }
 	MapView * getView() { return this->mapView; }
+	void updateEdgeActions();
 
 private slots:
     void zoomIn();
@@ -150,6 +152,7 @@ private slots:
 	void changeCenter(QPointF p);
 
 	void toggleAvoidingEdges();
+	void toggleOrthogonalEdges();
 	void destroyLayout();
 	void updateLayout();
 	void cloneModifiers();
@@ -171,6 +174,8 @@ private:
     MapView * mapView;
     QSlider * zoomSlider;
 	LayoutGraphView * scene;
+	QAction * avoidingAction;
+	QAction * orthogonalAction;
 	
 	QAction * createAction(const char * name, const char * shortCut, const char * tip);
 };
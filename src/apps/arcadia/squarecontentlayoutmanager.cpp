@@ -46,10 +46,10 @@
 ******************************************/
 void SquareContentLayoutManager::layout(ContainerContent *container)
 {
-	std::list< Content* > cList = container->getChildren();
+	ContentRange cList = container->getChildRange();
 	int count = 0;	
 	int total = sqrt(cList.size()+1);
-	for (std::list< Content* >::iterator it = cList.begin(); it != cList.end(); ++it)
+	for (ContentRange::iterator it = cList.begin(); it != cList.end(); ++it)
 	{
 		(*it)->setPosition((count%total)*100, (count/total)*100);
 		++count;
@@ -36,6 +36,9 @@
 
 #include <math.h>
 
+// STL
+#include <map>
+
 // Qt
 #include <QPainter>
 #include <QStyleOptionGraphicsItem>
@@ -53,17 +56,16 @@
 * Initialises the CloneContent
 * Defines the Item as Selectable 
 *
-* Sets up the style and the label (possibly default values)
-* and consequently computes the shapes and rectangle
+* Sets up the label and the style (possibly default values)
+* and consequently gets the shapes and rectangle
 *
 * Sets up the Item pos to the Clone's position
 * [!] ATM I never update these!! no good if the Clone moves
 ***********************************************************/
-VertexGraphics::VertexGraphics( LayoutGraphView *gs, CloneContent * c, std::string l, VertexStyle *s) : graphScene(gs), cloneDescriptor(c), label("") {
+VertexGraphics::VertexGraphics( LayoutGraphView *gs, CloneContent * c, std::string l, VertexStyle *s) : graphScene(gs), cloneDescriptor(c), label(l), geometry(NULL) {
 	this->setFlags(QGraphicsItem::ItemIsSelectable|QGraphicsItem::ItemIsMovable);
 
 	this->setStyle(s);
-	this->setLabel(l);
 	
 	this->setPosition();
 }
@@ -76,30 +78,30 @@ CloneContent * VertexGraphics::getCloneContent() { return this->cloneDescriptor;
 /************************************************
 * boundingRect: returns the style-computed rect *
 *************************************************/
-QRectF VertexGraphics::boundingRect() const { return this->boundingRectangle; }
+QRectF VertexGraphics::boundingRect() const { return this->geometry->boundingRectangle; }
 /******************************************
 * shape: returns the style-computed shape *
 *******************************************/
-QPainterPath VertexGraphics::shape() const { return this->boundingShape; }
+QPainterPath VertexGraphics::shape() const { return this->geometry->boundingShape; }
 	
 /********
 * paint *
 *********
-* Sets up the Z Value
-* then lets the style do the painting
+* Lets the style do the painting
 * according to the paintingShape, label
-* level of detail, and selection status
-***************************************/
+* level of detail, and selection status:
+* fill only in overview, outline only when zoomed out,
+* antialiased shape, then its label, when closer
+* (the Z Value follows the selection, cf. itemChange)
+*********************************************************/
 void VertexGraphics::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) {
 	bool isSelected = this->isSelected();
 	bool isToPrint = true;
 
-	this->setZValue( this->style->getZValue( isSelected ) );
-	
-	QPainterPath shape = this->paintingShape;
-	const std::string text = this->label;
-	float zoom = option->levelOfDetail;
-	zoom = 1; // to test the SVG rendering
+	const QPainterPath & shape = this->geometry->paintingShape;
+	const QRectF & rect = this->geometry->paintingRectangle;
+	const std::string & text = this->label;
+	DetailLevel detail = GraphGraphics::GetDetailLevel(option, widget);
 
 	painter->setRenderHint(QPainter::Antialiasing, false);
 
@@ -125,7 +127,7 @@ void VertexGraphics::paint(QPainter *painter, const QStyleOptionGraphicsItem *op
 	if (isSelected || isToPrint)	fillColor = fillColor.light(180);
 	else							fillColor.setHsv(fillColor.hue(), fillColor.saturation()/2, fillColor.value()*0.8);
 
-	if (zoom < 1./8) { painter->fillPath(shape, fillColor); return; }
+	if (detail == overviewDetail) { painter->fillRect(rect, fillColor); return; }
 
 	QColor lineColor = baseColor;
 	if (isSelected || isToPrint)	lineColor = lineColor.dark(180);
@@ -141,15 +143,17 @@ void VertexGraphics::paint(QPainter *painter, const QStyleOptionGraphicsItem *op
 	if (this->style->getIsMidget()) p.setWidth(p.width()/2);
 	painter->setPen(p);
 	
-    if (zoom < 1./4)	{ painter->drawPath(shape); return; }
+	if (detail == outlineDetail)	{ painter->drawPath(shape); return; }
 
 	painter->setRenderHint(QPainter::Antialiasing, true);
 	painter->drawPath(shape);
 
+	if (detail == shapeDetail) return;
+
 	p.setColor(isSelected||isToPrint? Qt::black: baseColor.dark(270));
 	painter->setPen(p);
     painter->setFont(this->font); // [!] find a way to store font info in the style???
-	if (this->style->getShowLabel()) painter->drawText( shape.boundingRect(), Qt::AlignCenter, text.c_str()); 
+	if (this->style->getShowLabel()) painter->drawText( rect, Qt::AlignCenter, text.c_str()); 
 }
 
 /***********
@@ -157,11 +161,12 @@ void VertexGraphics::paint(QPainter *painter, const QStyleOptionGraphicsItem *op
 ************
 * Changes the current style
 * If none is given, a default style is used
-* The shapes and rect get updated
+* The shapes, rect and Z Value get updated
 *******************************************/
 void VertexGraphics::setStyle(VertexStyle *s) {
 	this->style = s? s: VertexStyle::GetDefaultStyle();	
 	this->updateShapesAndRect();
+	this->setZValue( this->style->getZValue( this->isSelected() ) );
 }
 
 /***********
@@ -179,40 +184,61 @@ void VertexGraphics::setLabel(std::string l) {
 * updateShapesAndRect *
 ***********************
 * Picks up a default Style if none exists
-* Otherwise, lets the Style compute from the Label
+* Otherwise, gets from the Style and Label
 * the boundingRectangle, boundingShape and paintingShape
 ********************************************************/
 void VertexGraphics::updateShapesAndRect() {
 	if (!this->style) { this->setStyle(NULL); return; }
-	this->boundingRectangle = this->getBoundingRect(this->label);
-	this->boundingShape = this->getBoundingShape(this->label);
-	this->paintingShape = this->getPaintingShape(this->label);
+	this->geometry = VertexGraphics::GetGeometry(this->style, this->label, this->font);
 }
 
-QRectF VertexGraphics::getBoundingRect(const std::string text) const
+/**************
+* GetGeometry *
+***************
+* Thousands of Items share a handful of styles, and many labels repeat (clones, ATP, H2O...)
+* so the shapes and rectangles are computed once per style, label and font, then shared
+* The styles are never destroyed (cf. GetDefaultStyle), they can be told apart by address
+* [!] the cache is never emptied: it grows with the number of distinct labels
+**********************************************************************************************/
+struct GeometryKey
 {
-	return this->getRect(text, this->style->getBoundingOffset());
-}
+	VertexStyle * style;
+	std::string text;
+	QFont font;
 
-QPainterPath VertexGraphics::getBoundingShape(const std::string text) const
-{
-	return this->getShape(this->getBoundingRect(text));
-}
+	bool operator<(const GeometryKey & k) const
+	{
+		if (this->style != k.style) return this->style < k.style;
+		if (this->text != k.text) return this->text < k.text;
+		return this->font < k.font;
+	}
+};
 
-QPainterPath VertexGraphics::getPaintingShape(const std::string text) const
+const VertexGraphics::Geometry * VertexGraphics::GetGeometry(VertexStyle * s, const std::string & text, const QFont & f)
 {
-	return this->getShape(this->getRect(text, this->style->getPaintingOffset()));
+	static std::map<GeometryKey, Geometry> Cache;
+
+	GeometryKey key = { s, text, f };
+	std::map<GeometryKey, Geometry>::iterator it = Cache.find(key);
+	if (it != Cache.end()) return &it->second;
+
+	Geometry & g = Cache[key];
+	g.boundingRectangle = VertexGraphics::GetRect(s, text, f, s->getBoundingOffset());
+	g.boundingShape = VertexGraphics::GetShape(s, g.boundingRectangle);
+	g.paintingShape = VertexGraphics::GetShape(s, VertexGraphics::GetRect(s, text, f, s->getPaintingOffset()));
+	g.paintingRectangle = g.paintingShape.boundingRect();
+	return &g;
 }
 
-QRectF VertexGraphics::getRect(const std::string text, int offset) const
+QRectF VertexGraphics::GetRect(VertexStyle * s, const std::string & text, const QFont & f, int offset)
 {
-	QFontMetricsF fm(this->font); 
+	QFontMetricsF fm(f); 
 	QRectF r;
-	if (this->style->getShowLabel())	r = fm.boundingRect(text.c_str());	
+	if (s->getShowLabel())	r = fm.boundingRect(text.c_str());	
 
 	r.setWidth(r.width() + offset);
 	r.setHeight(r.height() + offset);
-	if (this->style->getShape() == circular || this->style->getShape() == underlinedCircular)
+	if (s->getShape() == circular || s->getShape() == underlinedCircular)
 	{
 		r.setHeight(r.width());
 	}
@@ -222,7 +248,7 @@ QRectF VertexGraphics::getRect(const std::string text, int offset) const
 	return r;
 }
 
-QPainterPath VertexGraphics::getShape(const QRectF r) const
+QPainterPath VertexGraphics::GetShape(VertexStyle * s, const QRectF r)
 {
 	QRectF myRect;
 	myRect.setWidth(r.width() - 10);
@@ -237,7 +263,7 @@ QPainterPath VertexGraphics::getShape(const QRectF r) const
 
 	QPainterPath path;
 	path.setFillRule(Qt::WindingFill);
-	switch(this->style->getShape())
+	switch(s->getShape())
 	{
 	case circular: // the rectangle given is always a square
 	case ellipse:
@@ -513,8 +539,13 @@ void VertexGraphics::updateStyle(VertexStyle * s)
 	this->setStyle(s);
 }
 
-// [!] doesn't do anything ATM
+// only keeps the Z Value in line with the selection status, ATM
 QVariant VertexGraphics::itemChange(GraphicsItemChange change, const QVariant &value) {
+	if (change == QGraphicsItem::ItemSelectedHasChanged)
+	{
+		this->setZValue( this->style->getZValue( value.toBool() ) );
+	}
+
 	if (change == QGraphicsItem::ItemPositionHasChanged)
 	{
 //		this->graphScene->updateMovingVertices();
@@ -38,6 +38,9 @@
 
 #include <QFont>
 
+// STL
+#include <string>
+
 // local
 class VertexStyle;
 class CloneContent;
@@ -54,6 +57,8 @@ class LayoutGraphView;
 * to determine the Item's exact dimensions, and from there update
 * the paintingShape, a boundingRect, and a boundingShape
 * (respectively used in the paint, boundingRect and shape methods)
+* These only depend on the style, label and font: all the Items sharing them
+* share a single Geometry (cf. GetGeometry), whatever their layout
 *
 * The Clone's position is used to update the Item's pos
 * [!] only upon creation, ATM! could be done in the paint method too? 
@@ -87,21 +92,24 @@ private:
 	VertexStyle * style;
 	CloneContent *cloneDescriptor;	
 	std::string label;
-	
-	QRectF boundingRectangle;
-	QPainterPath boundingShape;
-	QPainterPath paintingShape;
+
+	// The dimensions of the Item, computed once for a given style, label and font
+	struct Geometry
+	{
+		QRectF boundingRectangle;
+		QPainterPath boundingShape;
+		QPainterPath paintingShape;
+		QRectF paintingRectangle; // the label is centered in there
+	};
+	const Geometry * geometry;
 
 	// style related methods
 	void setStyle(VertexStyle *s);
 	void setLabel(std::string l);
 
-	QRectF getBoundingRect(const std::string text = "") const;
-	QPainterPath getBoundingShape(const std::string text = "") const;
-	QPainterPath getPaintingShape(const std::string text = "") const;
-	
-	QRectF getRect(const std::string text, int offset) const;
-	QPainterPath getShape(const QRectF r) const;
+	static const Geometry * GetGeometry(VertexStyle * s, const std::string & text, const QFont & f);
+	static QRectF GetRect(VertexStyle * s, const std::string & text, const QFont & f, int offset);
+	static QPainterPath GetShape(VertexStyle * s, const QRectF r);
 
 	QFont font;
 protected:
@@ -40,14 +40,14 @@
 /**************************************
 * Default Constructor: The id is void *
 ***************************************/
-VertexProperty::VertexProperty() : id(""), clonableFlag(true) { }
+VertexProperty::VertexProperty() : id(""), clonableFlag(true), type(genericVertex) { }
 
 /************************
 * Numbering Constructor *
 *************************
 * The id is an integer
 **********************/
-VertexProperty::VertexProperty(int n, bool c) : clonableFlag(c)
+VertexProperty::VertexProperty(int n, bool c) : clonableFlag(c), type(genericVertex)
 {
 	char buff[16];
 	sprintf(buff, "%d", n);
@@ -39,6 +39,9 @@
 // Local (for BGL_Vertex)
 #include "graphmodel.h"
 
+// The kind of vertex, known upon construction (one integer to compare, rather than type labels)
+enum VertexType { genericVertex, speciesVertex, reactionVertex, emptySetVertex };
+
 /*****************
 * VertexProperty *
 ******************
@@ -51,6 +54,7 @@
 *
 * Also gives info on the vertex type (for styling purposes)
 * and corresponding label (for the views)
+* The kind of vertex (getType) is the one to test in loops: the labels are for display
 * and on whether it is clonable or not (by default, yes)
 *
 * [!] that's a lot of different string outputs, maybe to clean up a bit...
@@ -71,6 +75,7 @@ public:
 	
 	virtual std::string getTypeLabel(bool highest=false);
 	virtual std::string getSuperTypeLabel() { return ""; }
+	VertexType getType() { return this->type; }
 
 	virtual bool clonable();
 	
@@ -78,6 +83,9 @@ public:
 	virtual std::string getCompartment() { return ""; } // [!] no meaning for non pathway vertex
 	
 	virtual int inherits(int sbo) { return -1; } // [!] no meaning for non pathway vertex
+
+protected:
+	VertexType type; // set by the constructors of the subclasses
 	
 private:
 	bool clonableFlag;
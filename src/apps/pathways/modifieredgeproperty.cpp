@@ -40,7 +40,7 @@
 /****************************************************
 * Constructor: sets up the ModifierSpeciesReference *
 *****************************************************/
-ModifierEdgeProperty::ModifierEdgeProperty(ModifierSpeciesReference * mr) : modRef(mr) { }
+ModifierEdgeProperty::ModifierEdgeProperty(ModifierSpeciesReference * mr) : modRef(mr) { this->type = modifierEdge; }
 
 /****************
 * stringVersion *
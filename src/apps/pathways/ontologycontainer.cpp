@@ -42,7 +42,11 @@ int OntologyContainer::inherits(std::string child, std::string parent)
 	if (child == "") return -1;
 	if (child == parent) return 0;	
 	
-	int distance = this->inherits(this->idToParent[child], parent);
+	// find rather than [], so that concurrent layouts only ever read the map
+	std::map<std::string, std::string>::const_iterator it = this->idToParent.find(child);
+	if (it == this->idToParent.end()) return -1;
+
+	int distance = this->inherits(it->second, parent);
 	if (distance == -1) return -1;
 	else return distance + 1;
 }
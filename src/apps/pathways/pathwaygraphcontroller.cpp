@@ -85,7 +85,7 @@ void PathwayGraphController::toggleModifiersCloning()
 		std::list<BGL_Edge> eList = this->_graphModel->getOutEdges(*vit);
 		for (std::list<BGL_Edge>::iterator eit = eList.begin(); eit != eList.end(); ++eit)
 		{
-			if (this->_graphModel->getProperties(*eit)->getTypeLabel() == "Modifier")
+			if (this->_graphModel->getProperties(*eit)->getType() == modifierEdge)
 			{
 				this->selfToggleCloning(*vit, NULL, NULL);
 			}
@@ -107,7 +107,7 @@ void PathwayGraphController::toggleReactionsFusing()
 	std::list<BGL_Vertex> vList = this->_graphModel->getVertices();	
 	for (std::list<BGL_Vertex>::iterator vit = vList.begin(); vit != vList.end(); ++vit)
 	{
-		if (this->_graphModel->getProperties(*vit)->getTypeLabel(true) == "Reaction") rList.push_back(*vit);
+		if (this->_graphModel->getProperties(*vit)->getType() == reactionVertex) rList.push_back(*vit);
 	}
 
 	this->_graphModel->toggleFusing(rList);
@@ -337,7 +337,7 @@ void PathwayGraphModel::defaultLayout(bool update)
 	{
 		Compartment * comp = this->getCompartment(i);		
 		// The new compartment container is linked to its sbml id, and placed at the root of the layout
-		ContainerContent * cont = new CompartmentContainer(graphLayout, graphLayout->getRoot(), comp);
+		ContainerContent * cont = new (graphLayout) CompartmentContainer(graphLayout, graphLayout->getRoot(), comp);
 		// Linking compartment id to container (temp storage)
 		this->compartmentToContainer[graphLayout][comp->getId()] = cont;
 	}
@@ -369,7 +369,7 @@ void PathwayGraphModel::defaultLayout(bool update)
 		if (comp == "")
 		{
 			// Species should always have a compartment!
-			if ( (vp->getTypeLabel(true) == "Species") && (vp->getTypeLabel() != "empty set") )
+			if ( vp->getType() == speciesVertex )
 				throw std::runtime_error("PathwayGraphModel::defaultLayout()\nSpecies with no compartment");
 			else continue; // will be dealt with at second pass
 		}
@@ -390,10 +390,10 @@ void PathwayGraphModel::defaultLayout(bool update)
 
 		std::string comp = vp->getCompartment();
 		if (comp != "") continue; // We are only interested in vertices with no compartments
-		if (vp->getTypeLabel(true) != "Reaction") // Only reactions, actually
+		if (vp->getType() != reactionVertex) // Only reactions, actually
 		{
 			// only source or sink are also allowed to have no compartment
-			if (vp->getTypeLabel() != "empty set")
+			if (vp->getType() != emptySetVertex)
 				throw std::runtime_error("PathwayGraphModel::defaultLayout()\nVertex with no compartment can only be empty sets or reactions, not " + vp->getTypeLabel() + " or " + vp->getTypeLabel(true));
 			continue;
 		}
@@ -413,7 +413,7 @@ void PathwayGraphModel::defaultLayout(bool update)
 			BGL_Vertex coreSpecies = *it;
 
 			// If the neighbour is a source or sink
-			if (this->vertexProperties[ coreSpecies ]->getTypeLabel() == "empty set")
+			if (this->vertexProperties[ coreSpecies ]->getType() == emptySetVertex)
 			{
 				// we put it in the list of source or sink, to be put it in the reaction's container
 				sourceOrSinkList.push_back(coreSpecies);
@@ -586,11 +586,11 @@ void PathwayGraphModel::loadXMLContentInfo(XMLNode * contentNode, GraphLayout *
 		{
 			if (sbmlid == "")
 			{ // the normal case, a standard container
-				c = new ContainerContent(graphLayout, parent);		
+				c = new (graphLayout) ContainerContent(graphLayout, parent);		
 			}
 			else
 			{ // in case we are dealing with a compartment container
-				c = new CompartmentContainer(graphLayout, parent, this->model()->getCompartment(sbmlid));
+				c = new (graphLayout) CompartmentContainer(graphLayout, parent, this->model()->getCompartment(sbmlid));
 				this->compartmentToContainer[graphLayout][sbmlid] = c;			
 			}
 		}
@@ -605,6 +605,7 @@ void PathwayGraphModel::loadXMLContentInfo(XMLNode * contentNode, GraphLayout *
 		if (strategy == "Neighbourhood") c->setContentLayoutStrategy(Neighbourhood);
 		if (strategy == "Branch") c->setContentLayoutStrategy(Branch);
 		if (strategy == "Triangle") c->setContentLayoutStrategy(Triangle);
+		if (strategy == "Force") c->setContentLayoutStrategy(Force);
 
 		// finally we must have a look at the children of the container (the parent parameter is the current container)
 		int nc = contentNode->getNumChildren();
@@ -620,7 +621,7 @@ void PathwayGraphModel::loadXMLContentInfo(XMLNode * contentNode, GraphLayout *
 		if (sbmlid != "") // normal sbml vertex
 		{
 			// we must create the clone with the relevant sbml id
-			clone = new CloneContent( this->idToVertex[sbmlid], graphLayout );		
+			clone = new (graphLayout) CloneContent( this->idToVertex[sbmlid], graphLayout );		
 		}
 		else // probably a source or sink
 		{
@@ -635,7 +636,7 @@ void PathwayGraphModel::loadXMLContentInfo(XMLNode * contentNode, GraphLayout *
 			BGL_Vertex s;
 			if (isSource)	s = this->getSource( this->getInEdges(r).front() );
 			else			s = this->getTarget( this->getOutEdges(r).front() );
-			clone = new CloneContent(s, graphLayout);
+			clone = new (graphLayout) CloneContent(s, graphLayout);
 		}		
 		
 		// inside of the proper parent container, as a core if necessary
@@ -850,7 +851,7 @@ std::string PathwayGraphModel::saveXMLContainerInfo(ContainerContent * c)
 		break;
 	case Hierarchy:
 		containerString += "Hierarchy";
-		if (c->getTypeLabel() == "CompContainer")
+		if (c->getType() == compartmentContainer)
 		{
 			moreInfo += "arcadia:sbmlid=\"" + c->getReference() + "\"";
 		}
@@ -867,13 +868,16 @@ std::string PathwayGraphModel::saveXMLContainerInfo(ContainerContent * c)
 	case Triangle:
 		containerString += "Triangle";
 		break;
+	case Force:
+		containerString += "Force";
+		break;
 	}
 	containerString += "\"";
 	if (moreInfo != "") containerString += " " + moreInfo;
 	containerString += ">";
 
-	std::list<Content*> children = c->getChildren();
-	for (std::list<Content*>::iterator it = children.begin(); it != children.end(); ++it)
+	ContentRange children = c->getChildRange();
+	for (ContentRange::iterator it = children.begin(); it != children.end(); ++it)
 	{
 		if ((*it)->getId() == "") // it's not a container
 		{
@@ -898,7 +902,7 @@ std::string PathwayGraphModel::saveXMLCloneInfo(CloneContent * c)
 	}
 	else // there's no id...
 	{
-		if (vp->getTypeLabel() == "empty set") // it's a source or sink
+		if (vp->getType() == emptySetVertex) // it's a source or sink
 		{
 			cloneString += " arcadia:role=\"" + vp->getLabel() + "\"";
 			BGL_Vertex reaction = this->getNeighbours( c->getVertex() ).front();
@@ -1015,7 +1019,7 @@ void PathwayGraphModel::saveExtensionLayoutInfo(Model * m, GraphLayout * graphLa
 		BGL_Vertex v = *it;
 		VertexProperty * vp = this->getProperties(v);
 
-		if (vp->getTypeLabel() != "empty set") continue;
+		if (vp->getType() != emptySetVertex) continue;
 
 		CloneContent * clone = graphLayout->getClone(v);
 		if (!clone) continue; // e.g neighbourhood layout
@@ -1128,9 +1132,9 @@ void PathwayGraphModel::saveExtensionReactionLayoutInfo(CloneContent * clone, La
 //		specRef->setSpeciesReferenceId( ep->getId() ); // this is the preferred way of defining species reference glyphs, though...
 
 		// We set the role of the glyph based on the edge type
-		if (ep->getTypeLabel() == "Modifier") specRef->setRole(SPECIES_ROLE_MODIFIER);
-		if (ep->getTypeLabel() == "Product") specRef->setRole(SPECIES_ROLE_PRODUCT);
-		if (ep->getTypeLabel() == "Reactant") specRef->setRole(SPECIES_ROLE_SUBSTRATE);
+		if (ep->getType() == modifierEdge) specRef->setRole(SPECIES_ROLE_MODIFIER);
+		if (ep->getType() == productEdge) specRef->setRole(SPECIES_ROLE_PRODUCT);
+		if (ep->getType() == reactantEdge) specRef->setRole(SPECIES_ROLE_SUBSTRATE);
 
 		// We get the connector end coordinates: p1 for the reaction, p2 for the species
 		std::pair<int, int> p1 = connect->getPoint(!speciesIsSource); // no intersection problem as connectors point at either in, out, side1 or side2 for reactions
@@ -1144,7 +1148,7 @@ void PathwayGraphModel::saveExtensionReactionLayoutInfo(CloneContent * clone, La
 		LineSegment* ls = specRef->createLineSegment();
 		
 		// We make sure the edge goes in the right direction
-		if (ep->getTypeLabel() == "Product") // from reaction to species for products
+		if (ep->getType() == productEdge) // from reaction to species for products
 		{
 			// SBW compatibility start
 			int x3 = connect->getSource()->x();
@@ -1158,7 +1162,7 @@ void PathwayGraphModel::saveExtensionReactionLayoutInfo(CloneContent * clone, La
 			ls->setStart(&reacPoint);
 			ls->setEnd(&specPoint);
 		}
-		else if (ep->getTypeLabel() == "Reactant") // from species to reaction for reactant
+		else if (ep->getType() == reactantEdge) // from species to reaction for reactant
 		{
 			ls->setStart(&specPoint);
 			ls->setEnd(&reacPoint);		
@@ -1172,7 +1176,7 @@ void PathwayGraphModel::saveExtensionReactionLayoutInfo(CloneContent * clone, La
 			ls->setEnd(&lastPoint);		
 			// SBW compatibility end
 		}
-		else if (ep->getTypeLabel() == "Modifier") // from species to reaction for modifier too
+		else if (ep->getType() == modifierEdge) // from species to reaction for modifier too
 		{
 			ls->setStart(&specPoint);
 			ls->setEnd(&reacPoint);		
@@ -102,7 +102,7 @@ VertexStyle * PathwayStyleSheet::getVertexStyle(VertexProperty * vp, CloneProper
 		int d = -1;
 
 		// Reaction
-		if (vp->getSuperTypeLabel() == "Reaction")
+		if (vp->getType() == reactionVertex)
 		{
 			d = vp->inherits(PathwayStyleSheet::Transition);
 			if (d != -1) if (dmin == -1 || d < dmin) { dmin = d; sbo = PathwayStyleSheet::Transition; }
@@ -133,7 +133,7 @@ VertexStyle * PathwayStyleSheet::getVertexStyle(VertexProperty * vp, CloneProper
 		}
 
 		// Species
-		if (vp->getSuperTypeLabel() == "Species")
+		if (vp->getType() == speciesVertex || vp->getType() == emptySetVertex)
 		{
 			d = vp->inherits(PathwayStyleSheet::SimpleChemical);
 			if (d != -1) if (dmin == -1 || d < dmin) { dmin = d; sbo = PathwayStyleSheet::SimpleChemical; }
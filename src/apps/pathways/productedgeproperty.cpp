@@ -41,7 +41,7 @@
 /********************************************
 * Constructor: sets up the SpeciesReference *
 *********************************************/
-ProductEdgeProperty::ProductEdgeProperty(SpeciesReference * sr, bool reversible) : PathwayEdgeProperty(sr, reversible) { }	
+ProductEdgeProperty::ProductEdgeProperty(SpeciesReference * sr, bool reversible) : PathwayEdgeProperty(sr, reversible) { this->type = productEdge; }	
 
 /****************
 * stringVersion *
@@ -41,7 +41,7 @@
 /********************************************
 * Constructor: sets up the SpeciesReference *
 *********************************************/
-ReactantEdgeProperty::ReactantEdgeProperty(SpeciesReference * sr, bool reversible) : PathwayEdgeProperty(sr, reversible) { }
+ReactantEdgeProperty::ReactantEdgeProperty(SpeciesReference * sr, bool reversible) : PathwayEdgeProperty(sr, reversible) { this->type = reactantEdge; }
 	
 /****************
 * stringVersion *
@@ -49,6 +49,8 @@ bool ReactionVertexProperty::isReversible()
 ReactionVertexProperty::ReactionVertexProperty(Reaction * r, PathwayGraphModel * m)
 	: PathwayVertexProperty(r, m)
 {
+	this->type = reactionVertex;
+
 	// initialize compartment info
 	this->compartment = "";
 
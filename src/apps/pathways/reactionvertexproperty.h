@@ -74,7 +74,7 @@ private:
 class SourceOrSinkProperty : public VertexProperty
 {
 public:
-	SourceOrSinkProperty(bool iS, ReactionVertexProperty * r) : isSource(iS), reaction(r) {}
+	SourceOrSinkProperty(bool iS, ReactionVertexProperty * r) : isSource(iS), reaction(r) { this->type = emptySetVertex; }
 	std::string getLabel() { return this->isSource? "Source" : "Sink"; } // the id, however, is ""
 	std::string getCompartment() { return this->reaction->getCompartment();}
 
@@ -40,8 +40,14 @@
 
 /***********************************
 * Constructor: sets up the Species *
-************************************/
-SpeciesVertexProperty::SpeciesVertexProperty(Species * s, PathwayGraphModel * m) : PathwayVertexProperty(s, m) { }
+************************************
+* A Species annotated as an empty set (SBO:0000291)
+* is a source or sink, just like the ones made up for reactions
+*****************************************************************/
+SpeciesVertexProperty::SpeciesVertexProperty(Species * s, PathwayGraphModel * m) : PathwayVertexProperty(s, m)
+{
+	this->type = (this->getTypeLabel() == "empty set")? emptySetVertex: speciesVertex;
+}
 		
 std::string SpeciesVertexProperty::getLabel()
 {
@@ -115,6 +115,9 @@ HEADERS += \
 		$$ARCADIAPATH/graphwindow.h\
 		$$ARCADIAPATH/graphcontroller.h\
 		$$ARCADIAPATH/graphmodel.h\
+		$$ARCADIAPATH/graphsnapshot.h\
+		$$ARCADIAPATH/graphrange.h\
+		$$ARCADIAPATH/layoutpool.h\
 		$$ARCADIAPATH/graphloader.h\
 			$$ARCADIAPATH/defaultgraphloader.h\
 			$$ARCADIAPATH/graphvizgraphloader.h\
@@ -126,6 +129,7 @@ HEADERS += \
 		$$ARCADIAPATH/contentlayoutmanager.h\
 			$$ARCADIAPATH/squarecontentlayoutmanager.h\
 			$$ARCADIAPATH/graphvizcontentlayoutmanager.h\
+			$$ARCADIAPATH/forcecontentlayoutmanager.h\
 		$$ARCADIAPATH/connectorlayoutmanager.h\
 		$$ARCADIAPATH/stylesheet.h\
 		$$ARCADIAPATH/edgestyle.h\
@@ -152,6 +156,8 @@ SOURCES += \
 		$$ARCADIAPATH/graphwindow.cpp\
 		$$ARCADIAPATH/graphcontroller.cpp\
 		$$ARCADIAPATH/graphmodel.cpp\
+		$$ARCADIAPATH/graphsnapshot.cpp\
+		$$ARCADIAPATH/layoutpool.cpp\
 		$$ARCADIAPATH/graphloader.cpp\
 			$$ARCADIAPATH/defaultgraphloader.cpp\
 			$$ARCADIAPATH/graphvizgraphloader.cpp\
@@ -163,6 +169,7 @@ SOURCES += \
 		$$ARCADIAPATH/contentlayoutmanager.cpp\
 			$$ARCADIAPATH/squarecontentlayoutmanager.cpp\
 			$$ARCADIAPATH/graphvizcontentlayoutmanager.cpp\
+			$$ARCADIAPATH/forcecontentlayoutmanager.cpp\
 		$$ARCADIAPATH/connectorlayoutmanager.cpp\
 		$$ARCADIAPATH/stylesheet.cpp\
 		$$ARCADIAPATH/edgestyle.cpp\
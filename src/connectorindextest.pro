@@ -0,0 +1,40 @@
+############################################################################
+#
+# Arcadia is a visualisation tool for metabolic pathways
+# This file is the Qt project file for the connector index regression test
+#
+# Copyright (C) 2007-2009 Alice Villeger, University of Manchester
+# <alice.villeger@manchester.ac.uk>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+# 
+############################################################################
+
+# The sources of the application, with a test program instead of main.cpp:
+#	qmake connectorindextest.pro -o Makefile.connectorindextest
+#	make -f Makefile.connectorindextest
+#	../macosx/connectorindextest (returns 0 when every check passes)
+
+include(arcadia.pro)
+
+TARGET = connectorindextest
+CONFIG += console
+macx {
+	CONFIG -= app_bundle
+}
+
+DEFINES += TESTS_DIR=\\\"$$PWD/tests\\\"
+
+SOURCES -= main.cpp
+SOURCES += tests/connectorindextest.cpp
@@ -0,0 +1,118 @@
+/*
+ * vim: ts=4 sw=4 et tw=0 wm=0
+ *
+ * libavoid - Fast, Incremental, Object-avoiding Line Router
+ * Copyright (C) 2007-2009  Alice Villeger <alice.villeger@manchester.ac.uk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+*/
+
+#ifndef AVOID_ARENA_H
+#define AVOID_ARENA_H
+
+#include <new>
+#include <vector>
+#include <cassert>
+
+
+namespace Avoid {
+
+
+// The value of an index that refers to nothing.
+static const unsigned int NoIndex = (unsigned int) -1;
+
+
+// Storage for the objects of one kind owned by a router (vertices,
+// edges...).  Objects are allocated side by side, in chunks that never
+// move, and each gets an index: objects can refer to each other by index,
+// and the index of a released object is reused by the next allocation.
+//
+// The memory only goes back to the system when the arena is destroyed,
+// in one deallocation per chunk.  The objects still there at that point
+// are not destroyed: they must not own any other memory.
+//
+template <typename T>
+class Arena
+{
+    public:
+        Arena()
+            : _size(0)
+        {
+        }
+        ~Arena()
+        {
+            for (unsigned int i = 0; i < _chunks.size(); ++i)
+            {
+                ::operator delete(_chunks[i]);
+            }
+        }
+
+        // Returns the memory for a new object, whose index is stored
+        // in index.
+        void *allocate(unsigned int& index)
+        {
+            if (!_free.empty())
+            {
+                index = _free.back();
+                _free.pop_back();
+            }
+            else
+            {
+                if ((_size & ChunkMask) == 0)
+                {
+                    _chunks.push_back(static_cast<T *>(
+                            ::operator new(ChunkSize * sizeof(T))));
+                }
+                index = _size++;
+            }
+            return at(index);
+        }
+        // The object at index must have been destroyed already.
+        void release(unsigned int index)
+        {
+            assert(index < _size);
+            _free.push_back(index);
+        }
+        T *at(unsigned int index) const
+        {
+            return _chunks[index >> ChunkBits] + (index & ChunkMask);
+        }
+        // One past the highest index ever given.
+        unsigned int size(void) const
+        {
+            return _size;
+        }
+    private:
+        static const unsigned int ChunkBits = 10;
+        static const unsigned int ChunkSize = 1 << ChunkBits;
+        static const unsigned int ChunkMask = ChunkSize - 1;
+
+        std::vector<T *> _chunks;
+        std::vector<unsigned int> _free;
+        unsigned int _size;
+
+        // Not copyable.
+        Arena(const Arena&);
+        Arena& operator=(const Arena&);
+};
+
+
+}
+
+
+#endif
+
+
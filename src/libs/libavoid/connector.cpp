@@ -27,6 +27,8 @@
 #include "libavoid/debug.h"
 #include "libavoid/router.h"
 
+#include <algorithm>
+
 
 namespace Avoid {
 
@@ -47,6 +49,7 @@ ConnRef::ConnRef(Router *router, const unsigned int id)
     , _callback(NULL)
     , _connector(NULL)
     , _hateCrossings(false)
+    , _searchEdge(NULL)
 {
     // TODO: Store endpoints and details.
     _route.pn = 0;
@@ -71,6 +74,7 @@ ConnRef::ConnRef(Router *router, const unsigned int id,
     , _callback(NULL)
     , _connector(NULL)
     , _hateCrossings(false)
+    , _searchEdge(NULL)
 {
     _route.pn = 0;
     _route.ps = NULL;
@@ -78,8 +82,8 @@ ConnRef::ConnRef(Router *router, const unsigned int id,
     if (_router->IncludeEndpoints)
     {
         bool isShape = false;
-        _srcVert = new VertInf(_router, VertID(id, isShape, 1), src);
-        _dstVert = new VertInf(_router, VertID(id, isShape, 2), dst);
+        _srcVert = VertInf::create(_router, VertID(id, isShape, 1), src);
+        _dstVert = VertInf::create(_router, VertID(id, isShape, 2), dst);
         _router->vertices.addVertex(_srcVert);
         _router->vertices.addVertex(_dstVert);
         makeActive();
@@ -92,17 +96,31 @@ ConnRef::~ConnRef()
 {
     freeRoute();
 
+    if (_router->destroying())
+    {
+        // The vertices go away with the router, and so do the edges
+        // still referring to the connector.
+        if (_active)
+        {
+            makeInactive();
+        }
+        return;
+    }
+
+    // The edges of the last path must not alert a deleted connector.
+    clearFlags();
+
     if (_srcVert)
     {
         _router->vertices.removeVertex(_srcVert);
-        delete _srcVert;
+        _srcVert->destroy();
         _srcVert = NULL;
     }
 
     if (_dstVert)
     {
         _router->vertices.removeVertex(_dstVert);
-        delete _dstVert;
+        _dstVert->destroy();
         _dstVert = NULL;
     }
 
@@ -145,7 +163,7 @@ void ConnRef::updateEndPoint(const unsigned int type, const Point& point)
         }
         else
         {
-            _srcVert = new VertInf(_router, VertID(_id, isShape, type), point);
+            _srcVert = VertInf::create(_router, VertID(_id, isShape, type), point);
             _router->vertices.addVertex(_srcVert);
         }
         
@@ -160,7 +178,7 @@ void ConnRef::updateEndPoint(const unsigned int type, const Point& point)
         }
         else
         {
-            _dstVert = new VertInf(_router, VertID(_id, isShape, type), point);
+            _dstVert = VertInf::create(_router, VertID(_id, isShape, type), point);
             _router->vertices.addVertex(_dstVert);
         }
         
@@ -259,8 +277,8 @@ void ConnRef::lateSetup(const Point& src, const Point& dst)
     assert(!_initialised);
 
     bool isShape = false;
-    _srcVert = new VertInf(_router, VertID(_id, isShape, 1), src);
-    _dstVert = new VertInf(_router, VertID(_id, isShape, 2), dst);
+    _srcVert = VertInf::create(_router, VertID(_id, isShape, 1), src);
+    _dstVert = VertInf::create(_router, VertID(_id, isShape, 2), dst);
     _router->vertices.addVertex(_srcVert);
     _router->vertices.addVertex(_dstVert);
     makeActive();
@@ -315,7 +333,7 @@ void ConnRef::removeFromGraph(void)
         while ((edge = visList.begin()) != finish)
         {
             // Remove each visibility edge
-            delete (*edge);
+            (*edge)->destroy();
         }
 
         EdgeInfList& invisList = tmp->invisList;
@@ -323,7 +341,7 @@ void ConnRef::removeFromGraph(void)
         while ((edge = invisList.begin()) != finish)
         {
             // Remove each invisibility edge
-            delete (*edge);
+            (*edge)->destroy();
         }
     }
 }
@@ -352,6 +370,32 @@ void ConnRef::makePathInvalid(void)
 }
 
 
+// The edge forgot one registration of the connector (cf.
+// EdgeInf::clearConns).
+//
+void ConnRef::forgetEdge(EdgeInf *edge)
+{
+    std::vector<EdgeInf *>::iterator it =
+            std::find(_flagEdges.begin(), _flagEdges.end(), edge);
+    assert(it != _flagEdges.end());
+    *it = _flagEdges.back();
+    _flagEdges.pop_back();
+}
+
+
+// Unregisters the connector from every edge it uses, so that they
+// neither alert it nor keep its entries in the flag arena.
+//
+void ConnRef::clearFlags(void)
+{
+    for (unsigned int i = 0; i < _flagEdges.size(); ++i)
+    {
+        _flagEdges[i]->removeConn(this);
+    }
+    _flagEdges.clear();
+}
+
+
 Router *ConnRef::router(void)
 {
     return _router;
@@ -381,58 +425,119 @@ int ConnRef::generatePath(Point p0, Point p1)
 
 int ConnRef::generatePath(void)
 {
-    if (!_false_path && !_needs_reroute_flag) {
+    if (!searchPath(_router->pathSearch)) {
         // This connector is up to date.
         return (int) false;
     }
 
+    return commitPath();
+}
+
+
+// Looks for the best path for the connector, and keeps it until the
+// next commitPath.  Returns false if the connector is up to date.
+//
+// With IncludeEndpoints, neither the visibility graph nor the other
+// connectors are changed by the search (cf. makePath): the connectors
+// of a router can then all search at the same time, each thread with
+// its own PathSearch, as long as they are committed afterwards.
+//
+bool ConnRef::searchPath(PathSearch& search)
+{
+    if (!_false_path && !_needs_reroute_flag) {
+        // This connector is up to date.
+        return false;
+    }
+
     _false_path = false;
     _needs_reroute_flag = false;
 
     VertInf *src = _srcVert;
     VertInf *tar = _dstVert;
 
-    bool *flag = &(_needs_reroute_flag);
-    
-    makePath(this, flag);
-    
-    bool result = true;
+    if ( !(_router->IncludeEndpoints) )
+    {
+        // The search registers the connector with the direct edge:
+        // the edges of the previous path are forgotten first.  With
+        // IncludeEndpoints, that is left to commitPath, as searches
+        // may run concurrently.
+        clearFlags();
+    }
+
+    makePath(this, search);
     
-    int pathlen = 1;
-    for (VertInf *i = tar; i != src; i = i->pathNext)
+    // The path is kept backwards, from tar to (but excluding) src.
+    // It ends with NULL if no path was found.
+    _searchPath.clear();
+    _searchEdge = search.directEdge;
+    for (VertInf *i = tar; i != src; i = search.pathNext(i))
     {
-        pathlen++;
+        _searchPath.push_back(i);
         if (i == NULL)
         {
-            db_printf("Warning: Path not found...\n");
-            pathlen = 2;
-            tar->pathNext = src;
-            if (_router->InvisibilityGrph)
-            {
-                // TODO:  Could we know this edge already?
-                EdgeInf *edge = EdgeInf::existingEdge(src, tar);
-                assert(edge != NULL);
-                edge->addCycleBlocker();
-            }
-            result = false;
             break;
         }
-        if (pathlen > 100)
+        if (_searchPath.size() >= 100)
         {
             fprintf(stderr, "ERROR: Should never be here...\n");
             exit(1);
         }
     }
+    return true;
+}
+
+
+// Makes the path found by the last searchPath the route of the
+// connector, and registers the connector with the visibility edges
+// it uses.  Returns false if no path was found.
+//
+int ConnRef::commitPath(void)
+{
+    VertInf *src = _srcVert;
+    VertInf *tar = _dstVert;
+
+    if (_router->IncludeEndpoints)
+    {
+        // The edges of the previous path are forgotten (cf. searchPath).
+        clearFlags();
+    }
+
+    if (_searchEdge)
+    {
+        _searchEdge->addConn(this);
+        _searchEdge = NULL;
+    }
+
+    bool result = true;
+    
+    if (!_searchPath.empty() && (_searchPath.back() == NULL))
+    {
+        db_printf("Warning: Path not found...\n");
+        _searchPath.clear();
+        _searchPath.push_back(tar);
+        if (_router->InvisibilityGrph)
+        {
+            // TODO:  Could we know this edge already?
+            EdgeInf *edge = EdgeInf::existingEdge(src, tar);
+            assert(edge != NULL);
+            edge->addCycleBlocker();
+        }
+        result = false;
+    }
+
+    int pathlen = _searchPath.size() + 1;
     Point *path = (Point *) malloc(pathlen * sizeof(Point));
 
     int j = pathlen - 1;
-    for (VertInf *i = tar; i != src; i = i->pathNext)
+    for (unsigned int k = 0; k < _searchPath.size(); ++k)
     {
+        VertInf *i = _searchPath[k];
+        VertInf *next = (k + 1 < _searchPath.size()) ? _searchPath[k + 1] : src;
         if (_router->InvisibilityGrph)
         {
             // TODO: Again, we could know this edge without searching.
-            EdgeInf *edge = EdgeInf::existingEdge(i, i->pathNext);
-            edge->addConn(flag);
+            EdgeInf *edge = EdgeInf::existingEdge(i, next);
+            edge->addConn(this);
         }
         else
         {
@@ -443,10 +548,14 @@ int ConnRef::generatePath(void)
         j--;
     }
     path[0] = src->point;
+    _searchPath.clear();
 
 
     // Would clear visibility for endpoints here if required.
 
+    // The previous route is replaced, rather than leaked.
+    freeRoute();
+
     PolyLine& output_route = route();
     output_route.pn = pathlen;
     output_route.ps = path;
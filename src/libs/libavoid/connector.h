@@ -26,7 +26,9 @@
 #include "libavoid/router.h"
 #include "libavoid/geometry.h"
 #include "libavoid/shape.h"
+#include "libavoid/makepath.h"
 #include <list>
+#include <vector>
 
 
 namespace Avoid {
@@ -66,6 +68,8 @@ class ConnRef
         void handleInvalid(void);
         int generatePath(void);
         int generatePath(Point p0, Point p1);
+        bool searchPath(PathSearch& search);
+        int commitPath(void);
         void makePathInvalid(void);
         Router *router(void);
         void setHateCrossings(bool value);
@@ -94,6 +98,16 @@ class ConnRef
         void (*_callback)(void *);
         void *_connector;
         bool _hateCrossings;
+        std::vector<VertInf *> _searchPath;
+        EdgeInf *_searchEdge;
+        // The edges the connector is registered with, once per
+        // registration (cf. EdgeInf::addConn).
+        std::vector<EdgeInf *> _flagEdges;
+
+        void forgetEdge(EdgeInf *edge);
+        void clearFlags(void);
+
+        friend class EdgeInf;
 };
 
 
@@ -30,6 +30,7 @@
 #include "libavoid/router.h"
 
 #include <math.h>
+#include <algorithm>
 
 using std::pair;
 
@@ -39,12 +40,17 @@ namespace Avoid {
 EdgeInf::EdgeInf(VertInf *v1, VertInf *v2)
     : lstPrev(NULL)
     , lstNext(NULL)
+    , lstOrder(0)
+    , blkPrev(NULL)
+    , blkNext(NULL)
     , _blocker(0)
     , _router(NULL)
     , _added(false)
     , _visible(false)
     , _v1(v1)
     , _v2(v2)
+    , _index(NoIndex)
+    , _firstConn(NoIndex)
     , _dist(-1)
 {
     // Not passed NULL values.
@@ -54,7 +60,7 @@ EdgeInf::EdgeInf(VertInf *v1, VertInf *v2)
     assert(_v1->_router == _v2->_router);
     _router = _v1->_router;
 
-    _conns.clear();
+    _prev[0] = _prev[1] = _next[0] = _next[1] = NoIndex;
 }
 
 
@@ -67,6 +73,25 @@ EdgeInf::~EdgeInf()
 }
 
 
+EdgeInf *EdgeInf::create(VertInf *v1, VertInf *v2)
+{
+    unsigned int index;
+    void *memory = v1->_router->edgeArena.allocate(index);
+    EdgeInf *edge = new (memory) EdgeInf(v1, v2);
+    edge->_index = index;
+    return edge;
+}
+
+
+void EdgeInf::destroy(void)
+{
+    Router *router = _router;
+    unsigned int index = _index;
+    this->~EdgeInf();
+    router->edgeArena.release(index);
+}
+
+
 void EdgeInf::makeActive(void)
 {
     assert(_added == false);
@@ -74,17 +99,19 @@ void EdgeInf::makeActive(void)
     if (_visible)
     {
         _router->visGraph.addEdge(this);
-        _pos1 = _v1->visList.insert(_v1->visList.begin(), this);
+        _router->edgeTable.addEdge(this, _v1, _v2);
+        _v1->visList.push_front(this);
         _v1->visListSize++;
-        _pos2 = _v2->visList.insert(_v2->visList.begin(), this);
+        _v2->visList.push_front(this);
         _v2->visListSize++;
     }
     else // if (invisible)
     {
         _router->invisGraph.addEdge(this);
-        _pos1 = _v1->invisList.insert(_v1->invisList.begin(), this);
+        _router->edgeTable.addEdge(this, _v1, _v2);
+        _v1->invisList.push_front(this);
         _v1->invisListSize++;
-        _pos2 = _v2->invisList.insert(_v2->invisList.begin(), this);
+        _v2->invisList.push_front(this);
         _v2->invisListSize++;
     }
     _added = true;
@@ -98,21 +125,23 @@ void EdgeInf::makeInactive(void)
     if (_visible)
     {
         _router->visGraph.removeEdge(this);
-        _v1->visList.erase(_pos1);
+        _router->edgeTable.removeEdge(_v1, _v2);
+        _v1->visList.erase(this);
         _v1->visListSize--;
-        _v2->visList.erase(_pos2);
+        _v2->visList.erase(this);
         _v2->visListSize--;
     }
     else // if (invisible)
     {
         _router->invisGraph.removeEdge(this);
-        _v1->invisList.erase(_pos1);
+        _router->edgeTable.removeEdge(_v1, _v2);
+        _v1->invisList.erase(this);
         _v1->invisListSize--;
-        _v2->invisList.erase(_pos2);
+        _v2->invisList.erase(this);
         _v2->invisListSize--;
     }
-    _blocker = 0;
-    _conns.clear();
+    setBlocker(0);
+    clearConns(false);
     _added = false;
 }
 
@@ -131,24 +160,70 @@ void EdgeInf::setDist(double dist)
         makeActive();
     }
     _dist = dist;
-    _blocker = 0;
+    setBlocker(0);
 }
 
 
 void EdgeInf::alertConns(void)
 {
-    FlagList::iterator finish = _conns.end();
-    for (FlagList::iterator i = _conns.begin(); i != finish; ++i)
+    clearConns(true);
+}
+
+
+void EdgeInf::addConn(ConnRef *conn)
+{
+    Arena<ConnFlag>& flags = _router->flagArena;
+    unsigned int index;
+    ConnFlag *entry = new (flags.allocate(index)) ConnFlag;
+    entry->conn = conn;
+    entry->next = _firstConn;
+    _firstConn = index;
+    conn->_flagEdges.push_back(this);
+}
+
+
+// Forgets every registration of the connector with the edge, without
+// telling the connector (cf. ConnRef::clearFlags).
+//
+void EdgeInf::removeConn(ConnRef *conn)
+{
+    Arena<ConnFlag>& flags = _router->flagArena;
+    unsigned int *link = &_firstConn;
+    while (*link != NoIndex)
     {
-        *(*i) = true;
+        unsigned int index = *link;
+        ConnFlag *entry = flags.at(index);
+        if (entry->conn == conn)
+        {
+            *link = entry->next;
+            flags.release(index);
+        }
+        else
+        {
+            link = &(entry->next);
+        }
     }
-    _conns.clear();
 }
 
 
-void EdgeInf::addConn(bool *flag)
+// Forgets the connectors using the edge, after setting their reroute
+// flag if alert is true.
+//
+void EdgeInf::clearConns(bool alert)
 {
-    _conns.push_back(flag);
+    Arena<ConnFlag>& flags = _router->flagArena;
+    while (_firstConn != NoIndex)
+    {
+        unsigned int index = _firstConn;
+        ConnFlag *entry = flags.at(index);
+        if (alert)
+        {
+            entry->conn->makePathInvalid();
+        }
+        entry->conn->forgetEdge(this);
+        _firstConn = entry->next;
+        flags.release(index);
+    }
 }
 
 
@@ -173,6 +248,50 @@ void EdgeInf::addBlocker(int b)
         makeActive();
     }
     _dist = 0;
+    setBlocker(b);
+}
+
+
+// Keeps the router's BlockerMap up to date.  Edges blocked for other
+// reasons than a shape (0) are never rechecked, so they aren't kept.
+//
+void EdgeInf::setBlocker(int b)
+{
+    if (_blocker == b)
+    {
+        return;
+    }
+    BlockerMap& blocked = _router->blockedEdges;
+    if (_blocker != 0)
+    {
+        if (blkNext)
+        {
+            blkNext->blkPrev = blkPrev;
+        }
+        if (blkPrev)
+        {
+            blkPrev->blkNext = blkNext;
+        }
+        else if (blkNext)
+        {
+            blocked[_blocker] = blkNext;
+        }
+        else
+        {
+            blocked.erase(_blocker);
+        }
+        blkPrev = blkNext = NULL;
+    }
+    if (b != 0)
+    {
+        EdgeInf *& first = blocked[b];
+        blkNext = first;
+        if (first)
+        {
+            first->blkPrev = this;
+        }
+        first = this;
+    }
     _blocker = b;
 }
 
@@ -315,32 +434,36 @@ int EdgeInf::firstBlocker(void)
         ss.insert(contains[jID].begin(), contains[jID].end());
     }
 
-    VertInf *last = _router->vertices.end();
-    for (VertInf *k = _router->vertices.shapesBegin(); k != last; )
+    // Only the shapes near the edge can block it.  They come in the
+    // order of the vertex list, so the first blocker is the same.
+    ShapeRefVector shapes;
+    _router->shapeIndex.segmentQuery(pti, ptj, shapes);
+    for (ShapeRefVector::iterator it = shapes.begin(); it != shapes.end();
+            ++it)
     {
-        VertID kID = k->id;
-        if ((ss.find(kID.objID) != ss.end()))
+        unsigned int shapeID = (*it)->id();
+        if ((ss.find(shapeID) != ss.end()))
         {
-            unsigned int shapeID = kID.objID;
             db_printf("Endpoint is inside shape %u so ignore shape edges.\n",
-                    kID.objID);
+                    shapeID);
             // One of the endpoints is inside this shape so ignore it.
-            while ((k != last) && (k->id.objID == shapeID))
-            {
-                // And skip the other vertices from this shape.
-                k = k->lstNext;
-            }
             continue;
         }
-        Point& kPoint = k->point;
-        Point& kPrevPoint = k->shPrev->point;
-
-        if (segmentIntersect(pti, ptj, kPrevPoint, kPoint))
+        VertInf *first = (*it)->firstVert();
+        VertInf *k = first;
+        do
         {
-            ss.clear();
-            return kID.objID;
+            Point& kPoint = k->point;
+            Point& kPrevPoint = k->shPrev->point;
+
+            if (segmentIntersect(pti, ptj, kPrevPoint, kPoint))
+            {
+                ss.clear();
+                return shapeID;
+            }
+            k = k->shNext;
         }
-        k = k->lstNext;
+        while (k != first);
     }
     ss.clear();
     return 0;
@@ -378,20 +501,20 @@ EdgeInf *EdgeInf::checkEdgeVisibility(VertInf *i, VertInf *j, bool knownNew)
     if (knownNew)
     {
         assert(existingEdge(i, j) == NULL);
-        edge = new EdgeInf(i, j);
+        edge = EdgeInf::create(i, j);
     }
     else
     {
         edge = existingEdge(i, j);
         if (edge == NULL)
         {
-            edge = new EdgeInf(i, j);
+            edge = EdgeInf::create(i, j);
         }
     }
     edge->checkVis();
     if (!(edge->_added) && !(router->InvisibilityGrph))
     {
-        delete edge;
+        edge->destroy();
         edge = NULL;
     }
 
@@ -401,49 +524,7 @@ EdgeInf *EdgeInf::checkEdgeVisibility(VertInf *i, VertInf *j, bool knownNew)
 
 EdgeInf *EdgeInf::existingEdge(VertInf *i, VertInf *j)
 {
-    VertInf *selected = NULL;
-
-    if (i->visListSize <= j->visListSize)
-    {
-        selected = i;
-    }
-    else
-    {
-        selected = j;
-    }
-
-    EdgeInfList& visList = selected->visList;
-    EdgeInfList::iterator finish = visList.end();
-    for (EdgeInfList::iterator edge = visList.begin(); edge != finish;
-            ++edge)
-    {
-        if ((*edge)->isBetween(i, j))
-        {
-            return (*edge);
-        }
-    }
-
-    if (i->invisListSize <= j->invisListSize)
-    {
-        selected = i;
-    }
-    else
-    {
-        selected = j;
-    }
-
-    EdgeInfList& invisList = selected->invisList;
-    finish = invisList.end();
-    for (EdgeInfList::iterator edge = invisList.begin(); edge != finish;
-            ++edge)
-    {
-        if ((*edge)->isBetween(i, j))
-        {
-            return (*edge);
-        }
-    }
-
-    return NULL;
+    return i->_router->edgeTable.find(i, j);
 }
 
 
@@ -454,12 +535,16 @@ EdgeList::EdgeList()
     : _firstEdge(NULL)
     , _lastEdge(NULL)
     , _count(0)
+    , _order(0)
 {
 }
 
 
 void EdgeList::addEdge(EdgeInf *edge)
 {
+    // Edges come after every edge already in the list.
+    edge->lstOrder = _order++;
+
     if (_firstEdge == NULL)
     {
         assert(_lastEdge == NULL);
@@ -528,6 +613,100 @@ EdgeInf *EdgeList::end(void)
 }
 
 
+//===========================================================================
+
+
+EdgeTable::EdgeTable()
+    : _count(0)
+{
+}
+
+
+// The slot of the edge between the vertices of index a < b, or the empty
+// slot where it would go.
+//
+unsigned int EdgeTable::slotOf(unsigned int a, unsigned int b) const
+{
+    unsigned int mask = _slots.size() - 1;
+    unsigned int s = ((a * 2654435761u) ^ (b * 40503u)) & mask;
+    while (_slots[s].edge && ((_slots[s].a != a) || (_slots[s].b != b)))
+    {
+        s = (s + 1) & mask;
+    }
+    return s;
+}
+
+
+void EdgeTable::grow(void)
+{
+    std::vector<Slot> old;
+    old.swap(_slots);
+
+    Slot empty = { 0, 0, NULL };
+    _slots.resize(old.empty() ? 1024 : old.size() * 2, empty);
+    for (unsigned int i = 0; i < old.size(); ++i)
+    {
+        if (old[i].edge)
+        {
+            _slots[slotOf(old[i].a, old[i].b)] = old[i];
+        }
+    }
+}
+
+
+void EdgeTable::addEdge(EdgeInf *edge, VertInf *v1, VertInf *v2)
+{
+    if (2 * (_count + 1) > _slots.size())
+    {
+        grow();
+    }
+    unsigned int a = std::min(v1->index, v2->index);
+    unsigned int b = std::max(v1->index, v2->index);
+
+    Slot& slot = _slots[slotOf(a, b)];
+    assert(slot.edge == NULL);
+    slot.a = a;
+    slot.b = b;
+    slot.edge = edge;
+    _count++;
+}
+
+
+void EdgeTable::removeEdge(VertInf *v1, VertInf *v2)
+{
+    unsigned int a = std::min(v1->index, v2->index);
+    unsigned int b = std::max(v1->index, v2->index);
+
+    unsigned int mask = _slots.size() - 1;
+    unsigned int hole = slotOf(a, b);
+    assert(_slots[hole].edge != NULL);
+    _slots[hole].edge = NULL;
+    _count--;
+
+    // Moves back the following entries that can't be found anymore.
+    for (unsigned int s = (hole + 1) & mask; _slots[s].edge;
+            s = (s + 1) & mask)
+    {
+        Slot moved = _slots[s];
+        _slots[s].edge = NULL;
+        _slots[slotOf(moved.a, moved.b)] = moved;
+    }
+}
+
+
+EdgeInf *EdgeTable::find(VertInf *v1, VertInf *v2) const
+{
+    if (_slots.empty())
+    {
+        return NULL;
+    }
+    unsigned int a = std::min(v1->index, v2->index);
+    unsigned int b = std::max(v1->index, v2->index);
+
+    return _slots[slotOf(a, b)].edge;
+}
+
+
 }
 
 
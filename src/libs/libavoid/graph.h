@@ -26,6 +26,8 @@
 
 #include <cassert>
 #include <list>
+#include <map>
+#include <vector>
 #include <utility>
 #include "libavoid/vertices.h"
 
@@ -36,21 +38,39 @@ class Router;
 
 
 typedef std::list<int> ShapeList;
-typedef std::list<bool *> FlagList;
 
+// A connector using an edge, chained with the others by index in the
+// flag arena of the router.  The connector keeps track of the edges it
+// is registered with (cf. ConnRef::clearFlags), so that none of them
+// refers to it once it is deleted or rerouted.
+struct ConnFlag
+{
+    ConnRef *conn;
+    unsigned int next;
+};
+
+class EdgeInf;
+// The first invisibility edge blocked by each shape (or -1, for cycles),
+// the others being chained through EdgeInf::blkNext.
+typedef std::map<int, EdgeInf *> BlockerMap;
 
+
+// Edges are allocated in the edge arena of their router (cf. Arena),
+// through create and destroy.
+//
 class EdgeInf
 {
     public:
-        EdgeInf(VertInf *v1, VertInf *v2);
-        ~EdgeInf();
+        static EdgeInf *create(VertInf *v1, VertInf *v2);
+        void destroy(void);
         inline double getDist(void)
         {
             return _dist;
         }
         void setDist(double dist);
         void alertConns(void);
-        void addConn(bool *flag);
+        void addConn(ConnRef *conn);
+        void removeConn(ConnRef *conn);
         void addCycleBlocker(void);
         void addBlocker(int b);
 
@@ -65,6 +85,9 @@ class EdgeInf
 
         EdgeInf *lstPrev;
         EdgeInf *lstNext;
+        unsigned int lstOrder;
+        EdgeInf *blkPrev;
+        EdgeInf *blkNext;
         int _blocker;
     private:
         Router *_router;
@@ -72,15 +95,28 @@ class EdgeInf
         bool _visible;
         VertInf *_v1;
         VertInf *_v2;
-        EdgeInfList::iterator _pos1;
-        EdgeInfList::iterator _pos2;
-        FlagList  _conns;
+        unsigned int _index;
+        // Links in the EdgeInfLists of _v1 ([0]) and _v2 ([1]).
+        unsigned int _prev[2];
+        unsigned int _next[2];
+        unsigned int _firstConn;
         double  _dist;
 
+        EdgeInf(VertInf *v1, VertInf *v2);
+        ~EdgeInf();
+        unsigned int side(const VertInf *vert) const
+        {
+            return (vert == _v1) ? 0 : 1;
+        }
+        void clearConns(bool alert);
         void makeActive(void);
         void makeInactive(void);
+        void setBlocker(int b);
         int firstBlocker(void);
         bool isBetween(VertInf *i, VertInf *j);
+
+        friend class EdgeInfList;
+        friend class EdgeInfList::iterator;
 };
 
 
@@ -96,9 +132,87 @@ class EdgeList
         EdgeInf *_firstEdge;
         EdgeInf *_lastEdge;
         unsigned int _count;
+        unsigned int _order;
+};
+
+
+// The edges in the graph (visible or not), by the indices of their two
+// vertices, so that existingEdge doesn't have to go through the edge
+// lists of a vertex.  An open addressing hash table.
+//
+class EdgeTable
+{
+    public:
+        EdgeTable();
+        void addEdge(EdgeInf *edge, VertInf *v1, VertInf *v2);
+        void removeEdge(VertInf *v1, VertInf *v2);
+        EdgeInf *find(VertInf *v1, VertInf *v2) const;
+    private:
+        struct Slot
+        {
+            unsigned int a;
+            unsigned int b;
+            EdgeInf *edge;
+        };
+        std::vector<Slot> _slots;
+        unsigned int _count;
+
+        unsigned int slotOf(unsigned int a, unsigned int b) const;
+        void grow(void);
 };
 
 
+inline EdgeInf *EdgeInfList::iterator::operator*() const
+{
+    return _edges->at(_index);
+}
+
+
+inline EdgeInfList::iterator& EdgeInfList::iterator::operator++()
+{
+    EdgeInf *edge = _edges->at(_index);
+    _index = edge->_next[edge->side(_vert)];
+    return *this;
+}
+
+
+inline void EdgeInfList::push_front(EdgeInf *edge)
+{
+    unsigned int s = edge->side(_vert);
+    edge->_prev[s] = NoIndex;
+    edge->_next[s] = _first;
+    if (_first != NoIndex)
+    {
+        EdgeInf *first = _edges->at(_first);
+        first->_prev[first->side(_vert)] = edge->_index;
+    }
+    _first = edge->_index;
+}
+
+
+inline void EdgeInfList::erase(EdgeInf *edge)
+{
+    unsigned int s = edge->side(_vert);
+    unsigned int prev = edge->_prev[s];
+    unsigned int next = edge->_next[s];
+    if (prev != NoIndex)
+    {
+        EdgeInf *p = _edges->at(prev);
+        p->_next[p->side(_vert)] = next;
+    }
+    else
+    {
+        _first = next;
+    }
+    if (next != NoIndex)
+    {
+        EdgeInf *n = _edges->at(next);
+        n->_prev[n->side(_vert)] = prev;
+    }
+    edge->_prev[s] = edge->_next[s] = NoIndex;
+}
+
+
 }
 
 
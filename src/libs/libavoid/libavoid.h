@@ -35,6 +35,8 @@
 #include "libavoid/static.h"
 #include "libavoid/region.h"
 #include "libavoid/router.h"
+#include "libavoid/shapeindex.h"
+#include "libavoid/orthogonal.h"
 
 #endif
 
@@ -39,6 +39,170 @@
 namespace Avoid {
 
 
+PathSearch::PathSearch()
+    : directEdge(NULL)
+    , _currSearchNum(0)
+    , _opened(0)
+{
+}
+
+
+// Makes room for every vertex currently known by the router.
+//
+void PathSearch::prepare(Router *router)
+{
+    unsigned int limit = router->vertArena.size();
+    if (_pathNext.size() < limit)
+    {
+        _pathNext.resize(limit, NULL);
+        _pathDist.resize(limit, 0);
+        _f.resize(limit, 0);
+        _parent.resize(limit, NULL);
+        _order.resize(limit, 0);
+        _heapPos.resize(limit, -1);
+        _searchNum.resize(limit, 0);
+    }
+    directEdge = NULL;
+}
+
+
+// Forgets every vertex seen by the previous search.
+//
+void PathSearch::beginSearch(void)
+{
+    _heap.clear();
+    _opened = 0;
+    if (++_currSearchNum == 0)
+    {
+        // Wrapped around: old marks could be taken for current ones.
+        std::fill(_searchNum.begin(), _searchNum.end(), 0);
+        _currSearchNum = 1;
+    }
+}
+
+
+bool PathSearch::isUnseen(VertInf *vert)
+{
+    return (_searchNum[vert->index] != _currSearchNum);
+}
+
+
+bool PathSearch::isOpen(VertInf *vert)
+{
+    return !isUnseen(vert) && (_heapPos[vert->index] >= 0);
+}
+
+
+void PathSearch::open(VertInf *vert, double g, double f, VertInf *parent)
+{
+    unsigned int i = vert->index;
+    _searchNum[i] = _currSearchNum;
+    _pathDist[i] = g;
+    _f[i] = f;
+    _parent[i] = parent;
+    _order[i] = _opened++;
+    _heapPos[i] = _heap.size();
+    _heap.push_back(vert);
+    siftUp(_heap.size() - 1);
+}
+
+
+// Gives a better g to a vertex already seen.  An open vertex moves up
+// the heap, a closed one is just given its new parent.
+//
+void PathSearch::improve(VertInf *vert, double g, double f, VertInf *parent)
+{
+    unsigned int i = vert->index;
+    _pathDist[i] = g;
+    _f[i] = f;
+    _parent[i] = parent;
+    if (_heapPos[i] >= 0)
+    {
+        siftUp(_heapPos[i]);
+    }
+}
+
+
+// Removes the open vertex with the lowest f, or returns NULL if
+// there is none left.
+//
+VertInf *PathSearch::closeBest(void)
+{
+    if (_heap.empty())
+    {
+        return NULL;
+    }
+    VertInf *best = _heap.front();
+    _heapPos[best->index] = -1;
+
+    VertInf *last = _heap.back();
+    _heap.pop_back();
+    if (!_heap.empty())
+    {
+        _heap[0] = last;
+        _heapPos[last->index] = 0;
+        siftDown(0);
+    }
+    return best;
+}
+
+
+bool PathSearch::before(const unsigned int a, const unsigned int b)
+{
+    unsigned int i = _heap[a]->index;
+    unsigned int j = _heap[b]->index;
+    if (_f[i] != _f[j])
+    {
+        return (_f[i] < _f[j]);
+    }
+    return (_order[i] < _order[j]);
+}
+
+
+void PathSearch::siftUp(unsigned int pos)
+{
+    while (pos > 0)
+    {
+        unsigned int up = (pos - 1) / 2;
+        if (!before(pos, up))
+        {
+            break;
+        }
+        std::swap(_heap[pos], _heap[up]);
+        _heapPos[_heap[pos]->index] = pos;
+        _heapPos[_heap[up]->index] = up;
+        pos = up;
+    }
+}
+
+
+void PathSearch::siftDown(unsigned int pos)
+{
+    for (;;)
+    {
+        unsigned int best = pos;
+        unsigned int left = (2 * pos) + 1;
+        unsigned int right = left + 1;
+        if ((left < _heap.size()) && before(left, best))
+        {
+            best = left;
+        }
+        if ((right < _heap.size()) && before(right, best))
+        {
+            best = right;
+        }
+        if (best == pos)
+        {
+            break;
+        }
+        std::swap(_heap[pos], _heap[best]);
+        _heapPos[_heap[pos]->index] = pos;
+        _heapPos[_heap[best]->index] = best;
+        pos = best;
+    }
+}
+
+
 static double Dot(const Point& l, const Point& r)
 {
     return (l.x * r.x) + (l.y * r.y);
@@ -68,12 +232,12 @@ static double angleBetween(const Point& p1, const Point& p2, const Point& p3)
 // cost associated with this route.
 //
 double cost(ConnRef *lineRef, const double dist, VertInf *inf1,
-        VertInf *inf2, VertInf *inf3)
+        VertInf *inf2, VertInf *inf3, PathSearch& search)
 {
     double result = dist;
 
     Router *router = inf2->_router;
-    if (inf2->pathNext != NULL)
+    if (search.pathNext(inf2) != NULL)
     {
         double& angle_penalty = router->angle_penalty;
         double& segmt_penalty = router->segmt_penalty;
@@ -163,7 +327,7 @@ double cost(ConnRef *lineRef, const double dist, VertInf *inf1,
                     // And a2 and its pair in b are a split.
                     assert(a2 != b2);
 
-                    if (inf2->pathNext == NULL)
+                    if (search.pathNext(inf2) == NULL)
                     {
                         continue;
                     }
@@ -183,7 +347,7 @@ double cost(ConnRef *lineRef, const double dist, VertInf *inf1,
                                 a0, a1, a2, normal ? b2 : b0);
 
                         
-                        VertInf *traceInf1 = inf2->pathNext;
+                        VertInf *traceInf1 = search.pathNext(inf2);
                         VertInf *traceInf2 = inf2;
                         VertInf *traceInf3 = inf3;
                         while (traceInf1 &&
@@ -192,7 +356,7 @@ double cost(ConnRef *lineRef, const double dist, VertInf *inf1,
                         {
                             traceInf3 = traceInf2;
                             traceInf2 = traceInf1;
-                            traceInf1 = traceInf1->pathNext;
+                            traceInf1 = search.pathNext(traceInf1);
                             traceJ += dir;
                         }
                         
@@ -264,11 +428,12 @@ double cost(ConnRef *lineRef, const double dist, VertInf *inf1,
 // Returns the best path from src to tar using the cost function.
 //
 // The path is worked out via Dijkstra's algorithm, and is encoded via
-// pathNext links in each of the VerInfs along the path.
+// the pathNext links of the search, for each of the VerInfs along the path.
 //
 // Based on the code of 'matrixpfs'.
 //
-static void dijkstraPath(ConnRef *lineRef, VertInf *src, VertInf *tar)
+static void dijkstraPath(ConnRef *lineRef, VertInf *src, VertInf *tar,
+        PathSearch& search)
 {
     Router *router = src->_router;
 
@@ -278,8 +443,8 @@ static void dijkstraPath(ConnRef *lineRef, VertInf *src, VertInf *tar)
     VertInf *finish = router->vertices.end();
     for (VertInf *t = router->vertices.connsBegin(); t != finish; t = t->lstNext)
     {
-        t->pathNext = NULL;
-        t->pathDist = -unseen;
+        search.pathNext(t) = NULL;
+        search.pathDist(t) = -unseen;
     }
 
     VertInf *min = src;
@@ -288,10 +453,11 @@ static void dijkstraPath(ConnRef *lineRef, VertInf *src, VertInf *tar)
         VertInf *k = min;
         min = NULL;
 
-        k->pathDist *= -1;
-        if (k->pathDist == unseen)
+        double& kDist = search.pathDist(k);
+        kDist *= -1;
+        if (kDist == unseen)
         {
-            k->pathDist = 0;
+            kDist = 0;
         }
 
         EdgeInfList& visList = k->visList;
@@ -303,19 +469,21 @@ static void dijkstraPath(ConnRef *lineRef, VertInf *src, VertInf *tar)
             VertID tID = t->id;
 
             // Only check shape verticies, or endpoints.
-            if ((t->pathDist < 0) &&
+            double& tDist = search.pathDist(t);
+            if ((tDist < 0) &&
                     ((tID.objID == src->id.objID) || tID.isShape))
             {
                 double kt_dist = (*edge)->getDist();
-                double priority = k->pathDist +
-                        cost(lineRef, kt_dist, k->pathNext, k, t);
+                double priority = kDist +
+                        cost(lineRef, kt_dist, search.pathNext(k), k, t,
+                                search);
 
-                if ((kt_dist != 0) && (t->pathDist < -priority))
+                if ((kt_dist != 0) && (tDist < -priority))
                 {
-                    t->pathDist = -priority;
-                    t->pathNext = k;
+                    tDist = -priority;
+                    search.pathNext(t) = k;
                 }
-                if ((min == NULL) || (t->pathDist > min->pathDist))
+                if ((min == NULL) || (tDist > search.pathDist(min)))
                 {
                     min = t;
                 }
@@ -330,10 +498,11 @@ static void dijkstraPath(ConnRef *lineRef, VertInf *src, VertInf *tar)
             VertID tID = t->id;
 
             // Only check shape verticies, or endpoints.
-            if ((t->pathDist < 0) &&
+            double tDist = search.pathDist(t);
+            if ((tDist < 0) &&
                     ((tID.objID == src->id.objID) || tID.isShape > 0))
             {
-                if ((min == NULL) || (t->pathDist > min->pathDist))
+                if ((min == NULL) || (tDist > search.pathDist(min)))
                 {
                     min = t;
                 }
@@ -343,124 +512,49 @@ static void dijkstraPath(ConnRef *lineRef, VertInf *src, VertInf *tar)
 }
 
 
-class ANode
-{
-    public:
-        VertInf* inf;
-        double g;        // Gone
-        double h;        // Heuristic
-        double f;        // Formula f = g + h
-        VertInf *pp;
-
-        ANode(VertInf *vinf)
-            : inf(vinf)
-            , g(0)
-            , h(0)
-            , f(0)
-            , pp(NULL)
-        {
-        }
-        ANode()
-            : inf(NULL)
-            , g(0)
-            , h(0)
-            , f(0)
-            , pp(NULL)
-        {
-        }
-};
-
-bool operator<(const ANode &a, const ANode &b)
-{
-    return a.f < b.f;
-}
-
-
-bool operator>(const ANode &a, const ANode &b)
-{
-    return a.f > b.f;
-}
-
-
 // Returns the best path from src to tar using the cost function.
 //
 // The path is worked out using the aStar algorithm, and is encoded via
-// pathNext links in each of the VerInfs along the path.
-//
-// The aStar STL code is based on public domain code available on the
-// internet.
+// the pathNext links of the search, for each of the VerInfs along the path.
+// A vertex gets its pathNext once closed (cost() looks at it to know the
+// previous segment); a closed vertex reached at a lower cost gets its
+// pathNext updated, but isn't expanded again.  The search stops as soon
+// as tar is closed.
 //
-static void aStarPath(ConnRef *lineRef, VertInf *src, VertInf *tar)
+static void aStarPath(ConnRef *lineRef, VertInf *src, VertInf *tar,
+        PathSearch& search)
 {
-    std::vector<ANode> PENDING;     // STL Vectors chosen because of rapid
-    std::vector<ANode> DONE;        // insertions/deletions at back,
-    ANode Node, BestNode;           // Temporary Node and BestNode
-    bool bNodeFound = false;        // Flag if node is found in container
-
-    tar->pathNext = NULL;
-
-    // Create the start node
-    Node = ANode(src);
-    Node.g = 0;
-    Node.h = dist(Node.inf->point, tar->point);
-    Node.f = Node.g + Node.h;
-    // Set a null parent, so cost function knows this is the first segment.
-    Node.pp = NULL;
-
-    // Populate the PENDING container with the first location
-    PENDING.push_back(Node);
-    // Create a heap from PENDING for sorting
-    using std::make_heap; using std::push_heap; using std::pop_heap;
-    make_heap( PENDING.begin(), PENDING.end() );
-
-    while (!PENDING.empty())
-    {
-        // Ascending sort based on overloaded operators below
-        sort_heap(PENDING.begin(), PENDING.end());
+    search.beginSearch();
+    search.pathNext(tar) = NULL;
 
-        // Set the Node with lowest f value to BESTNODE
-        BestNode = PENDING.front();
+    // Start with src, with a null parent, so cost function knows this
+    // is the first segment.
+    double h = dist(src->point, tar->point);
+    search.open(src, 0, h, NULL);
 
-        // Pop off the heap.  Actually this moves the
-        // far left value to the far right.  The node
-        // is not actually removed since the pop is to
-        // the heap and not the container.
-        pop_heap(PENDING.begin(), PENDING.end());
-
-
-        // Remove node from right (the value we pop_heap'd)
-        PENDING.pop_back();
-
-        // Push the BestNode onto DONE
-        BestNode.inf->pathNext = BestNode.pp;
-        DONE.push_back(BestNode);
-
-#if 0
-        printf("Considering... ");
-        BestNode.ID->print(stdout);
-        printf(" - g: %3.1f h: %3.1f f: %3.1f back: ", BestNode.g, BestNode.h,
-                BestNode.f);
-        BestNode.pp.print(stdout);
-        printf("\n");
-#endif
+    VertInf *best;
+    while ((best = search.closeBest()) != NULL)
+    {
+        search.pathNext(best) = search.parent(best);
 
         // If at destination, break and create path below
-        if (BestNode.inf == tar)
+        if (best == tar)
         {
-            //bPathFound = true; // arrived at destination...
             break;
         }
 
+        double bestG = search.pathDist(best);
+
         // Check adjacent points in graph
-        EdgeInfList& visList = BestNode.inf->visList;
+        EdgeInfList& visList = best->visList;
         EdgeInfList::iterator finish = visList.end();
         for (EdgeInfList::iterator edge = visList.begin(); edge != finish;
                 ++edge)
         {
-            Node.inf = (*edge)->otherVert(BestNode.inf);
+            VertInf *inf = (*edge)->otherVert(best);
 
             // Only check shape verticies, or the tar endpoint.
-            if (!(Node.inf->id.isShape) && (Node.inf != tar))
+            if (!(inf->id.isShape) && (inf != tar))
             {
                 continue;
             }
@@ -472,84 +566,26 @@ static void aStarPath(ConnRef *lineRef, VertInf *src, VertInf *tar)
                 continue;
             }
 
-            VertInf *prevInf = BestNode.inf->pathNext;
+            VertInf *prevInf = search.pathNext(best);
 
-            Node.g = BestNode.g + cost(lineRef, edgeDist, prevInf,
-                    BestNode.inf, Node.inf);
+            double g = bestG + cost(lineRef, edgeDist, prevInf, best, inf,
+                    search);
 
-            // Calculate the Heuristic.
-            Node.h = dist(Node.inf->point, tar->point);
-
-            // The A* formula
-            Node.f = Node.g + Node.h;
-            // Point parent to last BestNode (pushed onto DONE)
-            Node.pp = BestNode.inf;
-
-            bNodeFound = false;
-
-            // Check to see if already on PENDING
-            for (unsigned int i = 0; i < PENDING.size(); i++)
-            {
-                if (Node.inf == PENDING.at(i).inf)
-                {   // If already on PENDING
-                    if (Node.g < PENDING.at(i).g)
-                    {
-                        PENDING.at(i).g = Node.g;
-                        PENDING.at(i).f = Node.g + PENDING.at(i).h;
-                        PENDING.at(i).pp = Node.pp;
-                    }
-                    bNodeFound = true;
-                    break;
-                }
-            }
-            if (!bNodeFound ) // If Node NOT found on PENDING
+            if (search.isUnseen(inf))
             {
-                // Check to see if already on DONE
-                for (unsigned int i = 0; i < DONE.size(); i++)
-                {
-                    if (Node.inf == DONE.at(i).inf)
-                    {
-                        // If on DONE, Which has lower gone?
-                        if (Node.g < DONE.at(i).g)
-                        {
-                            DONE.at(i).g = Node.g;
-                            DONE.at(i).f = Node.g + DONE.at(i).h;
-                            DONE.at(i).pp = Node.pp;
-                            DONE.at(i).inf->pathNext = Node.pp;
-                        }
-                        bNodeFound = true;
-                        break;
-                    }
-                }
+                // The A* formula
+                h = dist(inf->point, tar->point);
+                search.open(inf, g, g + h, best);
             }
-
-            if (!bNodeFound ) // If Node NOT found on PENDING or DONE
+            else if (g < search.pathDist(inf))
             {
-                // Push NewNode onto PENDING
-                PENDING.push_back(Node);
-                // Push NewNode onto heap
-                push_heap( PENDING.begin(), PENDING.end() );
-                // Re-Assert heap, or will be short by one
-                make_heap( PENDING.begin(), PENDING.end() );
-
-#if 0
-                // Display PENDING and DONE containers (For Debugging)
-                cout << "PENDING:   ";
-                for (int i = 0; i < PENDING.size(); i++)
-                {
-                    cout << PENDING.at(i).x << "," << PENDING.at(i).y << ",";
-                    cout << PENDING.at(i).g << "," << PENDING.at(i).h << "  ";
-                }
-                cout << endl;
-                cout << "DONE:   ";
-                for (int i = 0; i < DONE.size(); i++)
+                h = dist(inf->point, tar->point);
+                bool closed = !search.isOpen(inf);
+                search.improve(inf, g, g + h, best);
+                if (closed)
                 {
-                    cout << DONE.at(i).x << "," << DONE.at(i).y << ",";
-                    cout << DONE.at(i).g << "," << DONE.at(i).h << "  ";
+                    search.pathNext(inf) = best;
                 }
-                cout << endl << endl;
-                int ch = _getch();
-#endif
             }
         }
     }
@@ -558,15 +594,21 @@ static void aStarPath(ConnRef *lineRef, VertInf *src, VertInf *tar)
 
 // Returns the best path for the connector referred to by lineRef.
 //
-// The path encoded in the pathNext links in each of the VerInfs
-// backwards along the path, from the tar back to the source.
+// The path encoded in the pathNext links of the search, for each of the
+// VerInfs backwards along the path, from the tar back to the source.
+//
+// With IncludeEndpoints, the visibility graph is only read, so that
+// several searches may run concurrently.  Without it, the graph gets
+// updated with the edges between the endpoints.
 //
-void makePath(ConnRef *lineRef, bool *flag)
+void makePath(ConnRef *lineRef, PathSearch& search)
 {
     Router *router = lineRef->router();
     VertInf *src = lineRef->src();
     VertInf *tar = lineRef->dst();
 
+    search.prepare(router);
+
     // If the connector hates crossings then we want to examine direct paths:
     bool examineDirectPath = lineRef->doesHateCrossings();
     
@@ -579,18 +621,18 @@ void makePath(ConnRef *lineRef, bool *flag)
 
         assert(directEdge == NULL);
 
-        directEdge = new EdgeInf(src, tar);
-        tar->pathNext = src;
+        directEdge = EdgeInf::create(src, tar);
+        search.pathNext(tar) = src;
         directEdge->setDist(dist(p, q));
-        directEdge->addConn(flag);
+        directEdge->addConn(lineRef);
 
         return;
     }
     else if (router->IncludeEndpoints && directEdge &&
             (directEdge->getDist() > 0) && !examineDirectPath)
     {
-        tar->pathNext = src;
-        directEdge->addConn(flag);
+        search.pathNext(tar) = src;
+        search.directEdge = directEdge;
     }
     else
     {
@@ -600,18 +642,18 @@ void makePath(ConnRef *lineRef, bool *flag)
         {
             if (!directEdge)
             {
-                directEdge = new EdgeInf(src, tar);
+                directEdge = EdgeInf::create(src, tar);
             }
             directEdge->addBlocker(0);
         }
 
         if (router->UseAStarSearch)
         {
-            aStarPath(lineRef, src, tar);
+            aStarPath(lineRef, src, tar, search);
         }
         else
         {
-            dijkstraPath(lineRef, src, tar);
+            dijkstraPath(lineRef, src, tar, search);
         }
 
 #if 0
@@ -622,7 +664,7 @@ void makePath(ConnRef *lineRef, bool *flag)
 
             t->id.print();
             printf(" -> ");
-            t->pathNext->id.print();
+            search.pathNext(t)->id.print();
             printf("\n");
         }
 #endif
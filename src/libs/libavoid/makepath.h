@@ -23,12 +23,77 @@
 #ifndef AVOID_MAKEPATH_H
 #define AVOID_MAKEPATH_H
 
+#include <vector>
+#include "libavoid/vertices.h"
+
 
 namespace Avoid {
 
 class ConnRef;
+class EdgeInf;
+class Router;
+
+
+// The working state of a path search.  The best path found so far is
+// recorded here, via pathNext links indexed by VertInf::index, rather than
+// in the VerInfs themselves.  This way several searches can run at the
+// same time over the same (unchanging) visibility graph, each with its
+// own PathSearch.  The buffers are kept from one search to the next.
+//
+// For the aStar search, it also holds an indexed binary heap of the open
+// vertices (ordered by f, then by the order they were opened in), so that
+// the best one is found and improved in log time.  Vertices are marked
+// with the number of the search they were reached by, so nothing needs
+// clearing between searches.
+//
+class PathSearch
+{
+    public:
+        PathSearch();
+        void prepare(Router *router);
+        inline VertInf *& pathNext(VertInf *vert)
+        {
+            return _pathNext[vert->index];
+        }
+        inline double& pathDist(VertInf *vert)
+        {
+            return _pathDist[vert->index];
+        }
+
+        // aStar open and closed sets.
+        void beginSearch(void);
+        bool isUnseen(VertInf *vert);
+        bool isOpen(VertInf *vert);
+        void open(VertInf *vert, double g, double f, VertInf *parent);
+        void improve(VertInf *vert, double g, double f, VertInf *parent);
+        VertInf *closeBest(void);
+        inline VertInf *& parent(VertInf *vert)
+        {
+            return _parent[vert->index];
+        }
+
+        // The edge between the endpoints, if the search found it could
+        // be used directly.  It learns about the connector on commit.
+        EdgeInf *directEdge;
+    private:
+        bool before(const unsigned int a, const unsigned int b);
+        void siftUp(unsigned int pos);
+        void siftDown(unsigned int pos);
+
+        std::vector<VertInf *> _pathNext;
+        std::vector<double> _pathDist;   // The g of aStar.
+        std::vector<double> _f;
+        std::vector<VertInf *> _parent;
+        std::vector<unsigned int> _order;
+        std::vector<int> _heapPos;       // -1 once closed.
+        std::vector<unsigned int> _searchNum;
+        std::vector<VertInf *> _heap;
+        unsigned int _currSearchNum;
+        unsigned int _opened;
+};
+
 
-extern void makePath(ConnRef *lineRef, bool *flag);
+extern void makePath(ConnRef *lineRef, PathSearch& search);
 
 
 }
@@ -0,0 +1,783 @@
+/*
+ * vim: ts=4 sw=4 et tw=0 wm=0
+ *
+ * libavoid - Fast, Incremental, Object-avoiding Line Router
+ * Copyright (C) 2007-2009  Alice Villeger <alice.villeger@manchester.ac.uk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+*/
+
+#include <cassert>
+#include <climits>
+#include <set>
+#include <algorithm>
+#include <functional>
+#include <math.h>
+
+#include "libavoid/orthogonal.h"
+
+
+namespace Avoid {
+
+
+// Coordinates of points and boxes along (or across) the direction of the
+// segments being dealt with, so that horizontal and vertical segments
+// share the same code.
+//
+static inline double along(const Point& p, bool horizontal)
+{
+    return horizontal ? p.x : p.y;
+}
+
+
+static inline double across(const Point& p, bool horizontal)
+{
+    return horizontal ? p.y : p.x;
+}
+
+
+static inline Point makePoint(double a, double c, bool horizontal)
+{
+    return horizontal ? Point(a, c) : Point(c, a);
+}
+
+
+// A lower bound of the cost of a route from p to goal, arriving at p along
+// the given axis (0 for horizontal, 1 for vertical): the distance, plus a
+// bend unless the goal is straight along that axis.
+//
+static inline double estimate(const Point& p, int axis, const Point& goal,
+        double bendPenalty)
+{
+    double dx = fabs(goal.x - p.x);
+    double dy = fabs(goal.y - p.y);
+    bool straight = (axis == 0) ? (dy == 0) : (dx == 0);
+    return dx + dy + (straight ? 0 : bendPenalty);
+}
+
+
+OrthogonalSearch::OrthogonalSearch()
+    : _currSearchNum(0)
+{
+}
+
+
+OrthogonalRouter::OrthogonalRouter()
+    : shapeBuffer(10)
+    , segmentSpacing(6)
+    , bendPenalty(50)
+{
+    _bounds.a = _bounds.b = Point(0, 0);
+}
+
+
+int OrthogonalRouter::addShape(const BBox& box)
+{
+    _shapes.push_back(box);
+    return _shapes.size() - 1;
+}
+
+
+int OrthogonalRouter::addConnector(const Point& src, const Point& tar,
+        int srcShape, int tarShape)
+{
+    Conn conn;
+    conn.src = src;
+    conn.tar = tar;
+    conn.srcShape = srcShape;
+    conn.tarShape = tarShape;
+    conn.srcVert = conn.tarVert = -1;
+    _conns.push_back(conn);
+
+    std::vector<Point> straight;
+    straight.push_back(src);
+    straight.push_back(tar);
+    _routes.push_back(straight);
+
+    return _conns.size() - 1;
+}
+
+
+unsigned int OrthogonalRouter::shapeCount(void) const
+{
+    return _shapes.size();
+}
+
+
+unsigned int OrthogonalRouter::connectorCount(void) const
+{
+    return _conns.size();
+}
+
+
+const std::vector<Point>& OrthogonalRouter::route(unsigned int connector)
+        const
+{
+    return _routes[connector];
+}
+
+
+// Builds the orthogonal visibility graph of the shapes and connector end
+// points given so far.
+//
+void OrthogonalRouter::buildGraph(void)
+{
+    _verts.clear();
+
+    // Every segment stays within these bounds.
+    bool first = true;
+    for (unsigned int i = 0; i < _shapes.size(); ++i)
+    {
+        const BBox& box = _shapes[i];
+        if (first)
+        {
+            _bounds = box;
+            first = false;
+        }
+        _bounds.a.x = std::min(_bounds.a.x, box.a.x);
+        _bounds.a.y = std::min(_bounds.a.y, box.a.y);
+        _bounds.b.x = std::max(_bounds.b.x, box.b.x);
+        _bounds.b.y = std::max(_bounds.b.y, box.b.y);
+    }
+    for (unsigned int i = 0; i < _conns.size(); ++i)
+    {
+        const Point *ends[2] = { &_conns[i].src, &_conns[i].tar };
+        for (int e = 0; e < 2; ++e)
+        {
+            if (first)
+            {
+                _bounds.a = _bounds.b = *ends[e];
+                first = false;
+            }
+            _bounds.a.x = std::min(_bounds.a.x, ends[e]->x);
+            _bounds.a.y = std::min(_bounds.a.y, ends[e]->y);
+            _bounds.b.x = std::max(_bounds.b.x, ends[e]->x);
+            _bounds.b.y = std::max(_bounds.b.y, ends[e]->y);
+        }
+    }
+    double margin = 2 * shapeBuffer;
+    _bounds.a.x -= margin;
+    _bounds.a.y -= margin;
+    _bounds.b.x += margin;
+    _bounds.b.y += margin;
+
+    std::vector<Segment> hSegs;
+    std::vector<Segment> vSegs;
+    makeSegments(hSegs, true);
+    makeSegments(vSegs, false);
+
+    VertexMap vertexMap;
+    crossSegments(hSegs, vSegs, vertexMap);
+
+    for (unsigned int i = 0; i < hSegs.size(); ++i)
+    {
+        linkSegment(hSegs[i], true);
+    }
+    for (unsigned int i = 0; i < vSegs.size(); ++i)
+    {
+        linkSegment(vSegs[i], false);
+    }
+
+    // Each end point is where its own segments cross.
+    for (unsigned int i = 0; i < _conns.size(); ++i)
+    {
+        Conn& conn = _conns[i];
+        VertexMap::iterator src =
+                vertexMap.find(std::make_pair(conn.src.x, conn.src.y));
+        VertexMap::iterator tar =
+                vertexMap.find(std::make_pair(conn.tar.x, conn.tar.y));
+        conn.srcVert = (src != vertexMap.end()) ? src->second : -1;
+        conn.tarVert = (tar != vertexMap.end()) ? tar->second : -1;
+    }
+}
+
+
+// An interesting point, and the shape it is in (for end points).
+struct Interesting
+{
+    Point point;
+    int shape;
+};
+
+
+// Sweep events: shapes are closed before the points at the same position
+// are dealt with, and opened after them, so that a segment may run along
+// the side of a shape.
+enum { CloseShape = 0, AtPoint = 1, OpenShape = 2 };
+
+// The other way round for horizontal segments, when looking for their
+// crossings with vertical ones: the segments ending where a vertical
+// segment is still cross it.
+enum { SegmentStart = 0, AtSegment = 1, SegmentEnd = 2 };
+
+struct SweepEvent
+{
+    double pos;
+    int type;
+    int index;
+
+    bool operator<(const SweepEvent& rhs) const
+    {
+        if (pos != rhs.pos)
+        {
+            return pos < rhs.pos;
+        }
+        if (type != rhs.type)
+        {
+            return type < rhs.type;
+        }
+        return index < rhs.index;
+    }
+};
+
+
+// Generates the horizontal (or vertical) segments of the interesting
+// points, sweeping across them: the open shapes are kept ordered by their
+// near and far sides, so that the first shape blocking each way is found
+// in O(log n).  The shape an end point is in does not block it, as it
+// starts before the point and ends after it.
+//
+void OrthogonalRouter::makeSegments(std::vector<Segment>& segments,
+        bool horizontal)
+{
+    std::vector<Interesting> points;
+    for (unsigned int i = 0; i < _shapes.size(); ++i)
+    {
+        const BBox& box = _shapes[i];
+        Interesting corner;
+        corner.shape = NoShape;
+        double x[2] = { box.a.x - shapeBuffer, box.b.x + shapeBuffer };
+        double y[2] = { box.a.y - shapeBuffer, box.b.y + shapeBuffer };
+        for (int cx = 0; cx < 2; ++cx)
+        {
+            for (int cy = 0; cy < 2; ++cy)
+            {
+                corner.point = Point(x[cx], y[cy]);
+                points.push_back(corner);
+            }
+        }
+    }
+    for (unsigned int i = 0; i < _conns.size(); ++i)
+    {
+        Interesting end;
+        end.point = _conns[i].src;
+        end.shape = _conns[i].srcShape;
+        points.push_back(end);
+        end.point = _conns[i].tar;
+        end.shape = _conns[i].tarShape;
+        points.push_back(end);
+    }
+
+    std::vector<SweepEvent> events;
+    events.reserve(2 * _shapes.size() + points.size());
+    for (unsigned int i = 0; i < _shapes.size(); ++i)
+    {
+        SweepEvent open = { across(_shapes[i].a, horizontal), OpenShape,
+                (int) i };
+        SweepEvent close = { across(_shapes[i].b, horizontal), CloseShape,
+                (int) i };
+        events.push_back(open);
+        events.push_back(close);
+    }
+    for (unsigned int i = 0; i < points.size(); ++i)
+    {
+        SweepEvent at = { across(points[i].point, horizontal), AtPoint,
+                (int) i };
+        events.push_back(at);
+    }
+    std::sort(events.begin(), events.end());
+
+    typedef std::set<std::pair<double, int> > SideSet;
+    SideSet nearSides;
+    SideSet farSides;
+    double minBound = along(_bounds.a, horizontal);
+    double maxBound = along(_bounds.b, horizontal);
+
+    for (unsigned int e = 0; e < events.size(); ++e)
+    {
+        const SweepEvent& event = events[e];
+        if (event.type != AtPoint)
+        {
+            const BBox& box = _shapes[event.index];
+            std::pair<double, int> nearSide(along(box.a, horizontal),
+                    event.index);
+            std::pair<double, int> farSide(along(box.b, horizontal),
+                    event.index);
+            if (event.type == OpenShape)
+            {
+                nearSides.insert(nearSide);
+                farSides.insert(farSide);
+            }
+            else
+            {
+                nearSides.erase(nearSide);
+                farSides.erase(farSide);
+            }
+            continue;
+        }
+
+        const Interesting& point = points[event.index];
+        double pos = along(point.point, horizontal);
+
+        Segment segment;
+        segment.pos = event.pos;
+        segment.shape = point.shape;
+
+        // The first shape starting after the point...
+        SideSet::iterator next =
+                nearSides.lower_bound(std::make_pair(pos, INT_MIN));
+        segment.hi = (next != nearSides.end()) ? next->first : maxBound;
+
+        // ... and the last one ending before it.
+        SideSet::iterator prev =
+                farSides.upper_bound(std::make_pair(pos, INT_MAX));
+        segment.lo = (prev != farSides.begin()) ? (--prev)->first : minBound;
+
+        segments.push_back(segment);
+    }
+
+    // Shapes side by side share corner segments.
+    std::vector<Segment> unique;
+    unique.reserve(segments.size());
+    std::vector<std::pair<std::pair<double, double>, std::pair<double, int> > >
+            keys;
+    for (unsigned int i = 0; i < segments.size(); ++i)
+    {
+        keys.push_back(std::make_pair(
+                std::make_pair(segments[i].pos, segments[i].lo),
+                std::make_pair(segments[i].hi, (int) i)));
+    }
+    std::sort(keys.begin(), keys.end());
+    for (unsigned int k = 0; k < keys.size(); ++k)
+    {
+        const Segment& segment = segments[keys[k].second.second];
+        if (!unique.empty() && (unique.back().pos == segment.pos) &&
+                (unique.back().lo == segment.lo) &&
+                (unique.back().hi == segment.hi) &&
+                (unique.back().shape == segment.shape))
+        {
+            continue;
+        }
+        unique.push_back(segment);
+    }
+    segments.swap(unique);
+}
+
+
+// Finds where the horizontal and vertical segments cross, sweeping along
+// the horizontal ones: each vertical segment crosses the horizontal
+// segments open at its position, and within its extent.  Crossings at
+// the same point (collinear segments) make a single vertex.
+//
+void OrthogonalRouter::crossSegments(std::vector<Segment>& hSegs,
+        std::vector<Segment>& vSegs, VertexMap& vertexMap)
+{
+    std::vector<SweepEvent> events;
+    events.reserve(2 * hSegs.size() + vSegs.size());
+    for (unsigned int i = 0; i < hSegs.size(); ++i)
+    {
+        SweepEvent open = { hSegs[i].lo, SegmentStart, (int) i };
+        SweepEvent close = { hSegs[i].hi, SegmentEnd, (int) i };
+        events.push_back(open);
+        events.push_back(close);
+    }
+    for (unsigned int i = 0; i < vSegs.size(); ++i)
+    {
+        SweepEvent at = { vSegs[i].pos, AtSegment, (int) i };
+        events.push_back(at);
+    }
+    std::sort(events.begin(), events.end());
+
+    typedef std::set<std::pair<double, int> > OpenSet;
+    OpenSet open;
+    for (unsigned int e = 0; e < events.size(); ++e)
+    {
+        const SweepEvent& event = events[e];
+        if (event.type == SegmentStart)
+        {
+            open.insert(std::make_pair(hSegs[event.index].pos, event.index));
+            continue;
+        }
+        if (event.type == SegmentEnd)
+        {
+            open.erase(std::make_pair(hSegs[event.index].pos, event.index));
+            continue;
+        }
+
+        Segment& vSeg = vSegs[event.index];
+        OpenSet::iterator it = open.lower_bound(
+                std::make_pair(vSeg.lo, INT_MIN));
+        for (; (it != open.end()) && (it->first <= vSeg.hi); ++it)
+        {
+            std::pair<double, double> key(vSeg.pos, it->first);
+            VertexMap::iterator found = vertexMap.find(key);
+            int v;
+            if (found == vertexMap.end())
+            {
+                Vert vert;
+                vert.point = Point(vSeg.pos, it->first);
+                for (int d = 0; d < 4; ++d)
+                {
+                    vert.next[d] = -1;
+                    vert.inside[d] = NoShape;
+                }
+                v = _verts.size();
+                _verts.push_back(vert);
+                vertexMap[key] = v;
+            }
+            else
+            {
+                v = found->second;
+            }
+            vSeg.verts.push_back(v);
+            hSegs[it->second].verts.push_back(v);
+        }
+    }
+}
+
+
+// Orders the vertices of a segment, and links each one to the next.
+// Where the segment of an end point goes through its shape, only the
+// connectors of that shape may use it.
+//
+void OrthogonalRouter::linkSegment(Segment& segment, bool horizontal)
+{
+    std::vector<std::pair<double, int> > order;
+    for (unsigned int i = 0; i < segment.verts.size(); ++i)
+    {
+        int v = segment.verts[i];
+        order.push_back(std::make_pair(along(_verts[v].point, horizontal),
+                v));
+    }
+    std::sort(order.begin(), order.end());
+    order.erase(std::unique(order.begin(), order.end()), order.end());
+
+    int forth = horizontal ? Right : Down;
+    int back = horizontal ? Left : Up;
+    for (unsigned int i = 1; i < order.size(); ++i)
+    {
+        int u = order[i - 1].second;
+        int v = order[i].second;
+
+        int inside = NoShape;
+        if (segment.shape != NoShape)
+        {
+            const BBox& box = _shapes[segment.shape];
+            if ((order[i - 1].first < along(box.b, horizontal)) &&
+                    (order[i].first > along(box.a, horizontal)))
+            {
+                inside = segment.shape;
+            }
+        }
+
+        // Collinear segments may link the same vertices.
+        Vert& from = _verts[u];
+        if ((from.next[forth] == -1) || (from.inside[forth] != NoShape))
+        {
+            from.next[forth] = v;
+            from.inside[forth] = inside;
+        }
+        Vert& to = _verts[v];
+        if ((to.next[back] == -1) || (to.inside[back] != NoShape))
+        {
+            to.next[back] = u;
+            to.inside[back] = inside;
+        }
+    }
+}
+
+
+// Searches the route of a connector with the fewest bends and the
+// shortest length (A*, on states made of a vertex and the axis the
+// route arrives along), and keeps its corners.  Returns false if there
+// is none, the connector then goes straight.
+//
+bool OrthogonalRouter::searchRoute(unsigned int connector,
+        OrthogonalSearch& search)
+{
+    const Conn& conn = _conns[connector];
+    std::vector<Point>& route = _routes[connector];
+    route.clear();
+    route.push_back(conn.src);
+
+    if ((conn.srcVert == -1) || (conn.tarVert == -1) ||
+            (conn.srcVert == conn.tarVert))
+    {
+        route.push_back(conn.tar);
+        return conn.srcVert == conn.tarVert;
+    }
+
+    unsigned int states = 2 * _verts.size();
+    if (search._dist.size() < states)
+    {
+        search._dist.resize(states, 0);
+        search._parent.resize(states, -1);
+        search._searchNum.resize(states, 0);
+    }
+    if (++search._currSearchNum == 0)
+    {
+        std::fill(search._searchNum.begin(), search._searchNum.end(), 0);
+        search._currSearchNum = 1;
+    }
+    unsigned int num = search._currSearchNum;
+    std::vector<OrthogonalSearch::Open>& heap = search._heap;
+    std::greater<OrthogonalSearch::Open> after;
+    heap.clear();
+
+    const Point& goal = _verts[conn.tarVert].point;
+
+    // The route may set off along either axis.
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        int s = 2 * conn.srcVert + axis;
+        search._dist[s] = 0;
+        search._parent[s] = -1;
+        search._searchNum[s] = num;
+        const Point& p = _verts[conn.srcVert].point;
+        OrthogonalSearch::Open open = { estimate(p, axis, goal, bendPenalty),
+                0, s };
+        heap.push_back(open);
+        std::push_heap(heap.begin(), heap.end(), after);
+    }
+
+    int found = -1;
+    while (!heap.empty())
+    {
+        std::pop_heap(heap.begin(), heap.end(), after);
+        double f = heap.back().f;
+        int s = heap.back().state;
+        heap.pop_back();
+
+        int v = s / 2;
+        const Vert& vert = _verts[v];
+        double h = estimate(vert.point, s % 2, goal, bendPenalty);
+        if (f > search._dist[s] + h)
+        {
+            // Outdated.
+            continue;
+        }
+        if (v == conn.tarVert)
+        {
+            found = s;
+            break;
+        }
+
+        for (int d = 0; d < 4; ++d)
+        {
+            int w = vert.next[d];
+            if (w == -1)
+            {
+                continue;
+            }
+            int inside = vert.inside[d];
+            if ((inside != NoShape) && (inside != conn.srcShape) &&
+                    (inside != conn.tarShape))
+            {
+                continue;
+            }
+            int axis = (d == Left || d == Right) ? 0 : 1;
+            const Point& q = _verts[w].point;
+            double g = search._dist[s] + fabs(q.x - vert.point.x) +
+                    fabs(q.y - vert.point.y);
+            if ((axis != (s % 2)) && (search._parent[s] != -1))
+            {
+                g += bendPenalty;
+            }
+            int t = 2 * w + axis;
+            if ((search._searchNum[t] == num) && (search._dist[t] <= g))
+            {
+                continue;
+            }
+            search._searchNum[t] = num;
+            search._dist[t] = g;
+            search._parent[t] = s;
+            OrthogonalSearch::Open open = {
+                    g + estimate(q, axis, goal, bendPenalty), g, t };
+            heap.push_back(open);
+            std::push_heap(heap.begin(), heap.end(), after);
+        }
+    }
+
+    if (found == -1)
+    {
+        route.push_back(conn.tar);
+        return false;
+    }
+
+    // Only the corners are kept, from the source on.
+    std::vector<int> path;
+    for (int s = found; s != -1; s = search._parent[s])
+    {
+        path.push_back(s);
+    }
+    for (int k = path.size() - 2; k > 0; --k)
+    {
+        if ((path[k] % 2) != (path[k - 1] % 2))
+        {
+            route.push_back(_verts[path[k] / 2].point);
+        }
+    }
+    route.push_back(conn.tar);
+    return true;
+}
+
+
+// Spreads the segments of different connectors that overlap on the same
+// line, horizontal ones first.
+//
+void OrthogonalRouter::nudge(void)
+{
+    nudgeSegments(true);
+    nudgeSegments(false);
+}
+
+
+// A segment of a route that can be moved sideways, along with the two
+// segments around it.
+struct Piece
+{
+    double pos, lo, hi;
+    // Where the routes comes from and goes to, across the segment.
+    double side;
+    unsigned int route;
+    unsigned int index;
+
+    bool operator<(const Piece& rhs) const
+    {
+        if (pos != rhs.pos)
+        {
+            return pos < rhs.pos;
+        }
+        return lo < rhs.lo;
+    }
+};
+
+
+static bool sideOrder(const Piece& p, const Piece& q)
+{
+    if (p.side != q.side)
+    {
+        return p.side < q.side;
+    }
+    return p.route < q.route;
+}
+
+
+// Overlapping segments on a line get spaced by segmentSpacing, ordered
+// by where their routes come from and go to, so as not to add crossings.
+// They stay clear of the shapes along the line.  The first and last
+// segments of a route are left alone, as they hold its end points.
+//
+void OrthogonalRouter::nudgeSegments(bool horizontal)
+{
+    std::vector<Piece> pieces;
+    for (unsigned int r = 0; r < _routes.size(); ++r)
+    {
+        std::vector<Point>& route = _routes[r];
+        for (unsigned int k = 1; k + 2 < route.size(); ++k)
+        {
+            const Point& p = route[k];
+            const Point& q = route[k + 1];
+            if (across(p, horizontal) != across(q, horizontal))
+            {
+                continue;
+            }
+            Piece piece;
+            piece.pos = across(p, horizontal);
+            piece.lo = std::min(along(p, horizontal), along(q, horizontal));
+            piece.hi = std::max(along(p, horizontal), along(q, horizontal));
+            piece.side = (across(route[k - 1], horizontal) +
+                    across(route[k + 2], horizontal)) / 2;
+            piece.route = r;
+            piece.index = k;
+            pieces.push_back(piece);
+        }
+    }
+    std::sort(pieces.begin(), pieces.end());
+
+    unsigned int first = 0;
+    while (first < pieces.size())
+    {
+        // The pieces overlapping each other on the same line.
+        unsigned int last = first + 1;
+        double lo = pieces[first].lo;
+        double hi = pieces[first].hi;
+        while ((last < pieces.size()) &&
+                (pieces[last].pos == pieces[first].pos) &&
+                (pieces[last].lo < hi))
+        {
+            hi = std::max(hi, pieces[last].hi);
+            ++last;
+        }
+        unsigned int count = last - first;
+        if (count < 2)
+        {
+            first = last;
+            continue;
+        }
+        double pos = pieces[first].pos;
+
+        // The free space on both sides of the line.
+        double minPos = across(_bounds.a, horizontal);
+        double maxPos = across(_bounds.b, horizontal);
+        for (unsigned int i = 0; i < _shapes.size(); ++i)
+        {
+            const BBox& box = _shapes[i];
+            if ((along(box.b, horizontal) <= lo) ||
+                    (along(box.a, horizontal) >= hi))
+            {
+                continue;
+            }
+            if (across(box.b, horizontal) <= pos)
+            {
+                minPos = std::max(minPos, across(box.b, horizontal));
+            }
+            else if (across(box.a, horizontal) >= pos)
+            {
+                maxPos = std::min(maxPos, across(box.a, horizontal));
+            }
+        }
+        minPos = std::min(minPos + shapeBuffer / 2, pos);
+        maxPos = std::max(maxPos - shapeBuffer / 2, pos);
+
+        double spacing = segmentSpacing;
+        if ((count - 1) * spacing > maxPos - minPos)
+        {
+            spacing = (maxPos - minPos) / (count - 1);
+        }
+        double start = pos - (count - 1) * spacing / 2;
+        start = std::max(start, minPos);
+        start = std::min(start, maxPos - (count - 1) * spacing);
+
+        std::sort(pieces.begin() + first, pieces.begin() + last, sideOrder);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            const Piece& piece = pieces[first + i];
+            double moved = start + i * spacing;
+            std::vector<Point>& route = _routes[piece.route];
+            Point& p = route[piece.index];
+            Point& q = route[piece.index + 1];
+            p = makePoint(along(p, horizontal), moved, horizontal);
+            q = makePoint(along(q, horizontal), moved, horizontal);
+        }
+        first = last;
+    }
+}
+
+
+}
+
+
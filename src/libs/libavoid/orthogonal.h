@@ -0,0 +1,174 @@
+/*
+ * vim: ts=4 sw=4 et tw=0 wm=0
+ *
+ * libavoid - Fast, Incremental, Object-avoiding Line Router
+ * Copyright (C) 2007-2009  Alice Villeger <alice.villeger@manchester.ac.uk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+*/
+
+#ifndef AVOID_ORTHOGONAL_H
+#define AVOID_ORTHOGONAL_H
+
+#include <map>
+#include <vector>
+#include <utility>
+#include "libavoid/geomtypes.h"
+
+
+namespace Avoid {
+
+class OrthogonalRouter;
+
+
+// The search buffers of one thread routing connectors with an
+// OrthogonalRouter (cf. OrthogonalRouter::searchRoute).
+//
+class OrthogonalSearch
+{
+    public:
+        OrthogonalSearch();
+    private:
+        // One state per vertex and direction of arrival.
+        std::vector<double> _dist;
+        std::vector<int> _parent;
+        std::vector<unsigned int> _searchNum;
+        unsigned int _currSearchNum;
+
+        // Open states, by estimated cost; the furthest one first among
+        // those with the same estimate, as there are usually many.
+        struct Open
+        {
+            double f, g;
+            int state;
+
+            bool operator>(const Open& rhs) const
+            {
+                if (f != rhs.f)
+                {
+                    return f > rhs.f;
+                }
+                if (g != rhs.g)
+                {
+                    return g < rhs.g;
+                }
+                return state > rhs.state;
+            }
+        };
+        std::vector<Open> _heap;
+
+        friend class OrthogonalRouter;
+};
+
+
+// Routes connectors with horizontal and vertical segments only, around
+// rectangular shapes (cf. Wybrow, Marriott & Stuckey, "Orthogonal
+// Connector Routing", Graph Drawing 2009).
+//
+// Unlike the Router, there is no incremental session: the shapes and
+// connectors are given all at once, then buildGraph builds a sparse
+// orthogonal visibility graph, in O(n log n) for n shapes (plus the
+// number of segment crossings).  Only the corners of the shapes, grown
+// by shapeBuffer, and the connector end points are interesting points:
+// each gets a horizontal and a vertical segment, as long as no shape
+// blocks it, and the vertices of the graph are the crossings of these
+// segments.
+//
+// The connectors are then routed one by one (searchRoute), with a cost
+// that adds bendPenalty to the length of the route for each bend.  The
+// graph is only read by the searches, which may run concurrently, each
+// thread with its own OrthogonalSearch.  Finally, nudge spreads apart
+// the parallel segments of different connectors that would otherwise
+// overlap, within the free space between the shapes.
+//
+// A connector end point is normally inside a shape (the center of a
+// node): its segments can go through that shape, but no other connector
+// can use them there.
+//
+class OrthogonalRouter
+{
+    public:
+        static const int NoShape = -1;
+
+        OrthogonalRouter();
+
+        double shapeBuffer;
+        double segmentSpacing;
+        double bendPenalty;
+
+        // Returns the index of the new shape (resp. connector).
+        int addShape(const BBox& box);
+        int addConnector(const Point& src, const Point& tar,
+                int srcShape = NoShape, int tarShape = NoShape);
+        unsigned int shapeCount(void) const;
+        unsigned int connectorCount(void) const;
+
+        void buildGraph(void);
+        bool searchRoute(unsigned int connector, OrthogonalSearch& search);
+        void nudge(void);
+
+        // The corners of the route, from source to target.  A connector
+        // without a route (or not routed yet) goes straight.
+        const std::vector<Point>& route(unsigned int connector) const;
+
+    private:
+        enum Direction { Left = 0, Right = 1, Up = 2, Down = 3 };
+
+        struct Conn
+        {
+            Point src, tar;
+            int srcShape, tarShape;
+            int srcVert, tarVert;
+        };
+        struct Vert
+        {
+            Point point;
+            // The next vertex in each direction, and the shape whose
+            // connectors only can go that way (if any).
+            int next[4];
+            int inside[4];
+        };
+        // A horizontal (or vertical) segment from lo to hi, at pos.
+        struct Segment
+        {
+            double pos, lo, hi;
+            int shape;
+            std::vector<int> verts;
+        };
+
+        std::vector<BBox> _shapes;
+        std::vector<Conn> _conns;
+        std::vector<Vert> _verts;
+        std::vector<std::vector<Point> > _routes;
+
+        BBox _bounds;
+
+        typedef std::map<std::pair<double, double>, int> VertexMap;
+
+        void makeSegments(std::vector<Segment>& segments, bool horizontal);
+        void crossSegments(std::vector<Segment>& hSegs,
+                std::vector<Segment>& vSegs, VertexMap& vertexMap);
+        void linkSegment(Segment& segment, bool horizontal);
+        void nudgeSegments(bool horizontal);
+};
+
+
+}
+
+
+#endif
+
+
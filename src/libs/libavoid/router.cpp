@@ -28,6 +28,7 @@
 #include "libavoid/debug.h"
 #include "libavoid/region.h"
 #include "math.h"
+#include <algorithm>
 
 //#define ORTHOGONAL_ROUTING
 
@@ -77,7 +78,40 @@ Router::Router()
 #ifdef LINEDEBUG
     , avoid_screen(NULL)
 #endif
-{ }
+{
+    _destroying = false;
+}
+
+
+// The shapes and connectors still known by the router are deleted along
+// with it.  The visibility graph is not kept up to date meanwhile: its
+// vertices and edges simply go away with the arenas, all at once.
+//
+Router::~Router()
+{
+    _destroying = true;
+
+    while (!connRefs.empty())
+    {
+        delete connRefs.front();
+    }
+    while (!shapeRefs.empty())
+    {
+        delete shapeRefs.front();
+    }
+    for (MoveInfoList::iterator it = moveList.begin(); it != moveList.end();
+            ++it)
+    {
+        delete *it;
+    }
+    moveList.clear();
+}
+
+
+bool Router::destroying(void) const
+{
+    return _destroying;
+}
 
 
 
@@ -363,8 +397,37 @@ void Router::callbackAllInvalidConnectors(void)
 }
 
 
+static BBox polyBox(const Polygn& poly)
+{
+    BBox bbox;
+    bbox.a = bbox.b = poly.ps[0];
+    for (int i = 1; i < poly.pn; ++i)
+    {
+        bbox.a.x = std::min(poly.ps[i].x, bbox.a.x);
+        bbox.a.y = std::min(poly.ps[i].y, bbox.a.y);
+        bbox.b.x = std::max(poly.ps[i].x, bbox.b.x);
+        bbox.b.y = std::max(poly.ps[i].y, bbox.b.y);
+    }
+    return bbox;
+}
+
+
+// Whether the box of the segment p--q overlaps bbox.  If not, the
+// segment can neither cross nor end inside anything within bbox.
+//
+static bool boxCrossed(const BBox& bbox, const Point& p, const Point& q)
+{
+    return (std::min(p.x, q.x) <= bbox.b.x) &&
+           (std::max(p.x, q.x) >= bbox.a.x) &&
+           (std::min(p.y, q.y) <= bbox.b.y) &&
+           (std::max(p.y, q.y) >= bbox.a.y);
+}
+
+
 void Router::newBlockingShape(Polygn *poly, int pid)
 {
+    BBox bbox = polyBox(*poly);
+
     // o  Check all visibility edges to see if this one shape
     //    blocks them.
     EdgeInf *finish = visGraph.end();
@@ -383,6 +446,12 @@ void Router::newBlockingShape(Polygn *poly, int pid)
             Point e2 = points.second;
             bool blocked = false;
 
+            if (!boxCrossed(bbox, e1, e2))
+            {
+                // Neither inside the shape, nor crossing it.
+                continue;
+            }
+
             bool ep_in_poly1 = !(eID1.isShape) ? inPoly(*poly, e1) : false;
             bool ep_in_poly2 = !(eID2.isShape) ? inPoly(*poly, e2) : false;
             if (ep_in_poly1 || ep_in_poly2)
@@ -413,7 +482,7 @@ void Router::newBlockingShape(Polygn *poly, int pid)
                 }
                 else
                 {
-                    delete tmp;
+                    tmp->destroy();
                 }
             }
         }
@@ -425,10 +494,27 @@ void Router::checkAllBlockedEdges(int pid)
 {
     assert(InvisibilityGrph);
 
-    for (EdgeInf *iter = invisGraph.begin(); iter != invisGraph.end() ; )
+    // Only the edges blocked by this shape, or by a cycle, are looked at.
+    // They are dealt with in the order of the invisibility graph.
+    std::vector<std::pair<unsigned int, EdgeInf *> > edges;
+    int blockers[2] = { -1, pid };
+    for (int b = 0; b < 2; ++b)
     {
-        EdgeInf *tmp = iter;
-        iter = iter->lstNext;
+        BlockerMap::iterator found = blockedEdges.find(blockers[b]);
+        if (found == blockedEdges.end())
+        {
+            continue;
+        }
+        for (EdgeInf *e = found->second; e != NULL; e = e->blkNext)
+        {
+            edges.push_back(std::make_pair(e->lstOrder, e));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    for (unsigned int i = 0; i < edges.size(); ++i)
+    {
+        EdgeInf *tmp = edges[i].second;
 
         if (tmp->_blocker == -1)
         {
@@ -491,8 +577,11 @@ void Router::generateContains(VertInf *pt)
 {
     contains[pt->id].clear();
 
-    ShapeRefList::iterator finish = shapeRefs.end();
-    for (ShapeRefList::iterator i = shapeRefs.begin(); i != finish; ++i)
+    // Only the shapes whose box contains the point are checked.
+    ShapeRefVector shapes;
+    shapeIndex.pointQuery(pt->point, shapes);
+    ShapeRefVector::iterator finish = shapes.end();
+    for (ShapeRefVector::iterator i = shapes.begin(); i != finish; ++i)
     {
         Polygn poly = copyPoly(*i);
         if (inPoly(poly, pt->point))
@@ -506,10 +595,11 @@ void Router::generateContains(VertInf *pt)
 
 void Router::adjustContainsWithAdd(const Polygn& poly, const int p_shape)
 {
+    BBox bbox = polyBox(poly);
     for (VertInf *k = vertices.connsBegin(); k != vertices.shapesBegin();
             k = k->lstNext)
     {
-        if (inPoly(poly, k->point))
+        if (boxCrossed(bbox, k->point, k->point) && inPoly(poly, k->point))
         {
             contains[k->id].insert(p_shape);
         }
@@ -29,6 +29,9 @@
 #include "libavoid/shape.h"
 #include "libavoid/graph.h"
 #include "libavoid/timer.h"
+#include "libavoid/makepath.h"
+#include "libavoid/shapeindex.h"
+#include "libavoid/arena.h"
 #include <list>
 #include <utility>
 #ifdef LINEDEBUG       
@@ -53,13 +56,22 @@ static const unsigned int runningToAndFrom = runningTo | runningFrom;
 class Router {
     public:
         Router();
+        ~Router();
+
+        // Storage for the visibility graph.
+        Arena<VertInf> vertArena;
+        Arena<EdgeInf> edgeArena;
+        Arena<ConnFlag> flagArena;
 
         ShapeRefList shapeRefs;
         ConnRefList connRefs;
         EdgeList visGraph;
         EdgeList invisGraph;
+        EdgeTable edgeTable;
+        BlockerMap blockedEdges;
         ContainsMap contains;
         VertInfList vertices;
+        ShapeIndex shapeIndex;
         
         bool PartialTime;
         bool SimpleRouting;
@@ -77,6 +89,9 @@ class Router {
         bool ConsolidateMoves;
         bool PartialFeedback;
 
+        // Search buffers for the connectors routed one at a time.
+        PathSearch pathSearch;
+
         // Instrumentation:
         Timer timers;
         int st_checked_edges;
@@ -98,6 +113,7 @@ class Router {
         void markConnectors(ShapeRef *shape);
         void generateContains(VertInf *pt);
         void printInfo(void);
+        bool destroying(void) const;
     private:
         void newBlockingShape(Polygn *poly, int pid);
         void checkAllBlockedEdges(int pid);
@@ -107,6 +123,7 @@ class Router {
         void callbackAllInvalidConnectors(void);
 
         MoveInfoList moveList;
+        bool _destroying;
 };
 
 }
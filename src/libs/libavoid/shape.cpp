@@ -48,7 +48,7 @@ ShapeRef::ShapeRef(Router *router, unsigned int id, Polygn& ply)
     VertInf *node = NULL;
     for (int pt_i = 0; pt_i < _poly.pn; pt_i++)
     {
-        node = new VertInf(_router, i, _poly.ps[pt_i]);
+        node = VertInf::create(_router, i, _poly.ps[pt_i]);
 
         if (!_firstVert)
         {
@@ -76,6 +76,17 @@ ShapeRef::~ShapeRef()
 {
     assert(_firstVert != NULL);
     
+    if (_router->destroying())
+    {
+        // The vertices go away with the router.
+        if (_active)
+        {
+            _router->shapeRefs.erase(_pos);
+        }
+        freePoly(_poly);
+        return;
+    }
+
     makeInactive();
 
     VertInf *it = _firstVert;
@@ -84,7 +95,7 @@ ShapeRef::~ShapeRef()
         VertInf *tmp = it;
         it = it->shNext;
 
-        delete tmp;
+        tmp->destroy();
     }
     while (it != _firstVert);
     _firstVert = _lastVert = NULL;
@@ -106,8 +117,6 @@ void ShapeRef::setNewPoly(Polygn& poly)
 
         // Reset with the new polygon point.
         curr->Reset(poly.ps[pt_i]);
-        curr->pathNext = NULL;
-        curr->pathDist = 0;
         
         curr = curr->shNext;
     }
@@ -135,6 +144,8 @@ void ShapeRef::makeActive(void)
         _router->vertices.addVertex(tmp);
     }
     while (it != _firstVert);
+
+    _router->shapeIndex.addShape(this);
     
     _active = true;
 }
@@ -157,6 +168,8 @@ void ShapeRef::makeInactive(void)
         _router->vertices.removeVertex(tmp);
     }
     while (it != _firstVert);
+
+    _router->shapeIndex.removeShape(this);
     
     _active = false;
 }
@@ -227,7 +240,7 @@ void ShapeRef::removeFromGraph(void)
         {
             // Remove each visibility edge
             (*edge)->alertConns();
-            delete (*edge);
+            (*edge)->destroy();
         }
 
         EdgeInfList& invisList = tmp->invisList;
@@ -235,7 +248,7 @@ void ShapeRef::removeFromGraph(void)
         while ((edge = invisList.begin()) != finish)
         {
             // Remove each invisibility edge
-            delete (*edge);
+            (*edge)->destroy();
         }
     }
 }
@@ -0,0 +1,191 @@
+/*
+ * vim: ts=4 sw=4 et tw=0 wm=0
+ *
+ * libavoid - Fast, Incremental, Object-avoiding Line Router
+ * Copyright (C) 2007-2009  Alice Villeger <alice.villeger@manchester.ac.uk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+*/
+
+#include <cassert>
+#include <algorithm>
+#include <math.h>
+
+#include "libavoid/shapeindex.h"
+#include "libavoid/shape.h"
+
+
+namespace Avoid {
+
+
+static bool overlap(const BBox& r, const BBox& s)
+{
+    return (r.a.x <= s.b.x) && (s.a.x <= r.b.x) &&
+           (r.a.y <= s.b.y) && (s.a.y <= r.b.y);
+}
+
+
+ShapeIndex::ShapeIndex(const double cellSize)
+    : _cellSize(cellSize)
+    , _added(0)
+{
+}
+
+
+int ShapeIndex::cellOf(const double coord)
+{
+    return (int) floor(coord / _cellSize);
+}
+
+
+void ShapeIndex::addShape(ShapeRef *shape)
+{
+    assert(_entries.find(shape) == _entries.end());
+
+    Entry& entry = _entries[shape];
+    shape->boundingBox(entry.box);
+    entry.order = _added++;
+
+    int xMax = cellOf(entry.box.b.x);
+    int yMax = cellOf(entry.box.b.y);
+    for (int x = cellOf(entry.box.a.x); x <= xMax; ++x)
+    {
+        for (int y = cellOf(entry.box.a.y); y <= yMax; ++y)
+        {
+            _cells[Cell(x, y)].push_back(shape);
+        }
+    }
+}
+
+
+void ShapeIndex::removeShape(ShapeRef *shape)
+{
+    EntryMap::iterator found = _entries.find(shape);
+    assert(found != _entries.end());
+
+    // The box the shape was added with, it may have moved since.
+    BBox& box = found->second.box;
+    int xMax = cellOf(box.b.x);
+    int yMax = cellOf(box.b.y);
+    for (int x = cellOf(box.a.x); x <= xMax; ++x)
+    {
+        for (int y = cellOf(box.a.y); y <= yMax; ++y)
+        {
+            CellMap::iterator cell = _cells.find(Cell(x, y));
+            assert(cell != _cells.end());
+            cell->second.remove(shape);
+            if (cell->second.empty())
+            {
+                _cells.erase(cell);
+            }
+        }
+    }
+    _entries.erase(found);
+}
+
+
+// Gathers the shapes in the cells (x, yMin) to (x, yMax) whose boxes
+// overlap the given box.  Shapes may be gathered more than once.
+//
+void ShapeIndex::collect(const int x, const int yMin, const int yMax,
+        const BBox& box)
+{
+    for (int y = yMin; y <= yMax; ++y)
+    {
+        CellMap::iterator cell = _cells.find(Cell(x, y));
+        if (cell == _cells.end())
+        {
+            continue;
+        }
+        std::list<ShapeRef *>& shapes = cell->second;
+        for (std::list<ShapeRef *>::iterator it = shapes.begin();
+                it != shapes.end(); ++it)
+        {
+            Entry& entry = _entries[*it];
+            if (overlap(entry.box, box))
+            {
+                _found.push_back(std::make_pair(entry.order, *it));
+            }
+        }
+    }
+}
+
+
+// Puts the gathered shapes in order, once each.
+//
+void ShapeIndex::sorted(ShapeRefVector& result)
+{
+    std::sort(_found.begin(), _found.end());
+    _found.erase(std::unique(_found.begin(), _found.end()), _found.end());
+
+    result.clear();
+    result.reserve(_found.size());
+    for (unsigned int i = 0; i < _found.size(); ++i)
+    {
+        result.push_back(_found[i].second);
+    }
+    _found.clear();
+}
+
+
+// Returns the shapes whose boxes may be crossed by the segment p--q.
+// Only the cells the segment goes through are looked at, one column
+// of cells at a time.
+//
+void ShapeIndex::segmentQuery(const Point& p, const Point& q,
+        ShapeRefVector& result)
+{
+    BBox box;
+    box.a = Point(std::min(p.x, q.x), std::min(p.y, q.y));
+    box.b = Point(std::max(p.x, q.x), std::max(p.y, q.y));
+
+    int xMin = cellOf(box.a.x);
+    int xMax = cellOf(box.b.x);
+    for (int x = xMin; x <= xMax; ++x)
+    {
+        int yMin = cellOf(box.a.y);
+        int yMax = cellOf(box.b.y);
+        if ((xMin != xMax) && (p.x != q.x))
+        {
+            // The part of the segment within this column.
+            double x1 = std::max(box.a.x, x * _cellSize);
+            double x2 = std::min(box.b.x, (x + 1) * _cellSize);
+            double y1 = p.y + (q.y - p.y) * ((x1 - p.x) / (q.x - p.x));
+            double y2 = p.y + (q.y - p.y) * ((x2 - p.x) / (q.x - p.x));
+            // Rounding could leave out the cell on either side.
+            yMin = std::max(yMin, cellOf(std::min(y1, y2)) - 1);
+            yMax = std::min(yMax, cellOf(std::max(y1, y2)) + 1);
+        }
+        collect(x, yMin, yMax, box);
+    }
+    sorted(result);
+}
+
+
+// Returns the shapes whose boxes contain the point p.
+//
+void ShapeIndex::pointQuery(const Point& p, ShapeRefVector& result)
+{
+    BBox box;
+    box.a = box.b = p;
+    int y = cellOf(p.y);
+    collect(cellOf(p.x), y, y, box);
+    sorted(result);
+}
+
+
+}
+
@@ -0,0 +1,84 @@
+/*
+ * vim: ts=4 sw=4 et tw=0 wm=0
+ *
+ * libavoid - Fast, Incremental, Object-avoiding Line Router
+ * Copyright (C) 2007-2009  Alice Villeger <alice.villeger@manchester.ac.uk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+*/
+
+#ifndef AVOID_SHAPEINDEX_H
+#define AVOID_SHAPEINDEX_H
+
+#include <map>
+#include <list>
+#include <vector>
+#include <utility>
+#include "libavoid/geomtypes.h"
+
+
+namespace Avoid {
+
+class ShapeRef;
+typedef std::vector<ShapeRef *> ShapeRefVector;
+
+
+// A uniform grid over the bounding boxes of the active shapes of a
+// router (the ones whose vertices are in the vertex list), so that
+// visibility and blocking tests only look at the shapes near a segment
+// or a point rather than at every shape.
+//
+// Shapes are returned in the order they were (last) added in, which
+// is also the order of their vertices in the vertex list.  Queries
+// share a buffer, so they are not meant to run concurrently.
+//
+class ShapeIndex
+{
+    public:
+        ShapeIndex(const double cellSize = 100);
+        void addShape(ShapeRef *shape);
+        void removeShape(ShapeRef *shape);
+        void segmentQuery(const Point& p, const Point& q,
+                ShapeRefVector& result);
+        void pointQuery(const Point& p, ShapeRefVector& result);
+    private:
+        typedef std::pair<int, int> Cell;
+        typedef std::map<Cell, std::list<ShapeRef *> > CellMap;
+        class Entry
+        {
+            public:
+                BBox box;
+                unsigned int order;
+        };
+        typedef std::map<ShapeRef *, Entry> EntryMap;
+
+        int cellOf(const double coord);
+        void collect(const int x, const int yMin, const int yMax,
+                const BBox& box);
+        void sorted(ShapeRefVector& result);
+
+        double _cellSize;
+        unsigned int _added;
+        CellMap _cells;
+        EntryMap _entries;
+        std::vector<std::pair<unsigned int, ShapeRef *> > _found;
+};
+
+
+}
+
+
+#endif
@@ -152,14 +152,35 @@ VertInf::VertInf(Router *router, const VertID& vid, const Point& vpoint)
     , lstNext(NULL)
     , shPrev(NULL)
     , shNext(NULL)
+    , visList(&router->edgeArena, this)
     , visListSize(0)
+    , invisList(&router->edgeArena, this)
     , invisListSize(0)
-    , pathNext(NULL)
-    , pathDist(0)
+    , index(NoIndex)
 {
 }
 
 
+VertInf *VertInf::create(Router *router, const VertID& vid,
+        const Point& vpoint)
+{
+    unsigned int index;
+    void *memory = router->vertArena.allocate(index);
+    VertInf *vert = new (memory) VertInf(router, vid, vpoint);
+    vert->index = index;
+    return vert;
+}
+
+
+void VertInf::destroy(void)
+{
+    Router *router = _router;
+    unsigned int index = this->index;
+    this->~VertInf();
+    router->vertArena.release(index);
+}
+
+
 void VertInf::Reset(const Point& vpoint)
 {
     point = vpoint;
@@ -183,7 +204,7 @@ void VertInf::removeFromGraph(const bool isConnVert)
     {
         // Remove each visibility edge
         (*edge)->alertConns();
-        delete (*edge);
+        (*edge)->destroy();
     }
 
     EdgeInfList& invisList = tmp->invisList;
@@ -191,7 +212,7 @@ void VertInf::removeFromGraph(const bool isConnVert)
     while ((edge = invisList.begin()) != finish)
     {
         // Remove each invisibility edge
-        delete (*edge);
+        (*edge)->destroy();
     }
 }
 
@@ -220,19 +241,27 @@ bool directVis(VertInf *src, VertInf *dst)
         ss.insert(contains[qID].begin(), contains[qID].end());
     }
 
-    // The "beginning" should be the first shape vertex, rather
-    // than an endpoint, which are also stored in "vertices".
-    VertInf *endVert = router->vertices.end();
-    for (VertInf *k = router->vertices.shapesBegin(); k != endVert;
-            k = k->lstNext)
+    // Only the shapes near the segment are checked.
+    ShapeRefVector shapes;
+    router->shapeIndex.segmentQuery(p, q, shapes);
+    for (ShapeRefVector::iterator it = shapes.begin(); it != shapes.end();
+            ++it)
     {
-        if ((ss.find(k->id.objID) == ss.end()))
+        if ((ss.find((*it)->id()) != ss.end()))
+        {
+            continue;
+        }
+        VertInf *first = (*it)->firstVert();
+        VertInf *k = first;
+        do
         {
             if (segmentIntersect(p, q, k->point, k->shNext->point))
             {
                 return false;
             }
+            k = k->shNext;
         }
+        while (k != first);
     }
     return true;
 }
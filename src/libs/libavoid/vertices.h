@@ -28,13 +28,75 @@
 #include <map>
 #include <iostream>
 #include "libavoid/geomtypes.h"
+#include "libavoid/arena.h"
 
 namespace Avoid {
 
 class EdgeInf;
+class VertInf;
 class Router;
 
-typedef std::list<EdgeInf *> EdgeInfList;
+
+// The visibility (or invisibility) edges of a vertex, latest first.
+// The edges are chained through themselves, by index in the edge arena
+// of the router, so the list itself allocates nothing.
+//
+class EdgeInfList
+{
+    public:
+        class iterator
+        {
+            public:
+                iterator()
+                    : _edges(NULL)
+                    , _index(NoIndex)
+                    , _vert(NULL)
+                {
+                }
+                iterator(const Arena<EdgeInf> *edges, unsigned int index,
+                        const VertInf *vert)
+                    : _edges(edges)
+                    , _index(index)
+                    , _vert(vert)
+                {
+                }
+                inline EdgeInf *operator*() const;
+                inline iterator& operator++();
+                bool operator==(const iterator& rhs) const
+                {
+                    return _index == rhs._index;
+                }
+                bool operator!=(const iterator& rhs) const
+                {
+                    return _index != rhs._index;
+                }
+            private:
+                const Arena<EdgeInf> *_edges;
+                unsigned int _index;
+                const VertInf *_vert;
+        };
+
+        EdgeInfList(const Arena<EdgeInf> *edges, const VertInf *vert)
+            : _edges(edges)
+            , _vert(vert)
+            , _first(NoIndex)
+        {
+        }
+        iterator begin(void) const
+        {
+            return iterator(_edges, _first, _vert);
+        }
+        iterator end(void) const
+        {
+            return iterator(_edges, NoIndex, _vert);
+        }
+        inline void push_front(EdgeInf *edge);
+        inline void erase(EdgeInf *edge);
+    private:
+        const Arena<EdgeInf> *_edges;
+        const VertInf *_vert;
+        unsigned int _first;
+};
 
 
 class VertID
@@ -63,10 +125,15 @@ class VertID
 };
 
 
+// Vertices are allocated in the vertex arena of their router (cf. Arena),
+// through create and destroy.
+//
 class VertInf
 {
     public:
-        VertInf(Router *router, const VertID& vid, const Point& vpoint);
+        static VertInf *create(Router *router, const VertID& vid,
+                const Point& vpoint);
+        void destroy(void);
         void Reset(const Point& vpoint);
         void removeFromGraph(const bool isConnVert = true);
 
@@ -81,8 +148,11 @@ class VertInf
         unsigned int visListSize;
         EdgeInfList invisList;
         unsigned int invisListSize;
-        VertInf *pathNext;
-        double pathDist;
+        // Index of the vertex in the vertex arena, and so in the search
+        // buffers (cf. PathSearch).  Reused once the vertex is destroyed.
+        unsigned int index;
+    private:
+        VertInf(Router *router, const VertID& vid, const Point& vpoint);
 };
 
 
@@ -488,7 +488,7 @@ void vertexSweep(VertInf *vert)
         EdgeInf *edge = EdgeInf::existingEdge(centerInf, currInf);
         if (edge == NULL)
         {
-            edge = new EdgeInf(centerInf, currInf);
+            edge = EdgeInf::create(centerInf, currInf);
         }
         // Ignore vertices from bounding shapes, if sweeping round an endpoint.
         if (!(centerID.isShape) && isBounding(*t))
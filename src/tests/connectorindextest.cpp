@@ -0,0 +1,151 @@
+/***********************************************************************
+*
+*  Arcadia is a visualisation tool for metabolic pathways
+*
+*  This file is part of the arcadia1.0 application distribution
+*  Copyright (C) 2007-2009 Alice Villeger, University of Manchester
+*  <alice.villeger@manchester.ac.uk>
+*
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*************************************************************************/
+
+/*
+ *  connectorindextest.cpp
+ *  arcadia
+ *
+ *  Regression test for the connector indices of GraphLayout, with parallel edges
+ *  cf. connectorindextest.pro
+ *
+ */
+
+// Qt application framework (styles need fonts)
+#include <QApplication>
+
+// Local classes
+#include <arcadia/graphlayout.h>
+#include <arcadia/vertexproperty.h>
+#include <arcadia/clonecontent.h>
+#include <arcadia/connector.h>
+#include <pathways/ontologycontainer.h>
+#include <pathways/pathwaygraphmodel.h>
+#include <pathways/sbmlgraphloader.h>
+
+#include <iostream>
+#include <stdexcept>
+
+static int Failures = 0;
+
+static void Check(bool condition, std::string what)
+{
+	if (condition) return;
+	std::cerr << "FAILED: " << what << std::endl;
+	Failures++;
+}
+
+/*******
+* Scan *
+********
+* The lookup getConnector used to do before the indices:
+* the first connector of the list with these two vertices and this edge
+*************************************************************************/
+static Connector * Scan(GraphLayout * gl, BGL_Vertex u, BGL_Vertex v, BGL_Edge e)
+{
+	std::list<Connector *> connectors = gl->getConnectors();
+	for (std::list<Connector *>::iterator it = connectors.begin(); it != connectors.end(); ++it)
+	{
+		Connector * c = *it;
+		if ((c->getSource()->getVertex() == u) && (c->getTarget()->getVertex() == v) && (c->getEdge() == e)) return c;
+	}
+	return NULL;
+}
+
+/******************
+* CheckConnectors *
+*******************
+* For every edge, both ways, the indexed getConnector must return what the scan finds
+* and for every connector, the clone pair index must know a connector between its clones
+*****************************************************************************************/
+static void CheckConnectors(GraphModel * model, GraphLayout * gl, std::string when)
+{
+	std::list<BGL_Edge> eList = model->getEdges();
+	for (std::list<BGL_Edge>::iterator it = eList.begin(); it != eList.end(); ++it)
+	{
+		BGL_Vertex u = model->getSource(*it), v = model->getTarget(*it);
+		std::string edge = model->getProperties(u)->getId() + " -> " + model->getProperties(v)->getId();
+
+		Connector * c = Scan(gl, u, v, *it);
+		Check(c != NULL, when + ": " + edge + " has a connector");
+		Check(gl->getConnector(u, v, *it) == c, when + ": " + edge + " gets the same connector as the scan");
+		Check(gl->getConnector(v, u, *it) == Scan(gl, v, u, *it), when + ": " + edge + " the other way round");
+	}
+
+	std::list<Connector *> connectors = gl->getConnectors();
+	for (std::list<Connector *>::iterator it = connectors.begin(); it != connectors.end(); ++it)
+	{
+		Connector * c = gl->getConnector((*it)->getSource(), (*it)->getTarget());
+		Check(c && (c->getSource() == (*it)->getSource()) && (c->getTarget() == (*it)->getTarget()),
+			when + ": a connector between the clones of each connector");
+	}
+}
+
+/*******
+* main *
+********
+* Loads tests/paralleledges.xml, where ATP is a reactant (twice) and a modifier of the same reaction,
+* and ADP a product twice: several edges join the same two vertices, each with its own connector
+* Checks the lookups after loading, after cloning ATP, and after uncloning it
+* The test directory can be given as the first argument
+******************************************************************************************************/
+int main(int argc, char * argv[])
+{
+	QApplication app(argc, argv);
+
+	std::string dir = TESTS_DIR;
+	if (argc > 1) dir = argv[1];
+
+	OntologyContainer::LoadLocalSBO(dir + "/../../res/SBO_XML.xml", true);
+
+	GraphModel * model = NULL;
+	try { model = SBMLGraphLoader::GetModel(dir + "/paralleledges.xml"); } // builds the default layout too
+	catch (std::exception & e) { std::cerr << "FAILED: loading the model: " << e.what() << std::endl; return 1; }
+	Check(model && model->layoutNumber() == 1, "one default layout");
+	if (Failures) return 1;
+
+	BGL_Vertex atp;
+	bool foundAtp = false;
+	std::list<BGL_Vertex> vList = model->getVertices();
+	for (std::list<BGL_Vertex>::iterator it = vList.begin(); it != vList.end(); ++it)
+	{
+		if (model->getProperties(*it)->getId() == "atp") { atp = *it; foundAtp = true; }
+	}
+	Check(foundAtp, "ATP is there");
+	Check(model->getEdges().size() == 10, "one edge per species reference");
+	if (Failures) return 1;
+
+	GraphLayout * layout = model->getLayout(0);
+	CheckConnectors(model, layout, "loaded");
+
+	layout->toggleCloning(atp, NULL);
+	Check(layout->getClones(atp).size() > 1, "ATP got cloned");
+	CheckConnectors(model, layout, "cloned");
+
+	layout->toggleCloning(atp, NULL);
+	Check(layout->getClones(atp).size() == 1, "ATP got uncloned");
+	CheckConnectors(model, layout, "uncloned");
+
+	if (Failures) std::cerr << Failures << " check(s) failed" << std::endl;
+	else std::cout << "OK" << std::endl;
+	return Failures? 1: 0;
+}
@@ -0,0 +1,106 @@
+/***********************************************************************
+*
+*  Arcadia is a visualisation tool for metabolic pathways
+*
+*  This file is part of the arcadia1.0 application distribution
+*  Copyright (C) 2007-2009 Alice Villeger, University of Manchester
+*  <alice.villeger@manchester.ac.uk>
+* 
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+* 
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+* 
+*  You should have received a copy of the GNU General Public License
+*  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*************************************************************************/
+
+/*
+ *  emptysettest.cpp
+ *  arcadia
+ *
+ *  Regression test for the Species annotated as empty sets (SBO:0000291)
+ *  cf. emptysettest.pro
+ *
+ */
+
+// Qt application framework (styles need fonts)
+#include <QApplication>
+
+// Local classes
+#include <arcadia/graphlayout.h>
+#include <arcadia/vertexproperty.h>
+#include <arcadia/clonecontent.h>
+#include <arcadia/containercontent.h>
+#include <pathways/ontologycontainer.h>
+#include <pathways/pathwaygraphmodel.h>
+#include <pathways/sbmlgraphloader.h>
+
+#include <iostream>
+#include <stdexcept>
+
+static int Failures = 0;
+
+static void Check(bool condition, std::string what)
+{
+	if (condition) return;
+	std::cerr << "FAILED: " << what << std::endl;
+	Failures++;
+}
+
+/*******
+* main *
+********
+* Loads tests/emptyset.xml, where a reaction turns a species into one annotated as an empty set:
+* that species must be taken for a source or sink, just like the ones made up for reactions
+* (the default layout then puts it in the reaction's container, rather than using it as a core)
+* The test directory can be given as the first argument
+**************************************************************************************************/
+int main(int argc, char * argv[])
+{
+	QApplication app(argc, argv);
+
+	std::string dir = TESTS_DIR;
+	if (argc > 1) dir = argv[1];
+
+	OntologyContainer::LoadLocalSBO(dir + "/../../res/SBO_XML.xml", true);
+
+	GraphModel * model = NULL;
+	try { model = SBMLGraphLoader::GetModel(dir + "/emptyset.xml"); } // builds the default layout too
+	catch (std::exception & e) { std::cerr << "FAILED: loading the model: " << e.what() << std::endl; return 1; }
+	Check(model && model->layoutNumber() == 1, "one default layout");
+	if (Failures) return 1;
+
+	BGL_Vertex species, emptySet, reaction;
+	bool foundSpecies = false, foundEmptySet = false, foundReaction = false;
+	std::list<BGL_Vertex> vList = model->getVertices();
+	for (std::list<BGL_Vertex>::iterator it = vList.begin(); it != vList.end(); ++it)
+	{
+		std::string id = model->getProperties(*it)->getId();
+		if (id == "glucose") { species = *it; foundSpecies = true; }
+		if (id == "nothing") { emptySet = *it; foundEmptySet = true; }
+		if (id == "degradation") { reaction = *it; foundReaction = true; }
+	}
+	Check(foundSpecies && foundEmptySet && foundReaction && vList.size() == 3, "the two species and the reaction, and nothing else");
+	if (Failures) return 1;
+
+	Check(model->getProperties(species)->getType() == speciesVertex, "glucose is a species");
+	Check(model->getProperties(emptySet)->getType() == emptySetVertex, "the SBO:0000291 species is an empty set");
+	Check(model->getProperties(reaction)->getType() == reactionVertex, "degradation is a reaction");
+
+	GraphLayout * layout = model->getLayout(0);
+	CloneContent * emptySetClone = layout->getClone(emptySet);
+	CloneContent * reactionClone = layout->getClone(reaction);
+	Check(emptySetClone->getContainer() == reactionClone->getContainer(), "the empty set goes along with its reaction");
+	Check(emptySetClone->getContainer()->getCore() != emptySetClone, "the empty set is not a core");
+
+	if (Failures) std::cerr << Failures << " check(s) failed" << std::endl;
+	else std::cout << "OK" << std::endl;
+	return Failures? 1: 0;
+}